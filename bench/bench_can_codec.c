@@ -0,0 +1,195 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "can_db.h"
+#include "can_manager.h"
+
+#define BENCH_ITERATIONS    (5000000U)
+#define BENCH_FD_ID         (0x300U)
+
+static volatile uint32_t sink;
+
+static uint64_t bench_nowNs(void);
+static void legacy_floatToBytes(float value, uint8_t* data);
+static void legacy_packPidParams(float kp, float ki, float kd, float setpoint, uint8_t* data);
+static void legacy_unpackPidTune(const uint8_t* data, float* kp, float* ki, float* kd);
+static void bench_report(const char* name, uint64_t elapsedNs);
+
+/*
+ * Monotonic time in nanoseconds
+ */
+static uint64_t bench_nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Hand-written union conversion formerly used by can_manager.c
+ */
+static void legacy_floatToBytes(float value, uint8_t* data)
+{
+    union {
+        float f;
+        uint8_t bytes[4];
+    } converter;
+
+    converter.f = value;
+
+    data[0] = converter.bytes[0];
+    data[1] = converter.bytes[1];
+    data[2] = converter.bytes[2];
+    data[3] = converter.bytes[3];
+}
+
+/*
+ * Hand-written PID_PARAMS packing formerly used by can_manager.c
+ */
+static void legacy_packPidParams(float kp, float ki, float kd, float setpoint, uint8_t* data)
+{
+    uint16_t kp_scaled = (uint16_t)(kp * 1000);
+    uint16_t ki_scaled = (uint16_t)(ki * 1000);
+    uint16_t kd_scaled = (uint16_t)(kd * 1000);
+    uint16_t setpoint_scaled = (uint16_t)(setpoint * 10);
+
+    data[0] = (uint8_t)(kp_scaled & 0xFF);
+    data[1] = (uint8_t)(kp_scaled >> 8);
+    data[2] = (uint8_t)(ki_scaled & 0xFF);
+    data[3] = (uint8_t)(ki_scaled >> 8);
+    data[4] = (uint8_t)(kd_scaled & 0xFF);
+    data[5] = (uint8_t)(kd_scaled >> 8);
+    data[6] = (uint8_t)(setpoint_scaled & 0xFF);
+    data[7] = (uint8_t)(setpoint_scaled >> 8);
+}
+
+/*
+ * Hand-written PID_TUNE_CMD decoding formerly used by can_manager.c
+ */
+static void legacy_unpackPidTune(const uint8_t* data, float* kp, float* ki, float* kd)
+{
+    uint16_t kp_scaled = ((uint16_t)data[1] << 8) | data[0];
+    uint16_t ki_scaled = ((uint16_t)data[3] << 8) | data[2];
+    uint16_t kd_scaled = ((uint16_t)data[5] << 8) | data[4];
+
+    *kp = (float)kp_scaled / 1000.0f;
+    *ki = (float)ki_scaled / 1000.0f;
+    *kd = (float)kd_scaled / 1000.0f;
+}
+
+/*
+ * Print throughput for one measurement
+ */
+static void bench_report(const char* name, uint64_t elapsedNs)
+{
+    double nsPerFrame = (double)elapsedNs / (double)BENCH_ITERATIONS;
+
+    printf("%-32s %10.2f ns/frame %10.2f Mframes/s\n", name, nsPerFrame, 1000.0 / nsPerFrame);
+}
+
+/*
+ * Compare generated codec throughput with the hand-written code it replaced,
+ * then queueing an encoded FD frame from the stack against in the TX slot
+ */
+int main(void)
+{
+    uint8_t data[8] = {0};
+    canConfig_t config = {0};
+    canDbConsolidatedStatus_t status;
+    uint64_t start;
+    uint32_t i;
+
+    printf("CAN signal codec benchmark (%u frames per case)\n", BENCH_ITERATIONS);
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        legacy_floatToBytes(20.0f + (float)(i & 63U), &data[0]);
+        data[4] = (uint8_t)(i & 3U);
+        sink += data[2];
+    }
+    bench_report("legacy TEMP_STATUS encode", bench_nowNs() - start);
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        canDbTempStatus_t msg = {20.0f + (float)(i & 63U), (uint8_t)(i & 3U)};
+        canDb_packTempStatus(&msg, data);
+        sink += data[2];
+    }
+    bench_report("generated TEMP_STATUS encode", bench_nowNs() - start);
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        legacy_packPidParams(1.0f + (float)(i & 7U), 0.5f, 0.1f, 35.0f, data);
+        sink += data[0];
+    }
+    bench_report("legacy PID_PARAMS encode", bench_nowNs() - start);
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        canDbPidParams_t msg = {1.0f + (float)(i & 7U), 0.5f, 0.1f, 35.0f};
+        canDb_packPidParams(&msg, data);
+        sink += data[0];
+    }
+    bench_report("generated PID_PARAMS encode", bench_nowNs() - start);
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        float kp, ki, kd;
+        data[0] = (uint8_t)i;
+        legacy_unpackPidTune(data, &kp, &ki, &kd);
+        sink += (uint32_t)kp;
+    }
+    bench_report("legacy PID_TUNE_CMD decode", bench_nowNs() - start);
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        canDbPidTuneCmd_t msg;
+        data[0] = (uint8_t)i;
+        canDb_unpackPidTuneCmd(&msg, data, sizeof(data));
+        sink += (uint32_t)msg.kp;
+    }
+    bench_report("generated PID_TUNE_CMD decode", bench_nowNs() - start);
+
+    config.fdEnabled = true;
+    (void)canManager_init(&config);
+    memset(&status, 0, sizeof(status));
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        canFrame_t frame;
+
+        memset(&frame, 0, sizeof(frame));
+        frame.id = BENCH_FD_ID;
+        frame.dlc = canManager_lengthToDlc(CAN_DB_CONSOLIDATED_STATUS_LENGTH);
+        frame.fd = true;
+        frame.brs = true;
+        status.temperature = (float)(i & 63U);
+        canDb_packConsolidatedStatus(&status, frame.data);
+        (void)canManager_queueFrame(&frame);
+        sink += canManager_abortTx();
+    }
+    bench_report("FD status, stack frame + queue", bench_nowNs() - start);
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        canFrame_t* frame = canManager_reserveTx();
+
+        frame->id = BENCH_FD_ID;
+        frame->dlc = canManager_lengthToDlc(CAN_DB_CONSOLIDATED_STATUS_LENGTH);
+        frame->fd = true;
+        frame->brs = true;
+        status.temperature = (float)(i & 63U);
+        canDb_packConsolidatedStatus(&status, frame->data);
+        (void)canManager_commitTx(frame);
+        sink += canManager_abortTx();
+    }
+    bench_report("FD status, reserve/commit in place", bench_nowNs() - start);
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "can_manager.h"
+
+#define BENCH_FRAME_COUNT   (4096U)
+#define BENCH_ITERATIONS    (500U)
+
+static volatile uint32_t handledFrames;
+static canFrame_t frames[BENCH_FRAME_COUNT];
+
+static void bench_handler(const canFrame_t* frame);
+static uint64_t bench_nowNs(void);
+static uint32_t bench_random(uint32_t* state);
+static double bench_run(uint32_t idCount, bool extended);
+
+/*
+ * Handler under test: just count the call
+ */
+static void bench_handler(const canFrame_t* frame)
+{
+    (void)frame;
+    handledFrames++;
+}
+
+/*
+ * Monotonic time in nanoseconds
+ */
+static uint64_t bench_nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * xorshift32 so every run dispatches the same ID sequence
+ */
+static uint32_t bench_random(uint32_t* state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+/*
+ * Register idCount handlers, then dispatch frames that hit them at random.
+ * Returns nanoseconds per dispatched frame.
+ */
+static double bench_run(uint32_t idCount, bool extended)
+{
+    uint32_t seed = 0x12345678U;
+    uint32_t ids[CAN_STD_ID_COUNT];
+    uint64_t start;
+    uint64_t elapsed;
+    uint32_t i;
+    uint32_t iter;
+
+    canManager_init(NULL);
+    canManager_setRxCallback(NULL);
+
+    for (i = 0U; i < idCount; i++) {
+        ids[i] = extended ? (0x18000000U | (i * 0x1F3U)) : ((i * 0x3A5U) & 0x7FFU);
+        canManager_registerHandler(ids[i], extended, bench_handler);
+    }
+
+    for (i = 0U; i < BENCH_FRAME_COUNT; i++) {
+        frames[i].id = ids[bench_random(&seed) % idCount];
+        frames[i].extended = extended;
+        frames[i].remote = false;
+        frames[i].dlc = 0;
+    }
+
+    handledFrames = 0U;
+    start = bench_nowNs();
+    for (iter = 0U; iter < BENCH_ITERATIONS; iter++) {
+        for (i = 0U; i < BENCH_FRAME_COUNT; i++) {
+            canManager_dispatchFrame(&frames[i]);
+        }
+    }
+    elapsed = bench_nowNs() - start;
+
+    return (double)elapsed / (double)((uint64_t)BENCH_FRAME_COUNT * BENCH_ITERATIONS);
+}
+
+/*
+ * Print dispatch cost against the number of registered IDs
+ */
+int main(void)
+{
+    static const uint32_t stdCounts[] = {1U, 8U, 64U, 256U, 1024U, 2048U};
+    static const uint32_t extCounts[] = {1U, 4U, 16U, 32U, CAN_EXT_HANDLER_SLOTS * 3U / 4U};
+    size_t i;
+
+    printf("CAN dispatch microbenchmark (%u frames x %u iterations)\n",
+           BENCH_FRAME_COUNT, BENCH_ITERATIONS);
+    printf("%-10s %10s %12s\n", "ID type", "IDs", "ns/frame");
+
+    for (i = 0U; i < sizeof(stdCounts) / sizeof(stdCounts[0]); i++) {
+        printf("%-10s %10u %12.2f\n", "standard", stdCounts[i], bench_run(stdCounts[i], false));
+    }
+
+    for (i = 0U; i < sizeof(extCounts) / sizeof(extCounts[0]); i++) {
+        printf("%-10s %10u %12.2f\n", "extended", extCounts[i], bench_run(extCounts[i], true));
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "can_manager.h"
+#include "can_e2e.h"
+
+#define BENCH_ITERATIONS    (5000000U)
+
+static volatile uint32_t sink;
+
+static uint64_t bench_nowNs(void);
+static void bench_report(const char* name, uint64_t elapsedNs);
+static void bench_frame(const char* name, const canE2eConfig_t* config, bool fd);
+static void bench_crc(uint32_t length);
+
+/*
+ * Monotonic time in nanoseconds
+ */
+static uint64_t bench_nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Print the per-iteration cost of one benchmark
+ */
+static void bench_report(const char* name, uint64_t elapsedNs)
+{
+    printf("  %-34s %6.2f ns\n", name, (double)elapsedNs / (double)BENCH_ITERATIONS);
+}
+
+/*
+ * Protect one frame on the sending side and check it on the receiving side
+ */
+static void bench_frame(const char* name, const canE2eConfig_t* config, bool fd)
+{
+    canE2eState_t tx = {0U, 0U, false};
+    canE2eState_t rx = {0U, 0U, false};
+    canFrame_t frame;
+    canFrame_t sent;
+    uint64_t start;
+    uint32_t ok = 0U;
+    uint32_t i;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = config->id;
+    frame.extended = config->extended;
+    frame.fd = fd;
+    frame.dlc = fd ? canManager_lengthToDlc(config->dataLength) : config->dataLength;
+    memset(frame.data, 0x3C, config->dataLength);
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        sent = frame;
+        sent.data[0] = (uint8_t)i;
+        (void)canE2e_protect(config, &tx, &sent);
+        ok += (canE2e_check(config, &rx, &sent) == CAN_E2E_OK) ? 1U : 0U;
+    }
+    bench_report(name, bench_nowNs() - start);
+    sink = ok;
+}
+
+/*
+ * Raw CRC cost over one buffer: sliced update against byte-at-a-time
+ */
+static void bench_crc(uint32_t length)
+{
+    uint8_t data[CAN_FD_MAX_DATA_LENGTH];
+    char name[64];
+    uint64_t start;
+    uint32_t crc = 0U;
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0U; i < length; i++) {
+        data[i] = (uint8_t)(i * 7U);
+    }
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        data[0] = (uint8_t)i;
+        crc += canE2e_crc16(data, length, CAN_E2E_CRC16_INIT);
+    }
+    snprintf(name, sizeof(name), "CRC-16 %u bytes, sliced", length);
+    bench_report(name, bench_nowNs() - start);
+
+    start = bench_nowNs();
+    for (i = 0U; i < BENCH_ITERATIONS; i++) {
+        uint16_t value = CAN_E2E_CRC16_INIT;
+
+        data[0] = (uint8_t)i;
+        for (j = 0U; j < length; j++) {
+            value = canE2e_crc16(&data[j], 1U, value);
+        }
+        crc += value;
+    }
+    snprintf(name, sizeof(name), "CRC-16 %u bytes, byte-wise", length);
+    bench_report(name, bench_nowNs() - start);
+    sink = crc;
+}
+
+/*
+ * Cost of E2E protection per frame on classic and FD frames
+ */
+int main(void)
+{
+    canE2eConfig_t classic = {CAN_MSG_SYSTEM_CMD, false, CAN_E2E_PROFILE_CRC8, 6U};
+    canE2eConfig_t fd = {CAN_MSG_CONSOLIDATED_STATUS, false, CAN_E2E_PROFILE_CRC16, 61U};
+
+    canE2e_init();
+
+    printf("E2E protection (%u iterations, protect + check per frame)\n", BENCH_ITERATIONS);
+    bench_frame("classic, CRC-8, 6 byte payload", &classic, false);
+    bench_frame("FD, CRC-16, 61 byte payload", &fd, true);
+    bench_crc(8U);
+    bench_crc(64U);
+
+    return 0;
+}
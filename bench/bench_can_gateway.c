@@ -0,0 +1,219 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "can_manager.h"
+#include "can_transport.h"
+#include "can_gateway.h"
+
+#define BENCH_FRAMES_DEFAULT    (200000U)
+#define BENCH_ROUTES_DEFAULT    (4U)
+#define BENCH_LATENCY_BUCKETS   (32U)
+#define BENCH_SOURCE            (1U)
+#define BENCH_DESTINATION       (2U)
+#define BENCH_ROUTED_ID         (0x180U)
+
+static canLoopback_t sourceBus;
+static canLoopback_t destinationBus;
+static uint64_t histogram[BENCH_LATENCY_BUCKETS];
+static uint64_t sentNs;
+static uint64_t latencyMinNs = UINT64_MAX;
+static uint64_t latencyMaxNs;
+static uint64_t latencyTotalNs;
+static uint32_t receivedCount;
+
+static void print_usage(const char* program_name);
+static uint64_t bench_nowNs(void);
+static void bench_onReceive(const canFrame_t* frame);
+static bool bench_setup(uint32_t routeCount, bool rewrite);
+static uint64_t bench_percentileNs(uint32_t percent);
+
+/*
+ * Print usage information
+ */
+static void print_usage(const char* program_name)
+{
+    printf("Usage: %s [-n frames] [-r routes] [-w]\n", program_name);
+    printf("  -n  Frames routed from channel %u to channel %u (default: %u)\n",
+           BENCH_SOURCE, BENCH_DESTINATION, BENCH_FRAMES_DEFAULT);
+    printf("  -r  Routes on the source channel, the matching one last (default: %u, max: %u)\n",
+           BENCH_ROUTES_DEFAULT, CAN_GATEWAY_ROUTES);
+    printf("  -w  Rewrite the ID of forwarded frames\n");
+}
+
+/*
+ * Monotonic time in nanoseconds
+ */
+static uint64_t bench_nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Destination RX callback: latency from injection on the source channel
+ * to dispatch on the destination channel, in power-of-two buckets
+ */
+static void bench_onReceive(const canFrame_t* frame)
+{
+    uint64_t latency = bench_nowNs() - sentNs;
+    uint32_t bucket = 0U;
+
+    (void)frame;
+    while (((latency >> bucket) > 0U) && (bucket < (BENCH_LATENCY_BUCKETS - 1U))) {
+        bucket++;
+    }
+    histogram[bucket]++;
+    latencyTotalNs += latency;
+    if (latency < latencyMinNs) {
+        latencyMinNs = latency;
+    }
+    if (latency > latencyMaxNs) {
+        latencyMaxNs = latency;
+    }
+    receivedCount++;
+}
+
+/*
+ * Two loopback channels bridged by the gateway. The routes in front of the
+ * matching one never match, so each frame pays the full table scan.
+ */
+static bool bench_setup(uint32_t routeCount, bool rewrite)
+{
+    canConfig_t config = {0};
+    canGatewayRoute_t route = {0};
+    uint32_t i;
+
+    config.baudrate = 500000;
+    config.transport = &canTransport_loopback;
+    config.transportContext = &sourceBus;
+    if (!canChannel_init(canChannel_get(BENCH_SOURCE), &config)) {
+        return false;
+    }
+    config.transportContext = &destinationBus;
+    if (!canChannel_init(canChannel_get(BENCH_DESTINATION), &config)) {
+        return false;
+    }
+    canChannel_setRxCallback(canChannel_get(BENCH_DESTINATION), bench_onReceive);
+
+    canGateway_init();
+    route.source = BENCH_SOURCE;
+    route.destination = BENCH_DESTINATION;
+    route.match.mask = 0x7FFU;
+    for (i = 0U; i < routeCount; i++) {
+        route.match.id = (i == (routeCount - 1U)) ? BENCH_ROUTED_ID : (0x600U + i);
+        route.rewrite = rewrite;
+        route.rewriteId = 0x480U;
+        if (!canGateway_setRoute((uint8_t)i, &route)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Upper bound of the histogram bucket holding the given percentile
+ */
+static uint64_t bench_percentileNs(uint32_t percent)
+{
+    uint64_t target = ((uint64_t)receivedCount * percent + 99U) / 100U;
+    uint64_t seen = 0U;
+    uint32_t bucket;
+
+    for (bucket = 0U; bucket < BENCH_LATENCY_BUCKETS; bucket++) {
+        seen += histogram[bucket];
+        if (seen >= target) {
+            break;
+        }
+    }
+
+    return (bucket == 0U) ? 0U : (1ULL << bucket);
+}
+
+/*
+ * Route frames one at a time and report end-to-end forwarding latency
+ */
+int main(int argc, char* argv[])
+{
+    uint32_t frames = BENCH_FRAMES_DEFAULT;
+    uint32_t routeCount = BENCH_ROUTES_DEFAULT;
+    bool rewrite = false;
+    canChannel_t* source;
+    canChannel_t* destination;
+    canFrame_t frame;
+    const canGatewayRouteStats_t* stats;
+    uint64_t wallStart;
+    uint64_t wallNs;
+    uint32_t i;
+    int option;
+
+    while ((option = getopt(argc, argv, "n:r:w")) != -1) {
+        switch (option) {
+            case 'n':
+                frames = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                routeCount = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                rewrite = true;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if ((frames == 0U) || (routeCount == 0U) || (routeCount > CAN_GATEWAY_ROUTES)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!bench_setup(routeCount, rewrite)) {
+        printf("Error: gateway setup failed\n");
+        return EXIT_FAILURE;
+    }
+    source = canChannel_get(BENCH_SOURCE);
+    destination = canChannel_get(BENCH_DESTINATION);
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = BENCH_ROUTED_ID;
+    frame.dlc = CAN_MAX_DATA_LENGTH;
+
+    wallStart = bench_nowNs();
+    for (i = 0U; i < frames; i++) {
+        frame.data[0] = (uint8_t)i;
+        sentNs = bench_nowNs();
+        (void)canChannel_enqueueRxFrame(source, &frame);
+        canChannel_processMessages(source);
+        canChannel_processMessages(destination);
+    }
+    wallNs = bench_nowNs() - wallStart;
+    stats = canGateway_getRouteStats((uint8_t)(routeCount - 1U));
+
+    printf("CAN gateway forwarding latency (loopback channel %u -> %u)\n", BENCH_SOURCE, BENCH_DESTINATION);
+    printf("  frames:           %u (%u routes%s)\n", frames, routeCount, rewrite ? ", ID rewrite" : "");
+    printf("  forwarded:        %u\n", stats->forwardedCount);
+    printf("  received:         %u\n", receivedCount);
+    printf("  dropped:          %u\n", stats->droppedCount);
+    if (receivedCount > 0U) {
+        printf("  latency min:      %llu ns\n", (unsigned long long)latencyMinNs);
+        printf("  latency avg:      %.1f ns\n", (double)latencyTotalNs / (double)receivedCount);
+        printf("  latency p50:      < %llu ns\n", (unsigned long long)bench_percentileNs(50U));
+        printf("  latency p99:      < %llu ns\n", (unsigned long long)bench_percentileNs(99U));
+        printf("  latency max:      %llu ns\n", (unsigned long long)latencyMaxNs);
+    }
+    printf("  frames/sec:       %.0f\n", ((double)frames * 1e9) / (double)(wallNs ? wallNs : 1U));
+
+    return EXIT_SUCCESS;
+}
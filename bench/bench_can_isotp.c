@@ -0,0 +1,137 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "can_manager.h"
+#include "can_transport.h"
+#include "can_isotp.h"
+#include "time_base.h"
+
+#define BENCH_TRANSFERS     (200U)
+#define BENCH_SENDER        (0U)
+#define BENCH_RECEIVER      (1U)
+#define BENCH_REQUEST_ID    (0x7E0U)
+#define BENCH_RESPONSE_ID   (0x7E8U)
+
+static uint8_t payload[CAN_ISOTP_MAX_PAYLOAD];
+static uint32_t receivedMessages;
+static uint32_t receivedBytes;
+static bool receivedIntact;
+
+static void bench_receive(uint8_t channel, const uint8_t* data, uint32_t length);
+static bool bench_setup(uint8_t blockSize);
+static double bench_run(uint32_t length, uint8_t blockSize, uint32_t* framesPerTransfer);
+
+/*
+ * Receiver callback: count and verify the reassembled message
+ */
+static void bench_receive(uint8_t channel, const uint8_t* data, uint32_t length)
+{
+    (void)channel;
+    receivedMessages++;
+    receivedBytes += length;
+    if (memcmp(data, payload, length) != 0) {
+        receivedIntact = false;
+    }
+}
+
+/*
+ * Loopback bus with both ends of the link on one CAN manager: the sender
+ * transmits on the request ID the receiver listens to and vice versa
+ */
+static bool bench_setup(uint8_t blockSize)
+{
+    canConfig_t config = {0};
+    canIsotpConfig_t sender = {0};
+    canIsotpConfig_t receiver = {0};
+
+    config.baudrate = 500000;
+    config.transport = &canTransport_loopback;
+    config.rxQueueDepth = CAN_RX_QUEUE_DEPTH_MAX;
+    if (!canManager_init(&config)) {
+        return false;
+    }
+    canManager_setRxCallback(NULL);
+
+    sender.txId = BENCH_REQUEST_ID;
+    sender.rxId = BENCH_RESPONSE_ID;
+    receiver.txId = BENCH_RESPONSE_ID;
+    receiver.rxId = BENCH_REQUEST_ID;
+    receiver.blockSize = blockSize;
+    receiver.rxCallback = bench_receive;
+
+    return canIsotp_open(BENCH_SENDER, &sender) && canIsotp_open(BENCH_RECEIVER, &receiver);
+}
+
+/*
+ * Move BENCH_TRANSFERS messages of the given length across the loopback.
+ * Returns payload throughput in kB/s of CPU time (the bus is not paced).
+ */
+static double bench_run(uint32_t length, uint8_t blockSize, uint32_t* framesPerTransfer)
+{
+    uint64_t start;
+    uint64_t elapsed;
+    uint32_t i;
+
+    if (!bench_setup(blockSize)) {
+        return 0.0;
+    }
+
+    receivedMessages = 0U;
+    receivedBytes = 0U;
+    receivedIntact = true;
+
+    start = timeBase_nowUs();
+    for (i = 0U; i < BENCH_TRANSFERS; i++) {
+        while (canIsotp_send(BENCH_SENDER, payload, length) != CAN_STATUS_OK) {
+            canManager_processMessages();
+            canIsotp_poll();
+        }
+        while (receivedMessages <= i) {
+            canManager_processMessages();
+            canIsotp_poll();
+        }
+    }
+    elapsed = timeBase_nowUs() - start;
+
+    *framesPerTransfer = canManager_getStats()->txCount / BENCH_TRANSFERS;
+    if (!receivedIntact || (receivedBytes != (length * BENCH_TRANSFERS))) {
+        return 0.0;
+    }
+    if (elapsed == 0U) {
+        elapsed = 1U;
+    }
+
+    return ((double)receivedBytes * 1000.0) / (double)elapsed;
+}
+
+/*
+ * Print ISO-TP throughput against message length and receiver block size
+ */
+int main(void)
+{
+    static const uint32_t lengths[] = {7U, 64U, 512U, 4095U};
+    static const uint8_t blockSizes[] = {0U, 8U, 32U};
+    uint32_t i;
+    size_t l;
+    size_t b;
+
+    for (i = 0U; i < CAN_ISOTP_MAX_PAYLOAD; i++) {
+        payload[i] = (uint8_t)(i * 7U);
+    }
+
+    printf("ISO-TP loopback throughput (%u transfers per row, STmin 0)\n", BENCH_TRANSFERS);
+    printf("%10s %6s %12s %12s\n", "bytes", "BS", "frames/msg", "kB/s");
+
+    for (l = 0U; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+        for (b = 0U; b < sizeof(blockSizes) / sizeof(blockSizes[0]); b++) {
+            uint32_t frames = 0U;
+            double throughput = bench_run(lengths[l], blockSizes[b], &frames);
+
+            printf("%10u %6u %12u %12.1f\n", lengths[l], blockSizes[b], frames, throughput);
+        }
+    }
+
+    return 0;
+}
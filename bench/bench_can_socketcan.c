@@ -0,0 +1,170 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "can_manager.h"
+#include "can_transport.h"
+#include "can_socketcan.h"
+
+#define BENCH_FRAMES_DEFAULT    (200000U)
+#define BENCH_BATCH_MAX         (256U)
+
+static canSocketcan_t sender;
+static canSocketcan_t receiver;
+
+static void print_usage(const char* program_name);
+static uint64_t bench_nowNs(void);
+static bool bench_open(const char* interfaceName, int pair[2]);
+static void bench_run(uint32_t frames, uint32_t batchSize);
+
+/*
+ * Print usage information
+ */
+static void print_usage(const char* program_name)
+{
+    printf("Usage: %s [-i interface] [-n frames] [-b batch]\n", program_name);
+    printf("  -i  CAN interface, e.g. vcan0 (default: socketpair stand-in)\n");
+    printf("  -n  Frames per run (default: %u)\n", BENCH_FRAMES_DEFAULT);
+    printf("  -b  Frames per sendBatch call in the batched run (default: %u, max: %u)\n",
+           CAN_SOCKETCAN_BATCH, BENCH_BATCH_MAX);
+}
+
+/*
+ * Monotonic time in nanoseconds
+ */
+static uint64_t bench_nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Two sockets on the interface, or the two ends of a socketpair
+ */
+static bool bench_open(const char* interfaceName, int pair[2])
+{
+    canConfig_t config = {0};
+
+    sender.interfaceName = interfaceName;
+    receiver.interfaceName = interfaceName;
+    sender.fd = -1;
+    receiver.fd = -1;
+
+    if (interfaceName == NULL) {
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK, 0, pair) != 0) {
+            return false;
+        }
+        sender.fd = pair[0];
+        receiver.fd = pair[1];
+    }
+
+    return canTransport_socketcan.open(&sender, &config) && canTransport_socketcan.open(&receiver, &config);
+}
+
+/*
+ * Move frames from sender to receiver, batchSize frames per send call,
+ * draining the receiver after each one. Reports time and syscalls per frame.
+ */
+static void bench_run(uint32_t frames, uint32_t batchSize)
+{
+    canFrame_t batch[BENCH_BATCH_MAX];
+    const canFrame_t* pointers[BENCH_BATCH_MAX];
+    canFrame_t frame;
+    uint32_t done = 0U;
+    uint32_t received = 0U;
+    uint32_t sent;
+    uint32_t i;
+    uint64_t start;
+    uint64_t elapsedNs;
+
+    memset(batch, 0, sizeof(batch));
+    for (i = 0U; i < batchSize; i++) {
+        batch[i].id = 0x100U + i;
+        batch[i].dlc = CAN_MAX_DATA_LENGTH;
+        pointers[i] = &batch[i];
+    }
+    memset(&sender.stats, 0, sizeof(sender.stats));
+    memset(&receiver.stats, 0, sizeof(receiver.stats));
+
+    start = bench_nowNs();
+    while (done < frames) {
+        if (batchSize == 1U) {
+            sent = (canTransport_socketcan.send(&sender, &batch[0]) == CAN_STATUS_OK) ? 1U : 0U;
+        } else {
+            (void)canTransport_socketcan.sendBatch(&sender, pointers, batchSize, &sent);
+        }
+        done += sent;
+        while (canTransport_socketcan.recv(&receiver, &frame) == CAN_STATUS_OK) {
+            received++;
+        }
+    }
+    elapsedNs = bench_nowNs() - start;
+
+    printf("  batch %3u: %7.1f ns/frame, %.3f tx syscalls/frame, %.3f rx syscalls/frame, %u received\n",
+           batchSize, (double)elapsedNs / (double)done,
+           (double)sender.stats.txSyscallCount / (double)done,
+           (double)receiver.stats.rxSyscallCount / (double)done, received);
+}
+
+/*
+ * Syscall cost per frame, one frame per call against batched calls
+ */
+int main(int argc, char* argv[])
+{
+    const char* interfaceName = NULL;
+    uint32_t frames = BENCH_FRAMES_DEFAULT;
+    uint32_t batchSize = CAN_SOCKETCAN_BATCH;
+    int pair[2] = {-1, -1};
+    int option;
+
+    while ((option = getopt(argc, argv, "i:n:b:")) != -1) {
+        switch (option) {
+            case 'i':
+                interfaceName = optarg;
+                break;
+            case 'n':
+                frames = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                batchSize = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if ((frames == 0U) || (batchSize == 0U) || (batchSize > BENCH_BATCH_MAX)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (!bench_open(interfaceName, pair)) {
+        printf("Error: cannot open %s\n", (interfaceName != NULL) ? interfaceName : "socketpair");
+        return EXIT_FAILURE;
+    }
+
+    printf("SocketCAN syscall cost (%s, %u frames per run)\n",
+           (interfaceName != NULL) ? interfaceName : "socketpair stand-in", frames);
+    bench_run(frames, 1U);
+    bench_run(frames, batchSize);
+
+    canTransport_socketcan.close(&sender);
+    canTransport_socketcan.close(&receiver);
+    if (pair[0] >= 0) {
+        (void)close(pair[0]);
+        (void)close(pair[1]);
+    }
+
+    return EXIT_SUCCESS;
+}
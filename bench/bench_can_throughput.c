@@ -0,0 +1,227 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "can_manager.h"
+#include "can_db.h"
+#include "time_base.h"
+
+#define BENCH_FRAMES_DEFAULT    (1000000U)
+#define BENCH_COMMAND_PERCENT   (10U)
+#define BENCH_BURST_DEFAULT     (16U)
+#define BENCH_PATTERN_SIZE      (4096U)
+
+typedef struct {
+    uint32_t frames;
+    uint32_t commandPercent;
+    uint32_t burst;
+    uint32_t rxQueueDepth;
+    bool filter;
+    bool periodicTx;
+} benchOptions_t;
+
+static canFrame_t pattern[BENCH_PATTERN_SIZE];
+
+static void print_usage(const char* program_name);
+static uint64_t bench_nowNs(clockid_t clock);
+static uint32_t bench_random(uint32_t* state);
+static void bench_buildPattern(const benchOptions_t* options);
+static bool bench_setup(const benchOptions_t* options);
+
+/*
+ * Print usage information
+ */
+static void print_usage(const char* program_name)
+{
+    printf("Usage: %s [-n frames] [-c percent] [-b burst] [-q depth] [-f] [-x]\n", program_name);
+    printf("  -n  Frames offered to the RX path (default: %u)\n", BENCH_FRAMES_DEFAULT);
+    printf("  -c  Share of setpoint/PID command frames in percent (default: %u)\n", BENCH_COMMAND_PERCENT);
+    printf("  -b  Frames offered per processMessages call (default: %u)\n", BENCH_BURST_DEFAULT);
+    printf("  -q  RX queue depth (default: %u, max: %u)\n", CAN_RX_QUEUE_DEPTH_DEFAULT, CAN_RX_QUEUE_DEPTH_MAX);
+    printf("  -f  Accept only the command IDs in the acceptance filter\n");
+    printf("  -x  Skip the periodic TX path\n");
+}
+
+/*
+ * Time in nanoseconds on the given clock
+ */
+static uint64_t bench_nowNs(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * xorshift32 so every run offers the same frame sequence
+ */
+static uint32_t bench_random(uint32_t* state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+/*
+ * Repeating frame pattern: command frames with valid payloads mixed with
+ * unrelated standard IDs that have no handler
+ */
+static void bench_buildPattern(const benchOptions_t* options)
+{
+    canDbSetpointCmd_t setpoint = {30.0f};
+    canDbPidTuneCmd_t tune = {2.0f, 0.5f, 0.1f};
+    uint32_t seed = 0x2468ACE1U;
+    uint32_t i;
+
+    for (i = 0U; i < BENCH_PATTERN_SIZE; i++) {
+        canFrame_t* frame = &pattern[i];
+        uint32_t draw = bench_random(&seed);
+
+        memset(frame, 0, sizeof(*frame));
+        if ((draw % 100U) < options->commandPercent) {
+            if ((draw & 0x100U) != 0U) {
+                frame->id = CAN_MSG_SETPOINT_CMD;
+                frame->dlc = CAN_DB_SETPOINT_CMD_LENGTH;
+                (void)canDb_packSetpointCmd(&setpoint, frame->data);
+            } else {
+                frame->id = CAN_MSG_PID_TUNE_CMD;
+                frame->dlc = CAN_DB_PID_TUNE_CMD_LENGTH;
+                (void)canDb_packPidTuneCmd(&tune, frame->data);
+            }
+        } else {
+            frame->id = 0x300U + ((draw >> 8) % 0x400U);
+            frame->dlc = CAN_MAX_DATA_LENGTH;
+            memset(frame->data, (int)(draw & 0xFFU), CAN_MAX_DATA_LENGTH);
+        }
+    }
+}
+
+/*
+ * In-memory CAN manager: null transport, no RX callback, virtual time base
+ */
+static bool bench_setup(const benchOptions_t* options)
+{
+    canConfig_t config = {0};
+    canFilter_t filter = {CAN_MSG_SETPOINT_CMD, 0x7FCU, false};
+
+    timeBase_useVirtual(0U);
+
+    config.baudrate = 500000;
+    config.rxQueueDepth = options->rxQueueDepth;
+    if (!canManager_init(&config)) {
+        return false;
+    }
+    canManager_setRxCallback(NULL);
+
+    if (options->filter && !canManager_setFilter(0U, &filter)) {
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Flood the RX path and report throughput, drops and CPU per frame
+ */
+int main(int argc, char* argv[])
+{
+    benchOptions_t options = {BENCH_FRAMES_DEFAULT, BENCH_COMMAND_PERCENT, BENCH_BURST_DEFAULT,
+                              CAN_RX_QUEUE_DEPTH_DEFAULT, false, true};
+    const canStats_t* stats;
+    uint64_t wallStart;
+    uint64_t cpuStart;
+    uint64_t wallNs;
+    uint64_t cpuNs;
+    uint32_t offered = 0U;
+    uint32_t index = 0U;
+    int option;
+
+    while ((option = getopt(argc, argv, "n:c:b:q:fx")) != -1) {
+        switch (option) {
+            case 'n':
+                options.frames = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                options.commandPercent = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                options.burst = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'q':
+                options.rxQueueDepth = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                options.filter = true;
+                break;
+            case 'x':
+                options.periodicTx = false;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if ((options.frames == 0U) || (options.burst == 0U) || (options.commandPercent > 100U)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bench_buildPattern(&options);
+    if (!bench_setup(&options)) {
+        printf("Error: CAN manager setup failed\n");
+        return EXIT_FAILURE;
+    }
+
+    wallStart = bench_nowNs(CLOCK_MONOTONIC);
+    cpuStart = bench_nowNs(CLOCK_PROCESS_CPUTIME_ID);
+    while (offered < options.frames) {
+        uint32_t i;
+
+        for (i = 0U; (i < options.burst) && (offered < options.frames); i++) {
+            (void)canManager_enqueueRxFrame(&pattern[index]);
+            index = (index + 1U) % BENCH_PATTERN_SIZE;
+            offered++;
+        }
+        canManager_processMessages();
+
+        if (options.periodicTx) {
+            timeBase_advanceUs((uint64_t)CAN_SCHEDULE_TICK_MS * 1000U);
+            canManager_periodicSend();
+            (void)canManager_flushTx();
+        }
+    }
+    wallNs = bench_nowNs(CLOCK_MONOTONIC) - wallStart;
+    cpuNs = bench_nowNs(CLOCK_PROCESS_CPUTIME_ID) - cpuStart;
+    stats = canManager_getStats();
+
+    printf("CAN RX/TX throughput (in-memory path)\n");
+    printf("  frames offered:   %u (%u%% commands, burst %u, queue %u%s%s)\n",
+           offered, options.commandPercent, options.burst, options.rxQueueDepth,
+           options.filter ? ", filtered" : "", options.periodicTx ? ", periodic TX" : "");
+    printf("  processed:        %u\n", stats->rxCount);
+    printf("  filtered:         %u\n", stats->rxFilteredCount);
+    printf("  superseded:       %u\n", stats->rxSupersededCount);
+    printf("  dropped:          %u (%.2f%%)\n", stats->rxOverrunCount,
+           (100.0 * (double)stats->rxOverrunCount) / (double)offered);
+    printf("  transmitted:      %u\n", stats->txCount);
+    printf("  frames/sec:       %.0f\n", ((double)offered * 1e9) / (double)(wallNs ? wallNs : 1U));
+    printf("  ns/frame:         %.1f\n", (double)wallNs / (double)offered);
+    printf("  CPU ns/frame:     %.1f\n", (double)cpuNs / (double)offered);
+    printf("  RX queue peak:    %u\n", stats->rxQueueHighWater);
+
+    return EXIT_SUCCESS;
+}
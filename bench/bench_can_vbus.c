@@ -0,0 +1,234 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "can_manager.h"
+#include "can_transport.h"
+#include "can_vbus.h"
+
+#define BENCH_NODES_DEFAULT     (4U)
+#define BENCH_NODES_MAX         (64U)
+#define BENCH_FRAMES_DEFAULT    (100000U)
+#define BENCH_BATCH             (8U)
+
+static void print_usage(const char* program_name);
+static uint64_t bench_nowNs(void);
+static void bench_producer(const char* name, uint32_t node, uint32_t frames, uint32_t baudrate);
+static bool bench_run(const char* name, uint32_t nodes, uint32_t frames, uint32_t baudrate);
+
+/*
+ * Print usage information
+ */
+static void print_usage(const char* program_name)
+{
+    printf("Usage: %s [-p nodes] [-n frames] [-b baudrate]\n", program_name);
+    printf("  -p  Producer processes (default: %u, max: %u)\n", BENCH_NODES_DEFAULT, BENCH_NODES_MAX);
+    printf("  -n  Frames per producer (default: %u)\n", BENCH_FRAMES_DEFAULT);
+    printf("  -b  Bit-time model at this bit rate, e.g. 500000 (default: off)\n");
+}
+
+/*
+ * Monotonic time in nanoseconds
+ */
+static uint64_t bench_nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Child process: join the bus and send frames in batches, as a channel's
+ * TX flush would, yielding after each so readers sharing a CPU keep up
+ */
+static void bench_producer(const char* name, uint32_t node, uint32_t frames, uint32_t baudrate)
+{
+    canVbus_t vbus;
+    canConfig_t config = {0};
+    canFrame_t batch[BENCH_BATCH];
+    const canFrame_t* pointers[BENCH_BATCH];
+    uint32_t done = 0U;
+    uint32_t chunk;
+    uint32_t sent;
+    uint32_t i;
+
+    memset(&vbus, 0, sizeof(vbus));
+    memset(batch, 0, sizeof(batch));
+    vbus.name = name;
+    vbus.bitTiming = (baudrate != 0U);
+    config.baudrate = baudrate;
+    for (i = 0U; i < BENCH_BATCH; i++) {
+        batch[i].id = 0x100U + node;
+        batch[i].dlc = CAN_MAX_DATA_LENGTH;
+        pointers[i] = &batch[i];
+    }
+
+    if (!canTransport_vbus.open(&vbus, &config)) {
+        _exit(EXIT_FAILURE);
+    }
+
+    while (done < frames) {
+        chunk = ((frames - done) < BENCH_BATCH) ? (frames - done) : BENCH_BATCH;
+        (void)canTransport_vbus.sendBatch(&vbus, pointers, chunk, &sent);
+        done += sent;
+        (void)sched_yield();
+    }
+
+    canTransport_vbus.close(&vbus);
+    _exit(EXIT_SUCCESS);
+}
+
+/*
+ * Fork the producers and drain the bus in this process until every frame
+ * has arrived or been counted as dropped. Reports delivery cost and, with
+ * the bit-time model, the bus time the frames occupied.
+ */
+static bool bench_run(const char* name, uint32_t nodes, uint32_t frames, uint32_t baudrate)
+{
+    canVbus_t reader;
+    canConfig_t config = {0};
+    canFrame_t frame;
+    uint64_t total = (uint64_t)nodes * frames;
+    uint64_t start;
+    uint64_t elapsedNs;
+    uint64_t firstNs = 0U;
+    uint64_t lastNs = 0U;
+    uint64_t drainedNs = 0U;
+    pid_t child;
+    uint32_t exited = 0U;
+    uint32_t i;
+    int status;
+    bool result = true;
+
+    memset(&reader, 0, sizeof(reader));
+    reader.name = name;
+    config.baudrate = baudrate;
+    if (!canTransport_vbus.open(&reader, &config)) {
+        return false;
+    }
+
+    start = bench_nowNs();
+    for (i = 0U; i < nodes; i++) {
+        child = fork();
+        if (child == 0) {
+            bench_producer(name, i, frames, baudrate);
+        }
+        if (child < 0) {
+            result = false;
+            exited++;
+        }
+    }
+
+    /* Stop early only once every producer is gone and whatever they left
+       on the wire has had time to arrive */
+    while (((uint64_t)reader.stats.rxFrameCount + reader.stats.rxDropCount) < total) {
+        if (canTransport_vbus.recv(&reader, &frame) == CAN_STATUS_OK) {
+            lastNs = bench_nowNs();
+            if (firstNs == 0U) {
+                firstNs = lastNs;
+            }
+            continue;
+        }
+
+        if (exited == nodes) {
+            if (bench_nowNs() > (drainedNs + (2U * CAN_VBUS_TX_BACKLOG_US * 1000U))) {
+                break;
+            }
+        } else if (waitpid(-1, &status, WNOHANG) > 0) {
+            exited++;
+            drainedNs = bench_nowNs();
+            if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS)) {
+                result = false;
+            }
+        } else {
+            (void)sched_yield();
+        }
+    }
+    elapsedNs = bench_nowNs() - start;
+
+    while (wait(&status) > 0) {
+        if (!WIFEXITED(status) || (WEXITSTATUS(status) != EXIT_SUCCESS)) {
+            result = false;
+        }
+    }
+
+    printf("  %u nodes x %u frames: %7.1f ns/frame, %u received, %u dropped",
+           nodes, frames, (double)elapsedNs / (double)total,
+           reader.stats.rxFrameCount, reader.stats.rxDropCount);
+    if (baudrate != 0U) {
+        printf(", %.1f ms on the bus", (double)(lastNs - firstNs) / 1000000.0);
+    }
+    printf("\n");
+
+    canTransport_vbus.close(&reader);
+
+    return result;
+}
+
+/*
+ * Broadcast throughput of the shared-memory bus as producers are added
+ */
+int main(int argc, char* argv[])
+{
+    char name[64];
+    uint32_t nodes = BENCH_NODES_DEFAULT;
+    uint32_t frames = BENCH_FRAMES_DEFAULT;
+    uint32_t baudrate = 0U;
+    uint32_t count;
+    int option;
+    bool result = true;
+
+    while ((option = getopt(argc, argv, "p:n:b:")) != -1) {
+        switch (option) {
+            case 'p':
+                nodes = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                frames = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                baudrate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if ((nodes == 0U) || (nodes > BENCH_NODES_MAX) || (frames == 0U)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    (void)snprintf(name, sizeof(name), "/bench_can_vbus_%d", (int)getpid());
+    printf("Virtual bus broadcast (%s, ring depth %u)\n",
+           (baudrate != 0U) ? "bit-time model" : "no bit-time model", CAN_VBUS_DEPTH);
+
+    count = 1U;
+    while (result) {
+        (void)canVbus_unlink(name);
+        result = bench_run(name, count, frames, baudrate);
+        if (count == nodes) {
+            break;
+        }
+        count = ((count * 2U) < nodes) ? (count * 2U) : nodes;
+    }
+    (void)canVbus_unlink(name);
+
+    if (!result) {
+        printf("Error: cannot run on the virtual bus\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
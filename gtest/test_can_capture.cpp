@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+extern "C" {
+    #include "can_manager.h"
+    #include "can_transport.h"
+    #include "can_capture.h"
+}
+
+static uint32_t replayCount;
+static std::vector<uint32_t> replayIds;
+
+static void replayCallback(const canFrame_t* frame) {
+    replayCount++;
+    replayIds.push_back(frame->id);
+}
+
+class CANCaptureTest : public ::testing::Test {
+protected:
+    std::string capturePath;
+    std::string textPath;
+    canLoopback_t loopback;
+
+    void SetUp() override {
+        std::string name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        capturePath = "can_capture_" + name + ".bin";
+        textPath = "can_capture_" + name + ".log";
+
+        canConfig_t config = {};
+        config.transport = &canTransport_loopback;
+        config.transportContext = &loopback;
+        config.fdEnabled = true;
+        ASSERT_TRUE(canManager_init(&config));
+        canManager_setRxCallback(nullptr);
+    }
+
+    void TearDown() override {
+        canCapture_stop();
+        std::remove(capturePath.c_str());
+        std::remove(textPath.c_str());
+    }
+
+    void recordTraffic() {
+        canFrame_t frame = {};
+
+        ASSERT_TRUE(canCapture_start(capturePath.c_str()));
+        EXPECT_TRUE(canCapture_isActive());
+
+        frame.id = 0x123;
+        frame.dlc = 4;
+        frame.data[0] = 0xDE;
+        frame.data[1] = 0xAD;
+        frame.data[2] = 0xBE;
+        frame.data[3] = 0xEF;
+        EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_OK);
+
+        frame = {};
+        frame.id = 0x18FF1234u;
+        frame.extended = true;
+        frame.fd = true;
+        frame.brs = true;
+        frame.dlc = 9;
+        for (int i = 0; i < 12; i++) {
+            frame.data[i] = (uint8_t)i;
+        }
+        EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_OK);
+
+        canManager_processMessages();
+        canCapture_stop();
+        EXPECT_FALSE(canCapture_isActive());
+    }
+};
+
+TEST_F(CANCaptureTest, RecordAndReadBackTest) {
+    recordTraffic();
+
+    canCaptureStats_t stats = canCapture_getStats();
+    EXPECT_EQ(stats.recordedCount, 4u);
+    EXPECT_EQ(stats.writtenCount, 4u);
+    EXPECT_EQ(stats.droppedCount, 0u);
+    EXPECT_EQ(stats.writeErrorCount, 0u);
+
+    canCaptureReader_t reader;
+    canCaptureRecord_t record;
+    std::vector<canCaptureRecord_t> records;
+    ASSERT_TRUE(canCapture_openReader(&reader, capturePath.c_str()));
+    while (canCapture_readRecord(&reader, &record)) {
+        records.push_back(record);
+    }
+    canCapture_closeReader(&reader);
+
+    ASSERT_EQ(records.size(), 4u);
+    EXPECT_TRUE(records[0].tx);
+    EXPECT_TRUE(records[1].tx);
+    EXPECT_FALSE(records[2].tx);
+    EXPECT_FALSE(records[3].tx);
+    EXPECT_EQ(records[0].frame.id, 0x123u);
+    EXPECT_EQ(records[0].frame.data[3], 0xEF);
+    EXPECT_TRUE(records[3].frame.extended);
+    EXPECT_TRUE(records[3].frame.fd);
+    EXPECT_TRUE(records[3].frame.brs);
+    EXPECT_EQ(records[3].frame.dlc, 9u);
+    EXPECT_EQ(records[3].frame.data[11], 11);
+    for (size_t i = 1; i < records.size(); i++) {
+        EXPECT_GE(records[i].frame.timestampUs, records[i - 1].frame.timestampUs);
+    }
+}
+
+TEST_F(CANCaptureTest, CandumpExportTest) {
+    recordTraffic();
+
+    ASSERT_TRUE(canCapture_exportCandump(capturePath.c_str(), textPath.c_str(), "vcan0"));
+
+    std::ifstream text(textPath);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(text, line)) {
+        lines.push_back(line);
+    }
+
+    ASSERT_EQ(lines.size(), 4u);
+    EXPECT_EQ(lines[0].front(), '(');
+    EXPECT_NE(lines[0].find(") vcan0 123#DEADBEEF"), std::string::npos);
+    EXPECT_NE(lines[1].find(" vcan0 18FF1234##1000102030405060708090A0B"), std::string::npos);
+}
+
+TEST_F(CANCaptureTest, ReplayTest) {
+    recordTraffic();
+
+    canConfig_t config = {};
+    config.fdEnabled = true;
+    ASSERT_TRUE(canManager_init(&config));
+    canManager_setRxCallback(replayCallback);
+    replayCount = 0;
+    replayIds.clear();
+
+    uint32_t replayed = 0;
+    ASSERT_TRUE(canCapture_replay(capturePath.c_str(), CAN_REPLAY_MAX_SPEED, false, &replayed));
+    EXPECT_EQ(replayed, 2u);
+    ASSERT_EQ(replayCount, 2u);
+    EXPECT_EQ(replayIds[0], 0x123u);
+    EXPECT_EQ(replayIds[1], 0x18FF1234u);
+
+    replayCount = 0;
+    ASSERT_TRUE(canCapture_replay(capturePath.c_str(), CAN_REPLAY_ORIGINAL_SPEED, true, &replayed));
+    EXPECT_EQ(replayed, 4u);
+    EXPECT_EQ(replayCount, 4u);
+
+    EXPECT_FALSE(canCapture_replay("does_not_exist.bin", CAN_REPLAY_MAX_SPEED, false, &replayed));
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <cstring>
+extern "C" {
+    #include "can_db.h"
+    #include "can_manager.h"
+    #include "pid_controller.h"
+}
+
+class CANDbTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        canConfig_t config = {};
+        config.baudrate = 250000;
+
+        ASSERT_TRUE(canManager_init(&config));
+        canManager_setRxCallback(nullptr);
+    }
+
+    void TearDown() override {
+        pid_setGains(PID_DEFAULT_KP, PID_DEFAULT_KI, PID_DEFAULT_KD);
+        pid_setSetpoint(PID_DEFAULT_SETPOINT);
+    }
+};
+
+TEST_F(CANDbTest, PidParamsLayoutTest) {
+    canDbPidParams_t msg = {1.234f, 0.5f, 0.089f, 45.6f};
+    uint8_t data[CAN_DB_PID_PARAMS_LENGTH];
+
+    EXPECT_TRUE(canDb_packPidParams(&msg, data));
+
+    EXPECT_EQ(data[0] | (data[1] << 8), 1234);
+    EXPECT_EQ(data[2] | (data[3] << 8), 500);
+    EXPECT_EQ(data[4] | (data[5] << 8), 89);
+    EXPECT_EQ(data[6] | (data[7] << 8), 456);
+
+    canDbPidParams_t decoded;
+    EXPECT_TRUE(canDb_unpackPidParams(&decoded, data, sizeof(data)));
+    EXPECT_NEAR(decoded.kp, 1.234f, 0.0005f);
+    EXPECT_NEAR(decoded.ki, 0.5f, 0.0005f);
+    EXPECT_NEAR(decoded.kd, 0.089f, 0.0005f);
+    EXPECT_NEAR(decoded.setpoint, 45.6f, 0.05f);
+}
+
+TEST_F(CANDbTest, FloatSignalRoundTripTest) {
+    canDbTempStatus_t msg = {85.5f, 2};
+    uint8_t data[CAN_DB_TEMP_STATUS_LENGTH];
+    uint8_t legacy[4];
+
+    EXPECT_TRUE(canDb_packTempStatus(&msg, data));
+    canManager_floatToBytes(85.5f, legacy);
+    EXPECT_EQ(memcmp(data, legacy, sizeof(legacy)), 0);
+    EXPECT_EQ(data[4], 2);
+
+    canDbTempStatus_t decoded;
+    EXPECT_TRUE(canDb_unpackTempStatus(&decoded, data, sizeof(data)));
+    EXPECT_FLOAT_EQ(decoded.temperature, 85.5f);
+    EXPECT_EQ(decoded.status, 2);
+}
+
+TEST_F(CANDbTest, RangeCheckTest) {
+    canDbPidParams_t msg = {-1.0f, 70.0f, 0.0f, 30.0f};
+    uint8_t data[CAN_DB_PID_PARAMS_LENGTH];
+
+    EXPECT_FALSE(canDb_packPidParams(&msg, data));
+    EXPECT_EQ(data[0] | (data[1] << 8), 0);
+    EXPECT_EQ(data[2] | (data[3] << 8), 65535);
+
+    canDbTempStatus_t temp = {20.0f, 7};
+    uint8_t tempData[CAN_DB_TEMP_STATUS_LENGTH];
+    EXPECT_FALSE(canDb_packTempStatus(&temp, tempData));
+    EXPECT_EQ(tempData[4], 3);
+
+    tempData[4] = 9;
+    EXPECT_FALSE(canDb_unpackTempStatus(&temp, tempData, sizeof(tempData)));
+    EXPECT_FALSE(canDb_unpackTempStatus(&temp, tempData, CAN_DB_TEMP_STATUS_LENGTH - 1));
+}
+
+TEST_F(CANDbTest, PidTuneCommandTest) {
+    canDbPidTuneCmd_t cmd = {2.5f, 0.25f, 0.125f};
+    canFrame_t frame = {};
+
+    frame.id = CAN_DB_PID_TUNE_CMD_ID;
+    frame.dlc = CAN_DB_PID_TUNE_CMD_LENGTH;
+    ASSERT_TRUE(canDb_packPidTuneCmd(&cmd, frame.data));
+    canManager_dispatchFrame(&frame);
+
+    float kp, ki, kd;
+    pid_getGains(&kp, &ki, &kd);
+    EXPECT_FLOAT_EQ(kp, 2.5f);
+    EXPECT_FLOAT_EQ(ki, 0.25f);
+    EXPECT_FLOAT_EQ(kd, 0.125f);
+
+    frame.dlc = 6;
+    cmd.kp = 9.0f;
+    ASSERT_TRUE(canDb_packPidTuneCmd(&cmd, frame.data));
+    canManager_dispatchFrame(&frame);
+    pid_getGains(&kp, &ki, &kd);
+    EXPECT_FLOAT_EQ(kp, 2.5f);
+}
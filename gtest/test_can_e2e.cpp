@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <cstring>
+extern "C" {
+    #include "can_manager.h"
+    #include "can_transport.h"
+    #include "can_e2e.h"
+    #include "time_base.h"
+}
+
+static uint32_t deliveredCount;
+static canFrame_t lastDelivered;
+
+static void deliveredHandler(const canFrame_t* frame) {
+    deliveredCount++;
+    lastDelivered = *frame;
+}
+
+class CANE2eTest : public ::testing::Test {
+protected:
+    canLoopback_t loopback;
+
+    void SetUp() override {
+        canConfig_t config = {};
+        config.transport = &canTransport_loopback;
+        config.transportContext = &loopback;
+
+        timeBase_useVirtual(0);
+        canE2e_init();
+        ASSERT_TRUE(canManager_init(&config));
+        canManager_setRxCallback(nullptr);
+        deliveredCount = 0;
+    }
+
+    void TearDown() override {
+        timeBase_useMonotonic();
+    }
+};
+
+TEST_F(CANE2eTest, CrcCheckValueTest) {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+    EXPECT_EQ(canE2e_crc8(check, sizeof(check), CAN_E2E_CRC8_INIT) ^ CAN_E2E_CRC8_XOROUT, 0x4B);
+    EXPECT_EQ(canE2e_crc16(check, sizeof(check), CAN_E2E_CRC16_INIT), 0x29B1);
+
+    /* Sliced and byte-at-a-time updates agree for every length */
+    uint8_t data[64];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 37 + 11);
+    }
+    for (uint32_t length = 0; length <= sizeof(data); length++) {
+        uint8_t crc8 = CAN_E2E_CRC8_INIT;
+        uint16_t crc16 = CAN_E2E_CRC16_INIT;
+        for (uint32_t i = 0; i < length; i++) {
+            crc8 = canE2e_crc8(&data[i], 1, crc8);
+            crc16 = canE2e_crc16(&data[i], 1, crc16);
+        }
+        EXPECT_EQ(canE2e_crc8(data, length, CAN_E2E_CRC8_INIT), crc8);
+        EXPECT_EQ(canE2e_crc16(data, length, CAN_E2E_CRC16_INIT), crc16);
+    }
+}
+
+TEST_F(CANE2eTest, ProtectCheckTest) {
+    canE2eConfig_t config = {0x202, false, CAN_E2E_PROFILE_CRC8, 1};
+    canE2eState_t tx = {};
+    canE2eState_t rx = {};
+    canFrame_t frame = {};
+    frame.id = 0x202;
+    frame.dlc = 1;
+    frame.data[0] = 0x02;
+
+    canFrame_t first = frame;
+    ASSERT_TRUE(canE2e_protect(&config, &tx, &first));
+    EXPECT_EQ(first.dlc, 3);
+    EXPECT_EQ(canE2e_check(&config, &rx, &first), CAN_E2E_OK);
+    EXPECT_EQ(canE2e_check(&config, &rx, &first), CAN_E2E_ERROR_REPEATED);
+
+    canFrame_t second = frame;
+    ASSERT_TRUE(canE2e_protect(&config, &tx, &second));
+    canFrame_t corrupted = second;
+    corrupted.data[0] ^= 0x01;
+    EXPECT_EQ(canE2e_check(&config, &rx, &corrupted), CAN_E2E_ERROR_CRC);
+    corrupted = second;
+    corrupted.id = 0x203;
+    EXPECT_EQ(canE2e_check(&config, &rx, &corrupted), CAN_E2E_ERROR_CRC);
+    EXPECT_EQ(canE2e_check(&config, &rx, &second), CAN_E2E_OK);
+
+    canFrame_t skipped = frame;
+    ASSERT_TRUE(canE2e_protect(&config, &tx, &skipped));
+    EXPECT_FALSE(canE2e_protect(&config, &tx, &skipped));
+    skipped.dlc = 1;
+    ASSERT_TRUE(canE2e_protect(&config, &tx, &skipped));
+    EXPECT_EQ(canE2e_check(&config, &rx, &skipped), CAN_E2E_OK_LOST);
+    skipped.dlc = 2;
+    EXPECT_EQ(canE2e_check(&config, &rx, &skipped), CAN_E2E_ERROR_LENGTH);
+
+    /* CRC-16 on an FD frame; the DLC rounds up and the padding is zeroed */
+    canE2eConfig_t fdConfig = {0x18FF0010, true, CAN_E2E_PROFILE_CRC16, 20};
+    canE2eState_t fdTx = {};
+    canE2eState_t fdRx = {};
+    canFrame_t fd = {};
+    fd.id = 0x18FF0010;
+    fd.extended = true;
+    fd.fd = true;
+    fd.dlc = canManager_lengthToDlc(20);
+    memset(fd.data, 0x5A, 20);
+    ASSERT_TRUE(canE2e_protect(&fdConfig, &fdTx, &fd));
+    EXPECT_EQ(canManager_frameLength(&fd), 24);
+    EXPECT_EQ(fd.data[23], 0);
+    EXPECT_EQ(canE2e_check(&fdConfig, &fdRx, &fd), CAN_E2E_OK);
+
+    fd.dlc = canManager_lengthToDlc(48);
+    EXPECT_FALSE(canE2e_protect(&fdConfig, &fdTx, &fd));
+}
+
+TEST_F(CANE2eTest, ManagerE2eTest) {
+    canE2eConfig_t config = {0x330, false, CAN_E2E_PROFILE_CRC8, 2};
+    ASSERT_TRUE(canManager_setE2e(&config));
+    ASSERT_TRUE(canManager_registerHandler(0x330, false, deliveredHandler));
+
+    canFrame_t frame = {};
+    frame.id = 0x330;
+    frame.dlc = 2;
+    frame.data[0] = 0xAB;
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+    canManager_processMessages();
+    EXPECT_EQ(deliveredCount, 2u);
+    EXPECT_EQ(lastDelivered.dlc, 4);
+    EXPECT_EQ(lastDelivered.data[0], 0xAB);
+
+    /* Unprotected, corrupted and replayed frames never reach the handler */
+    canFrame_t replay = lastDelivered;
+    replay.timestampUs = 0;
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    canFrame_t corrupted = replay;
+    corrupted.data[1] ^= 0x80;
+    EXPECT_EQ(canManager_enqueueRxFrame(&corrupted), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_enqueueRxFrame(&replay), CAN_STATUS_OK);
+    canManager_processMessages();
+    EXPECT_EQ(deliveredCount, 2u);
+
+    const canStats_t* stats = canManager_getStats();
+    EXPECT_EQ(stats->e2eLengthErrorCount, 1u);
+    EXPECT_EQ(stats->e2eCrcErrorCount, 1u);
+    EXPECT_EQ(stats->e2eRepeatedCount, 1u);
+
+    /* A send the backend refuses does not use up a counter value */
+    canFrame_t filler = {};
+    filler.id = 0x100;
+    while (canManager_sendFrame(&filler) == CAN_STATUS_OK) {
+    }
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_OVERRUN);
+    for (uint32_t i = 0; i < CAN_LOOPBACK_DEPTH; i++) {
+        canManager_processMessages();
+    }
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_OK);
+    canManager_processMessages();
+    EXPECT_EQ(deliveredCount, 3u);
+    EXPECT_EQ(lastDelivered.data[3], 2);
+    EXPECT_EQ(canManager_getStats()->e2eLostCount, 0u);
+
+    frame.dlc = 3;
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_ERROR);
+
+    config.profile = CAN_E2E_PROFILE_NONE;
+    EXPECT_TRUE(canManager_setE2e(&config));
+    EXPECT_FALSE(canManager_setE2e(&config));
+    config.profile = CAN_E2E_PROFILE_CRC16;
+    config.dataLength = 6;
+    EXPECT_FALSE(canManager_setE2e(&config));
+}
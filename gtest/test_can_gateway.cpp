@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+extern "C" {
+    #include "can_manager.h"
+    #include "can_transport.h"
+    #include "can_gateway.h"
+    #include "time_base.h"
+}
+
+static uint32_t receivedCount;
+static canFrame_t lastReceived;
+
+static void receivingCallback(const canFrame_t* frame) {
+    receivedCount++;
+    lastReceived = *frame;
+}
+
+class CANGatewayTest : public ::testing::Test {
+protected:
+    canLoopback_t powertrainBus;
+    canLoopback_t bodyBus;
+    canChannel_t* powertrain;
+    canChannel_t* body;
+
+    void SetUp() override {
+        timeBase_useVirtual(0);
+        powertrain = canChannel_get(1);
+        body = canChannel_get(2);
+        openChannels(false);
+        canGateway_init();
+        receivedCount = 0;
+    }
+
+    void TearDown() override {
+        canGateway_init();
+        canChannel_init(powertrain, nullptr);
+        canChannel_init(body, nullptr);
+        timeBase_useMonotonic();
+    }
+
+    void openChannels(bool powertrainFd) {
+        canConfig_t config = {};
+        config.baudrate = 500000;
+        config.transport = &canTransport_loopback;
+        config.transportContext = &powertrainBus;
+        config.fdEnabled = powertrainFd;
+        ASSERT_TRUE(canChannel_init(powertrain, &config));
+        config.transportContext = &bodyBus;
+        config.fdEnabled = false;
+        ASSERT_TRUE(canChannel_init(body, &config));
+        canChannel_setRxCallback(body, receivingCallback);
+    }
+
+    void inject(uint32_t id, uint8_t value, bool fd = false) {
+        canFrame_t frame = {};
+        frame.id = id;
+        frame.dlc = fd ? 9 : 1;
+        frame.fd = fd;
+        frame.data[0] = value;
+        ASSERT_EQ(canChannel_enqueueRxFrame(powertrain, &frame), CAN_STATUS_OK);
+    }
+
+    void pump() {
+        canChannel_processMessages(powertrain);
+        canChannel_processMessages(body);
+    }
+};
+
+TEST_F(CANGatewayTest, ForwardTest) {
+    canGatewayRoute_t route = {};
+    route.source = 1;
+    route.destination = 2;
+    route.match = {0x100, 0x700, false};
+    route.rewrite = true;
+    route.rewriteId = 0x500;
+    ASSERT_TRUE(canGateway_setRoute(0, &route));
+
+    inject(0x123, 0x42);
+    inject(0x321, 0x43);
+    timeBase_advanceUs(250);
+    pump();
+
+    EXPECT_EQ(receivedCount, 1u);
+    EXPECT_EQ(lastReceived.id, 0x500u);
+    EXPECT_EQ(lastReceived.data[0], 0x42);
+    EXPECT_EQ(canGateway_getRouteStats(0)->forwardedCount, 1u);
+    EXPECT_EQ(canGateway_getRouteStats(0)->latencyMaxUs, 250u);
+    EXPECT_EQ(canChannel_getStats(body)->txCount, 1u);
+
+    /* Removing the route detaches the gateway */
+    ASSERT_TRUE(canGateway_setRoute(0, nullptr));
+    inject(0x123, 0x44);
+    pump();
+    EXPECT_EQ(receivedCount, 1u);
+}
+
+TEST_F(CANGatewayTest, RateLimitTest) {
+    canGatewayRoute_t route = {};
+    route.source = 1;
+    route.destination = 2;
+    route.match = {0x200, 0x7FF, false};
+    route.minIntervalUs = 10000;
+    ASSERT_TRUE(canGateway_setRoute(3, &route));
+
+    inject(0x200, 1);
+    inject(0x200, 2);
+    inject(0x200, 3);
+    pump();
+    EXPECT_EQ(receivedCount, 1u);
+    EXPECT_EQ(lastReceived.data[0], 1);
+    EXPECT_EQ(canGateway_getRouteStats(3)->rateLimitedCount, 2u);
+
+    timeBase_advanceUs(10000);
+    inject(0x200, 4);
+    pump();
+    EXPECT_EQ(receivedCount, 2u);
+    EXPECT_EQ(lastReceived.data[0], 4);
+    EXPECT_EQ(canGateway_getRouteStats(3)->forwardedCount, 2u);
+}
+
+TEST_F(CANGatewayTest, RouteValidationTest) {
+    canGatewayRoute_t route = {};
+    route.source = 1;
+    route.destination = 1;
+    route.match = {0x100, 0x7FF, false};
+
+    EXPECT_FALSE(canGateway_setRoute(0, &route));
+    route.destination = CAN_CHANNELS_MAX;
+    EXPECT_FALSE(canGateway_setRoute(0, &route));
+    route.destination = 2;
+    EXPECT_FALSE(canGateway_setRoute(CAN_GATEWAY_ROUTES, &route));
+    route.rewrite = true;
+    route.rewriteId = 0x800;
+    EXPECT_FALSE(canGateway_setRoute(0, &route));
+    route.rewriteExtended = true;
+    EXPECT_TRUE(canGateway_setRoute(0, &route));
+    EXPECT_EQ(canGateway_getRouteStats(CAN_GATEWAY_ROUTES), nullptr);
+
+    /* FD frames cannot be forwarded onto a classic bus */
+    openChannels(true);
+    route.rewrite = false;
+    ASSERT_TRUE(canGateway_setRoute(0, &route));
+    inject(0x100, 1, true);
+    pump();
+    EXPECT_EQ(receivedCount, 0u);
+    EXPECT_EQ(canGateway_getRouteStats(0)->droppedCount, 1u);
+}
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include <vector>
+extern "C" {
+    #include "can_manager.h"
+    #include "can_transport.h"
+    #include "can_isotp.h"
+    #include "time_base.h"
+}
+
+static std::vector<uint8_t> lastMessage;
+static uint32_t messageCount;
+
+static void messageCallback(uint8_t channel, const uint8_t* data, uint32_t length) {
+    (void)channel;
+    messageCount++;
+    lastMessage.assign(data, data + length);
+}
+
+class CANIsotpTest : public ::testing::Test {
+protected:
+    canLoopback_t loopback;
+
+    void SetUp() override {
+        canConfig_t config = {};
+        config.transport = &canTransport_loopback;
+        config.transportContext = &loopback;
+        config.rxQueueDepth = CAN_RX_QUEUE_DEPTH_MAX;
+
+        timeBase_useVirtual(0);
+        ASSERT_TRUE(canManager_init(&config));
+        canManager_setRxCallback(nullptr);
+        messageCount = 0;
+        lastMessage.clear();
+    }
+
+    void TearDown() override {
+        for (uint8_t i = 0; i < CAN_ISOTP_CHANNELS; i++) {
+            canIsotp_close(i);
+        }
+        timeBase_useMonotonic();
+    }
+
+    /* Channel 0 sends on 0x7E0 to channel 1, which answers on 0x7E8 */
+    void openLink(uint8_t blockSize, uint8_t stMin) {
+        canIsotpConfig_t sender = {};
+        sender.txId = 0x7E0;
+        sender.rxId = 0x7E8;
+        canIsotpConfig_t receiver = {};
+        receiver.txId = 0x7E8;
+        receiver.rxId = 0x7E0;
+        receiver.blockSize = blockSize;
+        receiver.stMin = stMin;
+        receiver.padding = true;
+        receiver.rxCallback = messageCallback;
+        ASSERT_TRUE(canIsotp_open(0, &sender));
+        ASSERT_TRUE(canIsotp_open(1, &receiver));
+    }
+
+    void pump(int rounds) {
+        for (int i = 0; i < rounds; i++) {
+            canManager_processMessages();
+            canIsotp_poll();
+        }
+    }
+};
+
+TEST_F(CANIsotpTest, SingleFrameTest) {
+    openLink(0, 0);
+    const uint8_t data[] = {1, 2, 3, 4, 5};
+
+    EXPECT_EQ(canIsotp_send(0, data, sizeof(data)), CAN_STATUS_OK);
+    EXPECT_FALSE(canIsotp_txBusy(0));
+    pump(1);
+
+    EXPECT_EQ(messageCount, 1u);
+    EXPECT_EQ(lastMessage, std::vector<uint8_t>(data, data + sizeof(data)));
+    EXPECT_EQ(canIsotp_getStats(0)->txFrames, 1u);
+    EXPECT_EQ(canIsotp_getStats(1)->rxMessages, 1u);
+}
+
+TEST_F(CANIsotpTest, MultiFrameTest) {
+    openLink(4, 0);
+    std::vector<uint8_t> data(CAN_ISOTP_MAX_PAYLOAD);
+    for (size_t i = 0; i < data.size(); i++) {
+        data[i] = (uint8_t)(i * 13);
+    }
+
+    EXPECT_EQ(canIsotp_send(0, data.data(), (uint32_t)data.size()), CAN_STATUS_OK);
+    EXPECT_TRUE(canIsotp_txBusy(0));
+    EXPECT_EQ(canIsotp_send(0, data.data(), 10), CAN_STATUS_ERROR);
+    pump(2000);
+
+    EXPECT_FALSE(canIsotp_txBusy(0));
+    EXPECT_FALSE(canIsotp_rxBusy(1));
+    EXPECT_EQ(messageCount, 1u);
+    EXPECT_EQ(lastMessage, data);
+    /* 1 FF + 585 CFs, with a flow control after the FF and every 4 CFs */
+    EXPECT_EQ(canIsotp_getStats(0)->txFrames, 586u);
+    EXPECT_EQ(canIsotp_getStats(1)->txFrames, 1u + (585u - 1u) / 4u);
+    EXPECT_EQ(canIsotp_getStats(0)->txMessages, 1u);
+}
+
+TEST_F(CANIsotpTest, SeparationTimeTest) {
+    openLink(0, 5);
+    std::vector<uint8_t> data(20, 0xA5);
+
+    EXPECT_EQ(canIsotp_send(0, data.data(), (uint32_t)data.size()), CAN_STATUS_OK);
+    pump(5);
+    /* First CF goes out with the flow control, the rest wait for STmin */
+    EXPECT_EQ(canIsotp_getStats(0)->txFrames, 2u);
+    EXPECT_EQ(messageCount, 0u);
+
+    timeBase_advanceUs(5000);
+    pump(5);
+    EXPECT_EQ(canIsotp_getStats(0)->txFrames, 3u);
+    EXPECT_EQ(messageCount, 1u);
+    EXPECT_EQ(lastMessage, data);
+}
+
+TEST_F(CANIsotpTest, FlowControlTimeoutTest) {
+    canIsotpConfig_t sender = {};
+    sender.txId = 0x7E0;
+    sender.rxId = 0x7E8;
+    ASSERT_TRUE(canIsotp_open(0, &sender));
+    std::vector<uint8_t> data(100, 0x11);
+
+    EXPECT_EQ(canIsotp_send(0, data.data(), (uint32_t)data.size()), CAN_STATUS_OK);
+    pump(2);
+    EXPECT_TRUE(canIsotp_txBusy(0));
+
+    timeBase_advanceUs((CAN_ISOTP_TIMEOUT_BS_MS + 1) * 1000ULL);
+    pump(1);
+    EXPECT_FALSE(canIsotp_txBusy(0));
+    EXPECT_EQ(canIsotp_getStats(0)->timeoutCount, 1u);
+}
+
+TEST_F(CANIsotpTest, ReceiveErrorsTest) {
+    canIsotpConfig_t receiver = {};
+    receiver.txId = 0x7E8;
+    receiver.rxId = 0x7E0;
+    receiver.rxCallback = messageCallback;
+    ASSERT_TRUE(canIsotp_open(1, &receiver));
+
+    canFrame_t frame = {};
+    frame.id = 0x7E0;
+    frame.dlc = 8;
+
+    /* Escaped first frame announcing more than the reassembly buffer holds */
+    frame.data[0] = 0x10;
+    frame.data[1] = 0x00;
+    frame.data[4] = 0x10;
+    canManager_dispatchFrame(&frame);
+    EXPECT_EQ(canIsotp_getStats(1)->overflowCount, 1u);
+    EXPECT_FALSE(canIsotp_rxBusy(1));
+
+    /* Escaped first frame with a length that fits the 12-bit form is ignored */
+    frame.data[4] = 0x00;
+    frame.data[5] = 100;
+    canManager_dispatchFrame(&frame);
+    EXPECT_FALSE(canIsotp_rxBusy(1));
+    EXPECT_EQ(canIsotp_getStats(1)->overflowCount, 1u);
+    frame.data[0] = 0x21;
+    canManager_dispatchFrame(&frame);
+    EXPECT_EQ(messageCount, 0u);
+    frame.data[5] = 0x00;
+
+    /* Consecutive frame out of sequence */
+    frame.data[0] = 0x10;
+    frame.data[1] = 20;
+    frame.data[4] = 0x00;
+    canManager_dispatchFrame(&frame);
+    EXPECT_TRUE(canIsotp_rxBusy(1));
+    frame.data[0] = 0x22;
+    canManager_dispatchFrame(&frame);
+    EXPECT_EQ(canIsotp_getStats(1)->sequenceErrors, 1u);
+    EXPECT_FALSE(canIsotp_rxBusy(1));
+
+    /* Consecutive frame timeout */
+    frame.data[0] = 0x10;
+    canManager_dispatchFrame(&frame);
+    timeBase_advanceUs((CAN_ISOTP_TIMEOUT_CR_MS + 1) * 1000ULL);
+    canIsotp_poll();
+    EXPECT_EQ(canIsotp_getStats(1)->timeoutCount, 1u);
+    EXPECT_EQ(messageCount, 0u);
+}
+
+TEST_F(CANIsotpTest, OpenValidationTest) {
+    canIsotpConfig_t config = {};
+    config.txId = 0x7E0;
+    config.rxId = 0x7E8;
+
+    EXPECT_FALSE(canIsotp_open(CAN_ISOTP_CHANNELS, &config));
+    EXPECT_FALSE(canIsotp_open(0, nullptr));
+    EXPECT_TRUE(canIsotp_open(0, &config));
+    EXPECT_FALSE(canIsotp_open(1, &config));
+    EXPECT_TRUE(canIsotp_open(0, &config));
+
+    const uint8_t data[] = {1};
+    EXPECT_EQ(canIsotp_send(1, data, 1), CAN_STATUS_ERROR);
+    EXPECT_EQ(canIsotp_send(0, data, 0), CAN_STATUS_ERROR);
+    EXPECT_EQ(canIsotp_send(0, data, CAN_ISOTP_MAX_PAYLOAD + 1), CAN_STATUS_ERROR);
+
+    EXPECT_EQ(canIsotp_stMinToUs(0x7F), 127000u);
+    EXPECT_EQ(canIsotp_stMinToUs(0xF3), 300u);
+    EXPECT_EQ(canIsotp_stMinToUs(0x80), 127000u);
+}
@@ -1,20 +1,66 @@
 #include <gtest/gtest.h>
+#include <thread>
 extern "C" {
     #include "can_manager.h"
+    #include "can_transport.h"
+    #include "can_db.h"
+    #include "can_timing.h"
+    #include "time_base.h"
+}
+
+static uint32_t tapTxCount;
+static uint32_t tapRxCount;
+static uint32_t callbackCount;
+static canFrame_t lastCallbackFrame;
+
+static void countingTap(const canFrame_t* frame, bool tx) {
+    (void)frame;
+    if (tx) {
+        tapTxCount++;
+    } else {
+        tapRxCount++;
+    }
+}
+
+static uint32_t handlerCount;
+static uint32_t lastHandlerId;
+
+static void countingHandler(const canFrame_t* frame) {
+    handlerCount++;
+    lastHandlerId = frame->id;
+}
+
+static void capturingCallback(const canFrame_t* frame) {
+    callbackCount++;
+    lastCallbackFrame = *frame;
+}
+
+static canFrame_t callbackFrames[16];
+
+static void recordingCallback(const canFrame_t* frame) {
+    if (callbackCount < 16) {
+        callbackFrames[callbackCount] = *frame;
+    }
+    capturingCallback(frame);
 }
 
 class CANManagerTest : public ::testing::Test {
 protected:
     void SetUp() override {
-        canConfig_t config;
+        canConfig_t config = {};
         config.baudrate = 250000;
         
+        timeBase_useVirtual(0);
         ASSERT_TRUE(canManager_init(&config));
     }
+
+    void TearDown() override {
+        timeBase_useMonotonic();
+    }
 };
 
 TEST_F(CANManagerTest, InitializationTest) {
-    canConfig_t config;
+    canConfig_t config = {};
     config.baudrate = 500000;
 
     EXPECT_TRUE(canManager_init(&config));
@@ -22,7 +68,7 @@ TEST_F(CANManagerTest, InitializationTest) {
 }
 
 TEST_F(CANManagerTest, SendFrameTest) {
-    canFrame_t frame;
+    canFrame_t frame = {};
     frame.id = 0x123;
     frame.dlc = 8;
     frame.extended = false;
@@ -40,7 +86,8 @@ TEST_F(CANManagerTest, SendFrameTest) {
 }
 
 TEST_F(CANManagerTest, ReceiveFrameTest) {
-    canFrame_t txFrame, rxFrame;
+    canFrame_t txFrame = {};
+    canFrame_t rxFrame = {};
     
     txFrame.id = 0x456;
     txFrame.dlc = 4;
@@ -112,7 +159,7 @@ TEST_F(CANManagerTest, StatisticsTest) {
     
     uint32_t initialTxCount = stats->txCount;
     
-    canFrame_t frame;
+    canFrame_t frame = {};
     frame.id = 0x789;
     frame.dlc = 2;
     frame.extended = false;
@@ -123,4 +170,1087 @@ TEST_F(CANManagerTest, StatisticsTest) {
     canManager_sendFrame(&frame);
     
     EXPECT_EQ(stats->txCount, initialTxCount + 1);
-}
\ No newline at end of file
+}
+
+TEST_F(CANManagerTest, RxQueueDepthConfigTest) {
+    canConfig_t config = {};
+    config.baudrate = 250000;
+
+    config.rxQueueDepth = 64;
+    EXPECT_TRUE(canManager_init(&config));
+
+    config.rxQueueDepth = 48;
+    EXPECT_FALSE(canManager_init(&config));
+
+    config.rxQueueDepth = CAN_RX_QUEUE_DEPTH_MAX * 2;
+    EXPECT_FALSE(canManager_init(&config));
+}
+
+TEST_F(CANManagerTest, EnqueueRxFrameTest) {
+    canFrame_t txFrame = {};
+    canFrame_t rxFrame = {};
+
+    txFrame.id = 0x321;
+    txFrame.dlc = 2;
+    txFrame.data[0] = 0x11;
+    txFrame.data[1] = 0x22;
+
+    EXPECT_EQ(canManager_enqueueRxFrame(&txFrame), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_enqueueRxFrame(nullptr), CAN_STATUS_ERROR);
+
+    EXPECT_EQ(canManager_receiveFrame(&rxFrame), CAN_STATUS_OK);
+    EXPECT_EQ(rxFrame.id, 0x321u);
+    EXPECT_EQ(rxFrame.data[1], 0x22);
+    EXPECT_EQ(canManager_receiveFrame(&rxFrame), CAN_STATUS_TIMEOUT);
+    EXPECT_EQ(canManager_getStats()->rxCount, 1u);
+}
+
+TEST_F(CANManagerTest, PeekConsumeTest) {
+    canConfig_t config = {};
+    config.rxQueueDepth = 4;
+    ASSERT_TRUE(canManager_init(&config));
+
+    canFrame_t frame = {};
+    frame.dlc = 1;
+    EXPECT_EQ(canManager_peekFrame(), nullptr);
+
+    for (uint32_t id = 0x10; id < 0x13; id++) {
+        frame.id = id;
+        ASSERT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    }
+
+    const canFrame_t* first = canManager_peekFrame();
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->id, 0x10u);
+    EXPECT_EQ(canManager_peekFrame(), first);
+    canManager_consumeFrames(1);
+    EXPECT_EQ(canManager_peekFrame()->id, 0x11u);
+    EXPECT_EQ(canManager_getStats()->rxCount, 1u);
+
+    /* Two more frames wrap the four-slot ring: the span stops at the end */
+    for (uint32_t id = 0x13; id < 0x15; id++) {
+        frame.id = id;
+        ASSERT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    }
+    const canFrame_t* frames = nullptr;
+    ASSERT_EQ(canManager_peekFrames(&frames, 16), 3u);
+    EXPECT_EQ(frames[0].id, 0x11u);
+    EXPECT_EQ(frames[2].id, 0x13u);
+    EXPECT_EQ(canManager_peekFrames(&frames, 2), 2u);
+    canManager_consumeFrames(3);
+
+    ASSERT_EQ(canManager_peekFrames(&frames, 16), 1u);
+    EXPECT_EQ(frames[0].id, 0x14u);
+    canManager_consumeFrames(10);
+    EXPECT_EQ(canManager_peekFrame(), nullptr);
+    EXPECT_EQ(canManager_getStats()->rxCount, 5u);
+}
+
+TEST_F(CANManagerTest, CommandCoalescingTest) {
+    canManager_setRxCallback(recordingCallback);
+    ASSERT_TRUE(canManager_registerHandler(0x320, false, countingHandler));
+    ASSERT_TRUE(canManager_setCoalescing(0x320, true));
+    EXPECT_FALSE(canManager_setCoalescing(CAN_STD_ID_COUNT, true));
+    handlerCount = 0;
+    callbackCount = 0;
+
+    canFrame_t frame = {};
+    frame.id = 0x320;
+    frame.dlc = 1;
+    canFrame_t before = {};
+    before.id = 0x321;
+    canFrame_t after = {};
+    after.id = 0x322;
+    ASSERT_EQ(canManager_enqueueRxFrame(&before), CAN_STATUS_OK);
+    for (uint8_t i = 1; i <= 5; i++) {
+        frame.data[0] = i;
+        ASSERT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    }
+    ASSERT_EQ(canManager_enqueueRxFrame(&after), CAN_STATUS_OK);
+    canManager_processMessages();
+
+    /* Only the newest command is applied, where the last one was received */
+    EXPECT_EQ(handlerCount, 1u);
+    ASSERT_EQ(callbackCount, 3u);
+    EXPECT_EQ(callbackFrames[0].id, 0x321u);
+    EXPECT_EQ(callbackFrames[1].id, 0x320u);
+    EXPECT_EQ(callbackFrames[1].data[0], 5);
+    EXPECT_EQ(callbackFrames[2].id, 0x322u);
+    EXPECT_EQ(canManager_getStats()->rxCount, 7u);
+    EXPECT_EQ(canManager_getStats()->rxSupersededCount, 4u);
+    EXPECT_EQ(canManager_getIdStats(0x320, false)->rxCount, 5u);
+    EXPECT_EQ(canManager_getIdStats(0x320, false)->supersededCount, 4u);
+
+    /* The next drain starts fresh; disabling dispatches every frame */
+    ASSERT_TRUE(canManager_setCoalescing(0x320, false));
+    EXPECT_FALSE(canManager_setCoalescing(0x320, false));
+    ASSERT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    ASSERT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    canManager_processMessages();
+    EXPECT_EQ(handlerCount, 3u);
+    EXPECT_EQ(canManager_getStats()->rxSupersededCount, 4u);
+}
+
+static bool requeueOnce;
+
+static void requeueingCallback(const canFrame_t* frame) {
+    capturingCallback(frame);
+    if (requeueOnce) {
+        requeueOnce = false;
+        (void)canManager_enqueueRxFrame(frame);
+    }
+}
+
+TEST_F(CANManagerTest, BoundedProcessingTest) {
+    canManager_setRxCallback(requeueingCallback);
+    ASSERT_TRUE(canManager_setCoalescing(0x320, true));
+    callbackCount = 0;
+
+    /* A frame arriving during processing waits for the next call */
+    canFrame_t frame = {};
+    frame.id = 0x321;
+    requeueOnce = true;
+    ASSERT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    canManager_processMessages();
+    EXPECT_EQ(callbackCount, 1u);
+    EXPECT_EQ(canManager_getStats()->rxCount, 1u);
+    canManager_processMessages();
+    EXPECT_EQ(callbackCount, 2u);
+
+    /* So does a newer command; the one in the pass is applied meanwhile */
+    frame.id = 0x320;
+    frame.data[0] = 1;
+    requeueOnce = true;
+    ASSERT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    canManager_processMessages();
+    EXPECT_EQ(callbackCount, 3u);
+    EXPECT_EQ(canManager_getStats()->rxSupersededCount, 0u);
+    canManager_processMessages();
+    EXPECT_EQ(callbackCount, 4u);
+}
+
+TEST_F(CANManagerTest, RxOverrunTest) {
+    canFrame_t frame = {};
+    frame.id = 0x300;
+    frame.dlc = 1;
+
+    for (uint32_t i = 0; i < CAN_RX_QUEUE_DEPTH_DEFAULT; i++) {
+        EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    }
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OVERRUN);
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OVERRUN);
+
+    const canStats_t* stats = canManager_getStats();
+    EXPECT_EQ(stats->rxOverrunCount, 2u);
+    EXPECT_EQ(stats->rxQueueHighWater, CAN_RX_QUEUE_DEPTH_DEFAULT);
+}
+
+TEST_F(CANManagerTest, ConcurrentProducerTest) {
+    const uint32_t frameCount = 100000;
+    uint32_t received = 0;
+    uint32_t expected = 0;
+    bool inOrder = true;
+
+    std::thread producer([frameCount]() {
+        canFrame_t frame = {};
+        frame.id = 0x310;
+        frame.dlc = 4;
+        for (uint32_t i = 0; i < frameCount; i++) {
+            frame.data[0] = (uint8_t)(i & 0xFF);
+            frame.data[1] = (uint8_t)((i >> 8) & 0xFF);
+            frame.data[2] = (uint8_t)((i >> 16) & 0xFF);
+            while (canManager_enqueueRxFrame(&frame) != CAN_STATUS_OK) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    while (received < frameCount) {
+        canFrame_t frame;
+        if (canManager_receiveFrame(&frame) == CAN_STATUS_OK) {
+            uint32_t value = frame.data[0] | ((uint32_t)frame.data[1] << 8) | ((uint32_t)frame.data[2] << 16);
+            inOrder = inOrder && (value == expected);
+            expected++;
+            received++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_EQ(canManager_getStats()->rxCount, frameCount);
+}
+
+TEST_F(CANManagerTest, LoopbackTransportTest) {
+    canLoopback_t loopback;
+    canConfig_t config = {};
+    config.baudrate = 500000;
+    config.transport = &canTransport_loopback;
+    config.transportContext = &loopback;
+    config.tap = countingTap;
+
+    ASSERT_TRUE(canManager_init(&config));
+    canManager_setRxCallback(capturingCallback);
+    tapTxCount = 0;
+    tapRxCount = 0;
+    callbackCount = 0;
+
+    canFrame_t frame = {};
+    frame.id = 0x456;
+    frame.dlc = 3;
+    frame.data[0] = 0xDE;
+    frame.data[1] = 0xAD;
+    frame.data[2] = 0xBE;
+
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_OK);
+    canManager_processMessages();
+
+    EXPECT_EQ(tapTxCount, 1u);
+    EXPECT_EQ(tapRxCount, 1u);
+    EXPECT_EQ(callbackCount, 1u);
+    EXPECT_EQ(lastCallbackFrame.id, 0x456u);
+    EXPECT_EQ(lastCallbackFrame.data[2], 0xBE);
+    EXPECT_EQ(canManager_getStats()->txCount, 1u);
+    EXPECT_EQ(canManager_getStats()->rxCount, 1u);
+}
+
+TEST_F(CANManagerTest, TapOnlySentFramesTest) {
+    canLoopback_t loopback;
+    canConfig_t config = {};
+    config.baudrate = 500000;
+    config.transport = &canTransport_loopback;
+    config.transportContext = &loopback;
+    config.tap = countingTap;
+
+    ASSERT_TRUE(canManager_init(&config));
+    tapTxCount = 0;
+
+    canFrame_t frame = {};
+    frame.id = 0x456;
+    frame.dlc = 1;
+    for (uint32_t i = 0; i < CAN_LOOPBACK_DEPTH; i++) {
+        ASSERT_EQ(canManager_sendFrame(&frame), CAN_STATUS_OK);
+    }
+    EXPECT_EQ(tapTxCount, CAN_LOOPBACK_DEPTH);
+
+    /* Refused sends never reach the tap, on either path */
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_OVERRUN);
+    frame.id = 0x457;
+    ASSERT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OVERRUN);
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OVERRUN);
+    EXPECT_EQ(tapTxCount, CAN_LOOPBACK_DEPTH);
+
+    /* Once the backend takes the queued frame it is tapped exactly once */
+    canManager_processMessages();
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+    EXPECT_EQ(tapTxCount, CAN_LOOPBACK_DEPTH + 1);
+}
+
+TEST_F(CANManagerTest, NullTransportTest) {
+    canConfig_t config = {};
+    config.transport = &canTransport_null;
+    config.tap = countingTap;
+
+    ASSERT_TRUE(canManager_init(&config));
+    canManager_setRxCallback(capturingCallback);
+    tapTxCount = 0;
+    callbackCount = 0;
+
+    EXPECT_EQ(canManager_sendTempStatus(42.0f, 0), CAN_STATUS_OK);
+    EXPECT_EQ(tapTxCount, 0u);
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+    canManager_processMessages();
+
+    EXPECT_EQ(tapTxCount, 1u);
+    EXPECT_EQ(callbackCount, 0u);
+}
+
+TEST_F(CANManagerTest, TxPriorityFlushTest) {
+    canLoopback_t loopback;
+    canConfig_t config = {};
+    config.transport = &canTransport_loopback;
+    config.transportContext = &loopback;
+
+    ASSERT_TRUE(canManager_init(&config));
+    /* Equal IDs keep submission order only without a latest-value mailbox */
+    ASSERT_TRUE(canManager_setTxMailbox(0x103, false));
+
+    const uint32_t ids[] = {0x300, 0x103, 0x100, 0x7FF, 0x103};
+    for (uint32_t id : ids) {
+        canFrame_t frame = {};
+        frame.id = id;
+        frame.dlc = 1;
+        frame.data[0] = (uint8_t)(id & 0xFF);
+        EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    }
+    canFrame_t extFrame = {};
+    extFrame.id = (0x100u << 18) | 0x1234u;
+    extFrame.extended = true;
+    extFrame.dlc = 0;
+    EXPECT_EQ(canManager_queueFrame(&extFrame), CAN_STATUS_OK);
+
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 6u);
+    EXPECT_EQ(canManager_getStats()->txCount, 0u);
+
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+
+    const canStats_t* stats = canManager_getStats();
+    EXPECT_EQ(stats->txCount, 6u);
+    EXPECT_EQ(stats->txFlushCount, 1u);
+    EXPECT_EQ(stats->txQueueDepth, 0u);
+    EXPECT_EQ(stats->txQueueHighWater, 6u);
+
+    const uint32_t expected[] = {0x100, (0x100u << 18) | 0x1234u, 0x103, 0x103, 0x300, 0x7FF};
+    ASSERT_EQ(loopback.head - loopback.tail, 6u);
+    for (uint32_t i = 0; i < 6; i++) {
+        EXPECT_EQ(loopback.frames[i].id, expected[i]);
+    }
+}
+
+TEST_F(CANManagerTest, ReserveCommitTest) {
+    canLoopback_t loopback;
+    canConfig_t config = {};
+    config.transport = &canTransport_loopback;
+    config.transportContext = &loopback;
+    ASSERT_TRUE(canManager_init(&config));
+
+    /* A reservation is private until committed; the next one reuses it */
+    canFrame_t* slot = canManager_reserveTx();
+    ASSERT_NE(slot, nullptr);
+    slot->id = 0x300;
+    slot->dlc = 2;
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 0u);
+    EXPECT_EQ(canManager_reserveTx(), slot);
+    EXPECT_EQ(slot->id, 0u);
+
+    slot->id = 0x300;
+    slot->dlc = 2;
+    slot->data[0] = 0x12;
+    slot->data[1] = 0x34;
+    EXPECT_EQ(canManager_commitTx(slot), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 1u);
+    EXPECT_EQ(canManager_commitTx(slot), CAN_STATUS_ERROR);
+
+    /* Invalid frames are rejected and leave the queue as it was */
+    slot = canManager_reserveTx();
+    slot->id = 0x301;
+    slot->dlc = 9;
+    EXPECT_EQ(canManager_commitTx(slot), CAN_STATUS_ERROR);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 1u);
+
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+    ASSERT_EQ(loopback.head - loopback.tail, 1u);
+    EXPECT_EQ(loopback.frames[0].id, 0x300u);
+    EXPECT_EQ(loopback.frames[0].data[1], 0x34);
+
+    /* With the queue full a mailbox frame still replaces its queued value */
+    EXPECT_EQ(canManager_sendTempStatus(20.0f, 0), CAN_STATUS_OK);
+    for (uint32_t i = 1; i < CAN_TX_QUEUE_DEPTH; i++) {
+        slot = canManager_reserveTx();
+        slot->id = 0x400 + i;
+        EXPECT_EQ(canManager_commitTx(slot), CAN_STATUS_OK);
+    }
+    slot = canManager_reserveTx();
+    ASSERT_NE(slot, nullptr);
+    slot->id = 0x500;
+    EXPECT_EQ(canManager_commitTx(slot), CAN_STATUS_OVERRUN);
+    EXPECT_EQ(canManager_sendTempStatus(25.0f, 1), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, CAN_TX_QUEUE_DEPTH);
+    EXPECT_EQ(canManager_getStats()->txReplacedCount, 1u);
+}
+
+TEST_F(CANManagerTest, TxQueueOverrunTest) {
+    canFrame_t frame = {};
+    frame.id = 0x123;
+    frame.dlc = 0;
+
+    for (uint32_t i = 0; i < CAN_TX_QUEUE_DEPTH; i++) {
+        EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    }
+    EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OVERRUN);
+    EXPECT_EQ(canManager_getStats()->txOverrunCount, 1u);
+
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_getStats()->txCount, CAN_TX_QUEUE_DEPTH);
+}
+
+TEST_F(CANManagerTest, StdHandlerRegistrationTest) {
+    canManager_setRxCallback(nullptr);
+    handlerCount = 0;
+
+    EXPECT_TRUE(canManager_registerHandler(0x7FF, false, countingHandler));
+    EXPECT_FALSE(canManager_registerHandler(0x800, false, countingHandler));
+    EXPECT_FALSE(canManager_registerHandler(0x123, false, nullptr));
+
+    canFrame_t frame = {};
+    frame.id = 0x7FF;
+    frame.dlc = 0;
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    frame.id = 0x7FE;
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    canManager_processMessages();
+
+    EXPECT_EQ(handlerCount, 1u);
+    EXPECT_EQ(lastHandlerId, 0x7FFu);
+
+    EXPECT_TRUE(canManager_unregisterHandler(0x7FF, false));
+    EXPECT_FALSE(canManager_unregisterHandler(0x7FF, false));
+    frame.id = 0x7FF;
+    canManager_dispatchFrame(&frame);
+    EXPECT_EQ(handlerCount, 1u);
+}
+
+TEST_F(CANManagerTest, ExtHandlerRegistrationTest) {
+    canManager_setRxCallback(nullptr);
+    handlerCount = 0;
+
+    canFrame_t frame = {};
+    frame.extended = true;
+
+    for (uint32_t i = 0; i < CAN_EXT_HANDLER_SLOTS; i++) {
+        EXPECT_TRUE(canManager_registerHandler(0x18FF0000u + i * 0x100u, true, countingHandler));
+    }
+    EXPECT_FALSE(canManager_registerHandler(0x18FE0000u, true, countingHandler));
+    EXPECT_FALSE(canManager_registerHandler(0x20000000u, true, countingHandler));
+
+    for (uint32_t i = 0; i < CAN_EXT_HANDLER_SLOTS; i++) {
+        frame.id = 0x18FF0000u + i * 0x100u;
+        canManager_dispatchFrame(&frame);
+    }
+    EXPECT_EQ(handlerCount, CAN_EXT_HANDLER_SLOTS);
+
+    frame.id = 0x18FF0001u;
+    canManager_dispatchFrame(&frame);
+    EXPECT_EQ(handlerCount, CAN_EXT_HANDLER_SLOTS);
+
+    EXPECT_TRUE(canManager_unregisterHandler(0x18FF0500u, true));
+    EXPECT_TRUE(canManager_registerHandler(0x18FE0000u, true, countingHandler));
+    frame.id = 0x18FE0000u;
+    canManager_dispatchFrame(&frame);
+    EXPECT_EQ(handlerCount, CAN_EXT_HANDLER_SLOTS + 1);
+    EXPECT_EQ(lastHandlerId, 0x18FE0000u);
+
+    frame.id = 0x7FF;
+    frame.extended = false;
+    canManager_dispatchFrame(&frame);
+    EXPECT_EQ(handlerCount, CAN_EXT_HANDLER_SLOTS + 1);
+}
+
+TEST_F(CANManagerTest, AcceptanceFilterTest) {
+    canManager_setRxCallback(capturingCallback);
+    callbackCount = 0;
+
+    canFilter_t commands = {0x200, 0x7F0, false};
+    canFilter_t exact = {0x321, 0x7FF, false};
+    canFilter_t j1939 = {0x18FF0000u, 0x1FFF0000u, true};
+    EXPECT_TRUE(canManager_setFilter(0, &commands));
+    EXPECT_TRUE(canManager_setFilter(1, &exact));
+    EXPECT_TRUE(canManager_setFilter(2, &j1939));
+    EXPECT_FALSE(canManager_setFilter(CAN_FILTER_BANK_SIZE, &exact));
+
+    canFrame_t frame = {};
+    frame.dlc = 0;
+    const uint32_t stdIds[] = {0x20F, 0x210, 0x321, 0x322, 0x100};
+    for (uint32_t id : stdIds) {
+        frame.id = id;
+        EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    }
+    frame.extended = true;
+    frame.id = 0x18FF1234u;
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    frame.id = 0x18FE1234u;
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    frame.id = 0x20F;
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+
+    canManager_processMessages();
+
+    EXPECT_EQ(callbackCount, 3u);
+    EXPECT_EQ(canManager_getFilterHits(0), 1u);
+    EXPECT_EQ(canManager_getFilterHits(1), 1u);
+    EXPECT_EQ(canManager_getFilterHits(2), 1u);
+    EXPECT_EQ(canManager_getStats()->rxFilteredCount, 5u);
+
+    canManager_clearFilters();
+    frame.extended = false;
+    frame.id = 0x100;
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    canManager_processMessages();
+    EXPECT_EQ(callbackCount, 4u);
+}
+TEST_F(CANManagerTest, FdDlcMappingTest) {
+    EXPECT_EQ(canManager_dlcToLength(8), 8u);
+    EXPECT_EQ(canManager_dlcToLength(9), 12u);
+    EXPECT_EQ(canManager_dlcToLength(12), 24u);
+    EXPECT_EQ(canManager_dlcToLength(15), 64u);
+
+    EXPECT_EQ(canManager_lengthToDlc(0), 0u);
+    EXPECT_EQ(canManager_lengthToDlc(8), 8u);
+    EXPECT_EQ(canManager_lengthToDlc(9), 9u);
+    EXPECT_EQ(canManager_lengthToDlc(24), 12u);
+    EXPECT_EQ(canManager_lengthToDlc(33), 14u);
+    EXPECT_EQ(canManager_lengthToDlc(64), 15u);
+    EXPECT_EQ(canManager_lengthToDlc(200), 15u);
+
+    canFrame_t frame = {};
+    frame.dlc = 13;
+    EXPECT_EQ(canManager_frameLength(&frame), 8u);
+    frame.fd = true;
+    EXPECT_EQ(canManager_frameLength(&frame), 32u);
+}
+
+TEST_F(CANManagerTest, FdFrameValidationTest) {
+    canFrame_t frame = {};
+    frame.id = 0x123;
+    frame.dlc = 15;
+    frame.fd = true;
+    frame.brs = true;
+
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_ERROR);
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_ERROR);
+
+    canConfig_t config = {};
+    config.fdEnabled = true;
+    config.dataBaudrate = 2000000;
+    ASSERT_TRUE(canManager_init(&config));
+
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+
+    frame.dlc = 16;
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_ERROR);
+
+    frame.dlc = 8;
+    frame.remote = true;
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_ERROR);
+
+    frame.remote = false;
+    frame.fd = false;
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_ERROR);
+}
+
+TEST_F(CANManagerTest, ConsolidatedStatusTest) {
+    canLoopback_t loopback;
+    canConfig_t config = {};
+    config.transport = &canTransport_loopback;
+    config.transportContext = &loopback;
+    config.fdEnabled = true;
+    config.consolidatedStatus = true;
+    ASSERT_TRUE(canManager_init(&config));
+    canManager_setRxCallback(capturingCallback);
+    callbackCount = 0;
+
+    canStatusSnapshot_t snapshot = {};
+    snapshot.temperature = 72.5f;
+    snapshot.tempStatus = 1;
+    snapshot.pumpDutyCycle = 40.0f;
+    snapshot.pumpState = 2;
+    snapshot.pumpEnabled = true;
+    snapshot.fanDutyCycle = 65.0f;
+    snapshot.fanState = 3;
+    snapshot.fanEnabled = false;
+    snapshot.kp = 2.0f;
+    snapshot.ki = 0.5f;
+    snapshot.kd = 0.125f;
+    snapshot.setpoint = 85.0f;
+
+    EXPECT_EQ(canManager_sendConsolidatedStatus(&snapshot), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+    canManager_processMessages();
+
+    ASSERT_EQ(callbackCount, 1u);
+    EXPECT_EQ(lastCallbackFrame.id, (uint32_t)CAN_MSG_CONSOLIDATED_STATUS);
+    EXPECT_TRUE(lastCallbackFrame.fd);
+    EXPECT_TRUE(lastCallbackFrame.brs);
+    EXPECT_EQ(canManager_frameLength(&lastCallbackFrame), 24u);
+
+    canDbConsolidatedStatus_t msg;
+    ASSERT_TRUE(canDb_unpackConsolidatedStatus(&msg, lastCallbackFrame.data,
+                                               canManager_frameLength(&lastCallbackFrame)));
+    EXPECT_FLOAT_EQ(msg.temperature, 72.5f);
+    EXPECT_EQ(msg.pumpState, 2u);
+    EXPECT_EQ(msg.pumpEnabled, 1u);
+    EXPECT_EQ(msg.fanState, 3u);
+    EXPECT_EQ(msg.fanEnabled, 0u);
+    EXPECT_FLOAT_EQ(msg.fanDutyCycle, 65.0f);
+    EXPECT_NEAR(msg.kd, 0.125f, 0.001f);
+    EXPECT_NEAR(msg.setpoint, 85.0f, 0.1f);
+}
+
+static canStatus_t busOffSend(void* context, const canFrame_t* frame) {
+    (void)context;
+    (void)frame;
+    return CAN_STATUS_BUS_OFF;
+}
+
+static canStatus_t scriptedStatus;
+static uint32_t scriptedCalls;
+
+static canStatus_t scriptedSend(void* context, const canFrame_t* frame) {
+    (void)context;
+    (void)frame;
+    scriptedCalls++;
+    return scriptedStatus;
+}
+
+TEST_F(CANManagerTest, FrameBitsTest) {
+    canFrameBits_t worst = canTiming_worstCaseBits(8, false, false, false);
+    EXPECT_EQ(worst.nominalBits, 135u);
+    EXPECT_EQ(worst.dataBits, 0u);
+    EXPECT_EQ(canTiming_worstCaseBits(8, true, false, false).nominalBits, 160u);
+    EXPECT_EQ(canTiming_worstCaseBits(0, false, false, false).nominalBits, 55u);
+
+    canFrame_t frame = {};
+    frame.id = 0x555;
+    frame.dlc = 8;
+    for (int i = 0; i < 8; i++) {
+        frame.data[i] = 0x55;
+    }
+    canFrameBits_t bits = canTiming_frameBits(&frame);
+    EXPECT_GE(bits.nominalBits, 111u);
+    EXPECT_LE(bits.nominalBits, worst.nominalBits);
+
+    frame.id = 0x000;
+    for (int i = 0; i < 8; i++) {
+        frame.data[i] = 0x00;
+    }
+    canFrameBits_t stuffed = canTiming_frameBits(&frame);
+    EXPECT_GT(stuffed.nominalBits, bits.nominalBits);
+    EXPECT_LE(stuffed.nominalBits, worst.nominalBits);
+
+    frame.fd = true;
+    frame.brs = true;
+    frame.dlc = 15;
+    canFrameBits_t fd = canTiming_frameBits(&frame);
+    canFrameBits_t fdWorst = canTiming_worstCaseBits(64, false, true, true);
+    EXPECT_GT(fd.dataBits, 512u);
+    EXPECT_LE(fd.dataBits + fd.nominalBits, fdWorst.dataBits + fdWorst.nominalBits);
+    EXPECT_LT(fd.nominalBits, 50u);
+
+    EXPECT_EQ(canTiming_frameTimeNs(worst, 500000, 0), 270000u);
+    EXPECT_LT(canTiming_frameTimeNs(fd, 500000, 2000000), canTiming_frameTimeNs(fd, 500000, 0));
+}
+
+TEST_F(CANManagerTest, IdStatsTest) {
+    canFrame_t frame = {};
+    frame.id = 0x321;
+    frame.dlc = 8;
+
+    for (uint64_t i = 0; i < 5; i++) {
+        frame.timestampUs = 1000 + (i * 10000) + ((i % 2) * 100);
+        EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    }
+    frame.extended = true;
+    frame.id = 0x18FF0001u;
+    frame.timestampUs = 0;
+    EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    canManager_processMessages();
+
+    const canStats_t* stats = canManager_getStats();
+    EXPECT_EQ(stats->idStatsCount, 2u);
+    ASSERT_NE(stats->idStats, nullptr);
+
+    const canIdStats_t* entry = canManager_getIdStats(0x321, false);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->rxCount, 5u);
+    EXPECT_EQ(entry->txCount, 0u);
+    EXPECT_EQ(entry->cycleMinUs, 9900u);
+    EXPECT_EQ(entry->cycleMaxUs, 10100u);
+    EXPECT_EQ(entry->cycleAvgUs, 10000u);
+    EXPECT_GT(entry->jitterUs, 0u);
+
+    ASSERT_NE(canManager_getIdStats(0x18FF0001u, true), nullptr);
+    EXPECT_EQ(canManager_getIdStats(0x18FF0001u, true)->rxCount, 1u);
+    EXPECT_EQ(canManager_getIdStats(0x18FF0002u, true), nullptr);
+    EXPECT_EQ(canManager_getIdStats(0x322, false), nullptr);
+
+    uint32_t histogramTotal = 0;
+    for (uint32_t i = 0; i < CAN_LATENCY_BUCKETS; i++) {
+        histogramTotal += stats->rxLatencyHistogram[i];
+    }
+    EXPECT_EQ(histogramTotal, 6u);
+    EXPECT_GT(stats->busTimeUs, 0u);
+}
+
+TEST_F(CANManagerTest, BusLoadWindowTest) {
+    canFrame_t frame = {};
+    frame.id = 0x321;
+    frame.dlc = 8;
+
+    for (uint32_t i = 0; i < 20; i++) {
+        EXPECT_EQ(canManager_enqueueRxFrame(&frame), CAN_STATUS_OK);
+    }
+    canManager_processMessages();
+    uint64_t windowBusUs = canManager_getStats()->busTimeUs;
+    ASSERT_GT(windowBusUs, 0u);
+
+    /* Nothing is published before the first window completes */
+    timeBase_advanceUs(CAN_BUS_LOAD_WINDOW_US / 2);
+    EXPECT_EQ(canManager_getStats()->busLoadPermille, 0u);
+
+    /* Once it has, reading the stats does not disturb the window */
+    timeBase_advanceUs(CAN_BUS_LOAD_WINDOW_US / 2);
+    canManager_processMessages();
+    uint32_t load = canManager_getStats()->busLoadPermille;
+    EXPECT_NEAR(load, (windowBusUs * 1000u) / CAN_BUS_LOAD_WINDOW_US, 1u);
+    EXPECT_GT(load, 0u);
+    timeBase_advanceUs(CAN_BUS_LOAD_WINDOW_US / 2);
+    EXPECT_EQ(canManager_getStats()->busLoadPermille, load);
+    EXPECT_EQ(canManager_getStats()->busLoadPermille, load);
+
+    /* An idle window reads as idle, however long ago the last frame was */
+    timeBase_advanceUs(CAN_BUS_LOAD_WINDOW_US * 10);
+    canManager_processMessages();
+    EXPECT_EQ(canManager_getStats()->busLoadPermille, 0u);
+}
+
+TEST_F(CANManagerTest, TxStatsAndErrorsTest) {
+    canFrame_t frame = {};
+    frame.id = 0x100;
+    frame.dlc = 8;
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+        EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+    }
+
+    const canStats_t* stats = canManager_getStats();
+    ASSERT_NE(canManager_getIdStats(0x100, false), nullptr);
+    EXPECT_EQ(canManager_getIdStats(0x100, false)->txCount, 3u);
+    uint32_t histogramTotal = 0;
+    for (uint32_t i = 0; i < CAN_LATENCY_BUCKETS; i++) {
+        histogramTotal += stats->txLatencyHistogram[i];
+    }
+    EXPECT_EQ(histogramTotal, 3u);
+    EXPECT_EQ(stats->errorCount, 0u);
+
+    static canTransport_t busOff = canTransport_null;
+    busOff.send = busOffSend;
+    busOff.sendBatch = nullptr;
+    canConfig_t config = {};
+    config.transport = &busOff;
+    ASSERT_TRUE(canManager_init(&config));
+
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_BUS_OFF);
+    EXPECT_EQ(canManager_getStats()->busOffCount, 1u);
+    EXPECT_EQ(canManager_getStats()->errorCount, 1u);
+    EXPECT_EQ(canManager_getIdStats(0x100, false), nullptr);
+}
+
+TEST_F(CANManagerTest, BusOffRecoveryTest) {
+    static canTransport_t scripted = canTransport_null;
+    scripted.send = scriptedSend;
+    scripted.sendBatch = nullptr;
+    canConfig_t config = {};
+    config.transport = &scripted;
+    ASSERT_TRUE(canManager_init(&config));
+    scriptedCalls = 0;
+
+    canFrame_t frame = {};
+    frame.id = 0x200;
+    frame.dlc = 1;
+
+    /* 16 errors reach the error-passive limit, one good frame leaves it */
+    scriptedStatus = CAN_STATUS_ERROR;
+    for (int i = 0; i < 16; i++) {
+        EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_ERROR);
+    }
+    EXPECT_EQ(canManager_getBusState(), CAN_BUS_STATE_PASSIVE);
+    EXPECT_EQ(canManager_getStats()->txErrorCounter, CAN_TEC_PASSIVE);
+    EXPECT_EQ(canManager_getStats()->passiveCount, 1u);
+    scriptedStatus = CAN_STATUS_OK;
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_getBusState(), CAN_BUS_STATE_ACTIVE);
+
+    /* Past 256 the channel goes bus off and stops calling the backend */
+    scriptedStatus = CAN_STATUS_ERROR;
+    for (int i = 0; i < 17; i++) {
+        canManager_sendFrame(&frame);
+    }
+    EXPECT_EQ(canManager_getBusState(), CAN_BUS_STATE_BUS_OFF);
+    EXPECT_EQ(canManager_getStats()->busOffCount, 1u);
+    EXPECT_EQ(canManager_getStats()->errorCount, 33u);
+    uint32_t calls = scriptedCalls;
+    EXPECT_EQ(canManager_sendFrame(&frame), CAN_STATUS_BUS_OFF);
+    EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_BUS_OFF);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 1u);
+    EXPECT_EQ(scriptedCalls, calls);
+
+    /* Recovery after the minimum backoff */
+    timeBase_advanceUs((CAN_BUS_OFF_BACKOFF_MIN_MS - 1U) * 1000U);
+    EXPECT_EQ(canManager_getBusState(), CAN_BUS_STATE_BUS_OFF);
+    timeBase_advanceUs(1000U);
+    EXPECT_EQ(canManager_getBusState(), CAN_BUS_STATE_ACTIVE);
+    EXPECT_EQ(canManager_getStats()->recoveryCount, 1u);
+    EXPECT_EQ(canManager_getStats()->txErrorCounter, 0u);
+
+    /* Going bus off again before any frame got through doubles the backoff */
+    scriptedStatus = CAN_STATUS_BUS_OFF;
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_BUS_OFF);
+    EXPECT_EQ(canManager_getStats()->busOffCount, 2u);
+    timeBase_advanceUs(CAN_BUS_OFF_BACKOFF_MIN_MS * 1000U);
+    EXPECT_EQ(canManager_getBusState(), CAN_BUS_STATE_BUS_OFF);
+    timeBase_advanceUs(CAN_BUS_OFF_BACKOFF_MIN_MS * 1000U);
+    EXPECT_EQ(canManager_getBusState(), CAN_BUS_STATE_ACTIVE);
+
+    /* A frame getting through resets the backoff */
+    scriptedStatus = CAN_STATUS_OK;
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 0u);
+    scriptedStatus = CAN_STATUS_BUS_OFF;
+    canManager_sendFrame(&frame);
+    timeBase_advanceUs(CAN_BUS_OFF_BACKOFF_MIN_MS * 1000U);
+    EXPECT_EQ(canManager_getBusState(), CAN_BUS_STATE_ACTIVE);
+}
+
+TEST_F(CANManagerTest, TxTimeoutAbortTest) {
+    canLoopback_t loopback;
+    canConfig_t config = {};
+    config.transport = &canTransport_loopback;
+    config.transportContext = &loopback;
+    config.txTimeoutMs = 50;
+    ASSERT_TRUE(canManager_init(&config));
+
+    canFrame_t frame = {};
+    frame.id = 0x200;
+    frame.dlc = 1;
+
+    /* A frame older than the TX timeout is aborted at the next flush */
+    EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    timeBase_advanceUs(60000U);
+    frame.id = 0x201;
+    EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_getStats()->txTimeoutCount, 1u);
+    ASSERT_EQ(loopback.head - loopback.tail, 1u);
+    EXPECT_EQ(loopback.frames[0].id, 0x201u);
+
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    }
+    EXPECT_EQ(canManager_abortTx(), 3u);
+    EXPECT_EQ(canManager_getStats()->txAbortCount, 3u);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 0u);
+
+    /* A mailbox ID keeps one queued frame, holding the latest value */
+    ASSERT_TRUE(canManager_setTxMailbox(0x210, true));
+    frame.id = 0x210;
+    frame.data[0] = 1;
+    EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    frame.id = 0x211;
+    EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    frame.id = 0x210;
+    frame.data[0] = 2;
+    EXPECT_EQ(canManager_queueFrame(&frame), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 2u);
+    EXPECT_EQ(canManager_flushTx(), CAN_STATUS_OK);
+    ASSERT_EQ(loopback.head - loopback.tail, 3u);
+    EXPECT_EQ(loopback.frames[1].id, 0x210u);
+    EXPECT_EQ(loopback.frames[1].data[0], 2);
+    EXPECT_EQ(loopback.frames[2].id, 0x211u);
+    EXPECT_FALSE(canManager_setTxMailbox(CAN_STD_ID_COUNT, true));
+}
+
+TEST_F(CANManagerTest, OnChangeTransmissionTest) {
+    canConfig_t config = {};
+    config.txMode = CAN_TX_MODE_ON_CHANGE;
+    config.heartbeatMs = 1000;
+    config.deadband.temperature = CAN_TX_DEADBAND_TEMP;
+    config.deadband.dutyCycle = CAN_TX_DEADBAND_DUTY;
+    config.deadband.pidGain = CAN_TX_DEADBAND_GAIN;
+    config.deadband.setpoint = CAN_TX_DEADBAND_SETPOINT;
+    ASSERT_TRUE(canManager_init(&config));
+
+    /* First call sends every status message once */
+    timeBase_advanceUs(CAN_SCHEDULE_TICK_MS * 1000U);
+    canManager_periodicSend();
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 4u);
+    canManager_flushTx();
+
+    /* Steady state: nothing goes out until the heartbeat expires */
+    for (int i = 0; i < 8; i++) {
+        timeBase_advanceUs(CAN_SCHEDULE_TICK_MS * 1000U);
+        canManager_periodicSend();
+    }
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 0u);
+    timeBase_advanceUs(CAN_SCHEDULE_TICK_MS * 1000U);
+    canManager_periodicSend();
+    timeBase_advanceUs(CAN_SCHEDULE_TICK_MS * 1000U);
+    canManager_periodicSend();
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 4u);
+    canManager_flushTx();
+    EXPECT_EQ(canManager_getStats()->txCount, 8u);
+}
+
+TEST_F(CANManagerTest, DuplicateSuppressionTest) {
+    canConfig_t config = {};
+    config.txMode = CAN_TX_MODE_ON_CHANGE;
+    config.heartbeatMs = 500;
+    ASSERT_TRUE(canManager_init(&config));
+
+    EXPECT_EQ(canManager_sendSystemStatus(3, IGNITION_ON, LEVEL_NORMAL, 0), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_sendSystemStatus(3, IGNITION_ON, LEVEL_NORMAL, 0), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 1u);
+    EXPECT_EQ(canManager_getStats()->txSuppressedCount, 1u);
+
+    /* A changed value replaces the queued frame in its mailbox */
+    EXPECT_EQ(canManager_sendSystemStatus(5, IGNITION_ON, LEVEL_NORMAL, 0), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 1u);
+    EXPECT_EQ(canManager_getStats()->txReplacedCount, 1u);
+    canManager_flushTx();
+
+    /* The last system status is repeated as a heartbeat */
+    for (int i = 0; i < 5; i++) {
+        timeBase_advanceUs(CAN_SCHEDULE_TICK_MS * 1000U);
+        canManager_periodicSend();
+    }
+    canManager_flushTx();
+    const canIdStats_t* entry = canManager_getIdStats(CAN_MSG_SYSTEM_STATUS, false);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->txCount, 2u);
+
+    config.txMode = CAN_TX_MODE_PERIODIC;
+    ASSERT_TRUE(canManager_init(&config));
+    EXPECT_EQ(canManager_sendSystemStatus(3, IGNITION_ON, LEVEL_NORMAL, 0), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_sendSystemStatus(3, IGNITION_ON, LEVEL_NORMAL, 0), CAN_STATUS_OK);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 1u);
+    EXPECT_EQ(canManager_getStats()->txReplacedCount, 1u);
+}
+
+TEST_F(CANManagerTest, ScheduleTest) {
+    canConfig_t config = {};
+    config.baudrate = 250000;
+    ASSERT_TRUE(canManager_init(&config));
+
+    uint32_t tempFrames = 0;
+    uint32_t pidFrames = 0;
+    uint32_t maxPerTick = 0;
+    for (int tick = 0; tick < 50; tick++) {
+        timeBase_advanceUs(CAN_SCHEDULE_TICK_MS * 1000U);
+        canManager_periodicSend();
+        uint32_t depth = canManager_getStats()->txQueueDepth;
+        if (depth > maxPerTick) {
+            maxPerTick = depth;
+        }
+        canManager_flushTx();
+    }
+    tempFrames = canManager_getIdStats(CAN_MSG_TEMP_STATUS, false)->txCount;
+    pidFrames = canManager_getIdStats(CAN_MSG_PID_PARAMS, false)->txCount;
+    EXPECT_EQ(tempFrames, 50u);
+    EXPECT_EQ(pidFrames, 1u);
+    EXPECT_EQ(canManager_getIdStats(CAN_MSG_PUMP_STATUS, false)->txCount, 10u);
+    EXPECT_EQ(canManager_getIdStats(CAN_MSG_FAN_STATUS, false)->txCount, 10u);
+
+    canScheduleReport_t report;
+    canManager_getScheduleReport(&report);
+    EXPECT_EQ(report.tickMs, (uint32_t)CAN_SCHEDULE_TICK_MS);
+    EXPECT_EQ(report.hyperperiodMs, 5000u);
+    EXPECT_EQ(report.framesPerTickMax, 2u);
+    EXPECT_EQ(report.framesPerTickMax, maxPerTick);
+    EXPECT_GT(report.busTimePerTickMaxUs, 0u);
+
+    EXPECT_FALSE(canManager_setSchedule(CAN_MSG_TEMP_STATUS, 150, 0));
+    EXPECT_FALSE(canManager_setSchedule(CAN_MSG_TEMP_STATUS, 100, 100));
+    EXPECT_FALSE(canManager_setSchedule(CAN_MSG_SETPOINT_CMD, 100, 0));
+    EXPECT_TRUE(canManager_setSchedule(CAN_MSG_PUMP_STATUS, 500, 0));
+    EXPECT_TRUE(canManager_setSchedule(CAN_MSG_FAN_STATUS, 500, 0));
+    canManager_getScheduleReport(&report);
+    EXPECT_EQ(report.framesPerTickMax, 3u);
+
+    config.fdEnabled = true;
+    config.consolidatedStatus = true;
+    config.dataBaudrate = 1000000;
+    ASSERT_TRUE(canManager_init(&config));
+    canManager_getScheduleReport(&report);
+    EXPECT_EQ(report.framesPerTickMax, 1u);
+    EXPECT_EQ(report.hyperperiodMs, 100u);
+}
+
+TEST_F(CANManagerTest, MultiChannelTest) {
+    canLoopback_t loopbackA;
+    canLoopback_t loopbackB;
+    canConfig_t config = {};
+    config.baudrate = 500000;
+    config.transport = &canTransport_loopback;
+
+    canChannel_t* busA = canChannel_get(1);
+    canChannel_t* busB = canChannel_get(2);
+    ASSERT_NE(busA, nullptr);
+    ASSERT_NE(busB, nullptr);
+    EXPECT_EQ(canChannel_get(CAN_CHANNELS_MAX), nullptr);
+    EXPECT_EQ(canChannel_getIndex(busB), 2u);
+    EXPECT_EQ(canChannel_get(CAN_CHANNEL_DEFAULT), canChannel_get(0));
+
+    config.transportContext = &loopbackA;
+    ASSERT_TRUE(canChannel_init(busA, &config));
+    config.transportContext = &loopbackB;
+    ASSERT_TRUE(canChannel_init(busB, &config));
+
+    canFilter_t filter = {0x300, 0x7FF, false};
+    ASSERT_TRUE(canChannel_setFilter(busB, 0, &filter));
+    ASSERT_TRUE(canChannel_registerHandler(busA, 0x300, false, countingHandler));
+    canChannel_setRxCallback(busB, capturingCallback);
+    handlerCount = 0;
+    callbackCount = 0;
+
+    canFrame_t frame = {};
+    frame.id = 0x300;
+    frame.dlc = 2;
+    EXPECT_EQ(canChannel_sendFrame(busA, &frame), CAN_STATUS_OK);
+    EXPECT_EQ(canChannel_sendFrame(busB, &frame), CAN_STATUS_OK);
+    frame.id = 0x301;
+    EXPECT_EQ(canChannel_sendFrame(busB, &frame), CAN_STATUS_OK);
+    canChannel_processMessages(busA);
+    canChannel_processMessages(busB);
+
+    /* Each bus keeps its own handlers, filters and counters */
+    EXPECT_EQ(handlerCount, 1u);
+    EXPECT_EQ(callbackCount, 1u);
+    EXPECT_EQ(lastCallbackFrame.id, 0x300u);
+    EXPECT_EQ(canChannel_getStats(busA)->rxCount, 1u);
+    EXPECT_EQ(canChannel_getStats(busB)->txCount, 2u);
+    EXPECT_EQ(canChannel_getStats(busB)->rxFilteredCount, 1u);
+    EXPECT_EQ(canChannel_getIdStats(busB, 0x301, false)->txCount, 1u);
+    EXPECT_EQ(canChannel_getIdStats(busA, 0x301, false), nullptr);
+    EXPECT_EQ(canManager_getStats()->txCount, 0u);
+    EXPECT_EQ(canManager_getStats()->rxCount, 0u);
+
+    EXPECT_TRUE(canChannel_init(busA, nullptr));
+    EXPECT_TRUE(canChannel_init(busB, nullptr));
+}
+
+TEST_F(CANManagerTest, ChannelThreadsTest) {
+    const uint32_t frameCount = 20000;
+    canChannel_t* buses[2] = {canChannel_get(1), canChannel_get(2)};
+    uint32_t received[2] = {0, 0};
+
+    for (canChannel_t* bus : buses) {
+        ASSERT_TRUE(canChannel_init(bus, nullptr));
+    }
+
+    /* One thread per bus; no state is shared between them */
+    auto serve = [frameCount, &received](canChannel_t* bus, uint32_t index) {
+        canFrame_t frame = {};
+        frame.id = 0x400 + index;
+        frame.dlc = 1;
+        for (uint32_t i = 0; i < frameCount; i++) {
+            EXPECT_EQ(canChannel_enqueueRxFrame(bus, &frame), CAN_STATUS_OK);
+            canFrame_t out;
+            if (canChannel_receiveFrame(bus, &out) == CAN_STATUS_OK && out.id == frame.id) {
+                received[index]++;
+            }
+        }
+    };
+    std::thread first(serve, buses[0], 0u);
+    std::thread second(serve, buses[1], 1u);
+    first.join();
+    second.join();
+
+    EXPECT_EQ(received[0], frameCount);
+    EXPECT_EQ(received[1], frameCount);
+    EXPECT_EQ(canChannel_getStats(buses[0])->rxCount, frameCount);
+    EXPECT_EQ(canChannel_getStats(buses[1])->rxCount, frameCount);
+}
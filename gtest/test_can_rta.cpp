@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <cstring>
+extern "C" {
+    #include "can_manager.h"
+    #include "can_timing.h"
+    #include "can_rta.h"
+}
+
+class CANRtaTest : public ::testing::Test {
+protected:
+    static canRtaMessage_t message(uint32_t id, uint8_t length, uint32_t periodUs, uint32_t jitterUs = 0,
+                                   uint32_t deadlineUs = 0) {
+        canRtaMessage_t result = {};
+        result.id = id;
+        result.length = length;
+        result.periodUs = periodUs;
+        result.jitterUs = jitterUs;
+        result.deadlineUs = deadlineUs;
+        return result;
+    }
+
+    static uint64_t frameNs(uint8_t length, uint32_t baudrate) {
+        return canTiming_frameTimeNs(canTiming_worstCaseBits(length, false, false, false), baudrate, 0);
+    }
+};
+
+TEST_F(CANRtaTest, SingleMessageTest) {
+    canRtaMessage_t messages[] = {message(0x100, 8, 10000, 200)};
+    canRtaResult_t results[1];
+    canRtaReport_t report;
+
+    /* Alone on the bus: jitter plus its own transmission */
+    ASSERT_TRUE(canRta_analyze(messages, 1, 500000, 0, results, &report));
+    EXPECT_EQ(results[0].frameTimeNs, frameNs(8, 500000));
+    EXPECT_EQ(results[0].blockingNs, 0u);
+    EXPECT_EQ(results[0].responseNs, 200000u + frameNs(8, 500000));
+    EXPECT_EQ(results[0].instances, 1u);
+    EXPECT_TRUE(results[0].schedulable);
+    EXPECT_EQ(report.utilizationPermille, (uint32_t)(frameNs(8, 500000) * 1000 / 10000000));
+    EXPECT_EQ(report.worstSlackNs, 10000000u - results[0].responseNs);
+}
+
+TEST_F(CANRtaTest, PriorityTest) {
+    /* Equal frames, long periods: blocking by one lower priority frame
+       plus interference from every higher priority one */
+    canRtaMessage_t messages[] = {
+        message(0x300, 8, 100000),
+        message(0x100, 8, 100000),
+        message(0x200, 8, 100000)
+    };
+    canRtaResult_t results[3];
+    uint64_t c = frameNs(8, 500000);
+
+    ASSERT_TRUE(canRta_analyze(messages, 3, 500000, 0, results, nullptr));
+    EXPECT_EQ(results[1].blockingNs, c);
+    EXPECT_EQ(results[1].responseNs, 2 * c);
+    EXPECT_EQ(results[2].blockingNs, c);
+    EXPECT_EQ(results[2].responseNs, 3 * c);
+    EXPECT_EQ(results[0].blockingNs, 0u);
+    EXPECT_EQ(results[0].responseNs, 3 * c);
+
+    /* A standard frame outranks an extended one with the same base ID */
+    messages[0].id = 0x100u << 18;
+    messages[0].extended = true;
+    ASSERT_TRUE(canRta_analyze(messages, 3, 500000, 0, results, nullptr));
+    EXPECT_EQ(results[1].blockingNs, results[0].frameTimeNs);
+    EXPECT_GT(results[0].frameTimeNs, c);
+}
+
+TEST_F(CANRtaTest, BusyPeriodTest) {
+    /* The low priority message's own next instance is released before the
+       first one completes, so more than one instance is checked */
+    uint64_t c = frameNs(8, 125000);
+    uint32_t period = (uint32_t)((3 * c) / 1000);
+    canRtaMessage_t messages[] = {
+        message(0x100, 8, period),
+        message(0x200, 8, period, period / 2)
+    };
+    canRtaResult_t results[2];
+    canRtaReport_t report;
+
+    canRta_analyze(messages, 2, 125000, 0, results, &report);
+    EXPECT_GT(results[1].instances, 1u);
+    EXPECT_GT(report.utilizationPermille, 600u);
+}
+
+TEST_F(CANRtaTest, DeadlineMissTest) {
+    uint64_t c = frameNs(8, 250000);
+    canRtaMessage_t messages[] = {
+        message(0x100, 8, 10000),
+        message(0x101, 8, 10000),
+        message(0x102, 8, 10000, 0, (uint32_t)((2 * c) / 1000))
+    };
+    canRtaResult_t results[3];
+    canRtaReport_t report;
+
+    /* 0x102 waits for both higher priority frames: 3C > 2C */
+    EXPECT_FALSE(canRta_analyze(messages, 3, 250000, 0, results, &report));
+    EXPECT_FALSE(results[2].schedulable);
+    EXPECT_TRUE(results[0].schedulable);
+    EXPECT_EQ(report.unschedulableCount, 1u);
+    EXPECT_FALSE(report.schedulable);
+    EXPECT_EQ(report.worstSlackNs, 0u);
+
+    /* Relaxed to the period it holds */
+    messages[2].deadlineUs = 0;
+    EXPECT_TRUE(canRta_analyze(messages, 3, 250000, 0, results, &report));
+}
+
+TEST_F(CANRtaTest, OverloadTest) {
+    /* Over 100 % utilisation: the lowest priority messages can never be
+       guaranteed, higher ones still are */
+    uint32_t period = (uint32_t)(frameNs(8, 125000) / 1000) + 1;
+    canRtaMessage_t messages[] = {
+        message(0x100, 8, 2 * period),
+        message(0x200, 8, 2 * period),
+        message(0x300, 8, 2 * period)
+    };
+    canRtaResult_t results[3];
+    canRtaReport_t report;
+
+    EXPECT_FALSE(canRta_analyze(messages, 3, 125000, 0, results, &report));
+    EXPECT_GT(report.utilizationPermille, 1000u);
+    EXPECT_EQ(results[2].responseNs, UINT64_MAX);
+    EXPECT_FALSE(results[2].schedulable);
+    EXPECT_TRUE(results[0].schedulable);
+
+    /* Invalid input */
+    messages[0].periodUs = 0;
+    EXPECT_FALSE(canRta_analyze(messages, 3, 125000, 0, results, &report));
+    EXPECT_FALSE(canRta_analyze(messages, 3, 0, 0, results, &report));
+}
+
+TEST_F(CANRtaTest, ControllerScheduleTest) {
+    canConfig_t config = {};
+    canScheduleInfo_t schedule[CAN_RTA_MESSAGES_MAX];
+    canRtaMessage_t messages[CAN_RTA_MESSAGES_MAX];
+    canRtaReport_t report;
+
+    /* The default status schedule holds at the controller's bit rate */
+    config.baudrate = 250000;
+    ASSERT_TRUE(canManager_init(&config));
+    uint32_t count = canManager_getSchedule(schedule, CAN_RTA_MESSAGES_MAX);
+    ASSERT_EQ(count, 4u);
+    EXPECT_EQ(schedule[0].id, (uint32_t)CAN_MSG_TEMP_STATUS);
+    EXPECT_EQ(schedule[0].periodMs, 100u);
+
+    for (uint32_t i = 0; i < count; i++) {
+        messages[i] = message(schedule[i].id, schedule[i].length, schedule[i].periodMs * 1000);
+    }
+    EXPECT_TRUE(canRta_analyze(messages, count, config.baudrate, 0, nullptr, &report));
+    EXPECT_LT(report.utilizationPermille, 10u);
+
+    /* With consolidated FD status, one FD frame replaces the four */
+    config.fdEnabled = true;
+    config.dataBaudrate = 2000000;
+    config.consolidatedStatus = true;
+    ASSERT_TRUE(canManager_init(&config));
+    count = canManager_getSchedule(schedule, CAN_RTA_MESSAGES_MAX);
+    ASSERT_EQ(count, 1u);
+    EXPECT_EQ(schedule[0].id, (uint32_t)CAN_MSG_CONSOLIDATED_STATUS);
+    EXPECT_TRUE(schedule[0].fd);
+}
@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <sys/socket.h>
+#include <unistd.h>
+extern "C" {
+    #include "can_manager.h"
+    #include "can_transport.h"
+    #include "can_socketcan.h"
+    #include "time_base.h"
+}
+
+static uint32_t receivedCount;
+static canFrame_t received[64];
+
+static void receivingCallback(const canFrame_t* frame) {
+    if (receivedCount < 64) {
+        received[receivedCount] = *frame;
+    }
+    receivedCount++;
+}
+
+/*
+ * Channel 1 runs on the SocketCAN backend against a peer socket. With a
+ * vcan0 interface both ends are raw sockets on it; without one they are
+ * the two ends of a socketpair standing in for the bus.
+ */
+class CANSocketcanTest : public ::testing::Test {
+protected:
+    canSocketcan_t local;
+    canSocketcan_t peer;
+    int pair[2] = {-1, -1};
+    bool standIn = false;
+    canChannel_t* channel;
+
+    void SetUp() override {
+        canConfig_t config = {};
+
+        timeBase_useVirtual(0);
+        memset(&local, 0, sizeof(local));
+        memset(&peer, 0, sizeof(peer));
+        local.interfaceName = "vcan0";
+        peer.interfaceName = "vcan0";
+        config.fdEnabled = true;
+        config.transport = &canTransport_socketcan;
+        config.transportContext = &local;
+
+        if (!canTransport_socketcan.open(&peer, &config)) {
+            standIn = true;
+            ASSERT_EQ(socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK, 0, pair), 0);
+            local.interfaceName = nullptr;
+            local.fd = pair[0];
+            peer.interfaceName = nullptr;
+            peer.fd = pair[1];
+            ASSERT_TRUE(canTransport_socketcan.open(&peer, &config));
+        }
+
+        channel = canChannel_get(1);
+        ASSERT_TRUE(canChannel_init(channel, &config));
+        canChannel_setRxCallback(channel, receivingCallback);
+        receivedCount = 0;
+    }
+
+    void TearDown() override {
+        canChannel_init(channel, nullptr);
+        canTransport_socketcan.close(&peer);
+        for (int fd : pair) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+        timeBase_useMonotonic();
+    }
+
+    void peerSend(uint32_t id, bool extended, uint8_t dlc, uint8_t fill) {
+        canFrame_t frame = {};
+        frame.id = id;
+        frame.extended = extended;
+        frame.dlc = dlc;
+        memset(frame.data, fill, dlc);
+        ASSERT_EQ(canTransport_socketcan.send(&peer, &frame), CAN_STATUS_OK);
+    }
+};
+
+TEST_F(CANSocketcanTest, RoundTripTest) {
+    peerSend(0x123, false, 8, 0xA5);
+    peerSend(0x18FF0042, true, 3, 0x11);
+
+    canFrame_t remote = {};
+    remote.id = 0x321;
+    remote.remote = true;
+    remote.dlc = 4;
+    ASSERT_EQ(canTransport_socketcan.send(&peer, &remote), CAN_STATUS_OK);
+
+    canChannel_processMessages(channel);
+    ASSERT_EQ(receivedCount, 3u);
+    EXPECT_EQ(received[0].id, 0x123u);
+    EXPECT_FALSE(received[0].extended);
+    EXPECT_EQ(received[0].dlc, 8);
+    EXPECT_EQ(received[0].data[7], 0xA5);
+    EXPECT_EQ(received[1].id, 0x18FF0042u);
+    EXPECT_TRUE(received[1].extended);
+    EXPECT_EQ(received[1].dlc, 3);
+    EXPECT_TRUE(received[2].remote);
+    EXPECT_EQ(received[2].dlc, 4);
+
+    /* The channel transmits back to the peer */
+    canFrame_t frame = {};
+    frame.id = 0x456;
+    frame.dlc = 2;
+    frame.data[1] = 0x7E;
+    EXPECT_EQ(canChannel_sendFrame(channel, &frame), CAN_STATUS_OK);
+    canFrame_t echoed = {};
+    ASSERT_EQ(canTransport_socketcan.recv(&peer, &echoed), CAN_STATUS_OK);
+    EXPECT_EQ(echoed.id, 0x456u);
+    EXPECT_EQ(echoed.data[1], 0x7E);
+    EXPECT_EQ(canTransport_socketcan.recv(&peer, &echoed), CAN_STATUS_TIMEOUT);
+
+    if (standIn) {
+        /* FD frames keep their length and bit rate switch */
+        canFrame_t fd = {};
+        fd.id = 0x200;
+        fd.fd = true;
+        fd.brs = true;
+        fd.dlc = canManager_lengthToDlc(20);
+        memset(fd.data, 0x3C, 20);
+        ASSERT_EQ(canTransport_socketcan.send(&peer, &fd), CAN_STATUS_OK);
+        canChannel_processMessages(channel);
+        ASSERT_EQ(receivedCount, 4u);
+        EXPECT_TRUE(received[3].fd);
+        EXPECT_TRUE(received[3].brs);
+        EXPECT_EQ(canManager_frameLength(&received[3]), 20);
+        EXPECT_EQ(received[3].data[19], 0x3C);
+    }
+}
+
+TEST_F(CANSocketcanTest, BatchTest) {
+    canFrame_t frames[40] = {};
+    const canFrame_t* batch[40];
+    uint32_t sent = 0;
+
+    for (uint32_t i = 0; i < 40; i++) {
+        frames[i].id = 0x100 + i;
+        frames[i].dlc = 1;
+        frames[i].data[0] = (uint8_t)i;
+        batch[i] = &frames[i];
+    }
+
+    /* 40 frames leave the peer in two sendmmsg calls */
+    EXPECT_EQ(canTransport_socketcan.sendBatch(&peer, batch, 40, &sent), CAN_STATUS_OK);
+    EXPECT_EQ(sent, 40u);
+    EXPECT_EQ(peer.stats.txSyscallCount, 2u);
+
+    /* ...and arrive in recvmmsg batches; what does not fit the RX queue
+       stays in the socket for the next pass */
+    canChannel_processMessages(channel);
+    EXPECT_EQ(receivedCount, CAN_RX_QUEUE_DEPTH_DEFAULT);
+    canChannel_processMessages(channel);
+    ASSERT_EQ(receivedCount, 40u);
+    EXPECT_EQ(received[39].id, 0x127u);
+    EXPECT_EQ(local.stats.rxFrameCount, 40u);
+    EXPECT_LE(local.stats.rxSyscallCount, 4u);
+
+    /* A TX queue flush is a single sendmmsg */
+    for (uint32_t i = 0; i < 10; i++) {
+        ASSERT_EQ(canChannel_queueFrame(channel, &frames[i]), CAN_STATUS_OK);
+    }
+    uint32_t before = local.stats.txSyscallCount;
+    EXPECT_EQ(canChannel_flushTx(channel), CAN_STATUS_OK);
+    EXPECT_EQ(local.stats.txSyscallCount - before, 1u);
+
+    canFrame_t frame;
+    uint32_t count = 0;
+    while (canTransport_socketcan.recv(&peer, &frame) == CAN_STATUS_OK) {
+        count++;
+    }
+    EXPECT_EQ(count, 10u);
+}
+
+TEST_F(CANSocketcanTest, TimestampTest) {
+    timeBase_useMonotonic();
+    uint64_t before = timeBase_nowUs();
+
+    peerSend(0x123, false, 1, 0);
+    canChannel_processMessages(channel);
+
+    /* The kernel's real-time stamp lands in the time base */
+    ASSERT_EQ(receivedCount, 1u);
+    EXPECT_EQ(local.stats.rxTimestampCount, 1u);
+    EXPECT_GE(received[0].timestampUs + 1000, before);
+    EXPECT_LE(received[0].timestampUs, timeBase_nowUs());
+}
+
+TEST_F(CANSocketcanTest, KernelFilterTest) {
+    canFilter_t standard = {0x100, 0x7FF, false};
+    canFilter_t extended = {0x18FF0000, 0x1FFF0000, true};
+    ASSERT_TRUE(canChannel_setFilter(channel, 0, &standard));
+    ASSERT_TRUE(canChannel_setFilter(channel, 1, &extended));
+
+    peerSend(0x100, false, 1, 0);
+    peerSend(0x200, false, 1, 0);
+    peerSend(0x100, true, 1, 0);
+    peerSend(0x18FF1234, true, 1, 0);
+    canChannel_processMessages(channel);
+
+    /* Rejected frames never reach the channel's software filter */
+    ASSERT_EQ(receivedCount, 2u);
+    EXPECT_EQ(received[0].id, 0x100u);
+    EXPECT_FALSE(received[0].extended);
+    EXPECT_EQ(received[1].id, 0x18FF1234u);
+    EXPECT_EQ(canChannel_getStats(channel)->rxFilteredCount, 0u);
+    EXPECT_EQ(canChannel_getFilterHits(channel, 0), 1u);
+
+    /* Clearing the filters opens the socket again */
+    canChannel_clearFilters(channel);
+    peerSend(0x200, false, 1, 0);
+    canChannel_processMessages(channel);
+    EXPECT_EQ(receivedCount, 3u);
+}
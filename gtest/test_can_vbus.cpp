@@ -0,0 +1,295 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern "C" {
+    #include "can_manager.h"
+    #include "can_transport.h"
+    #include "can_timing.h"
+    #include "can_vbus.h"
+    #include "time_base.h"
+}
+
+static uint32_t receivedCount;
+static canFrame_t received[64];
+
+static void receivingCallback(const canFrame_t* frame) {
+    if (receivedCount < 64) {
+        received[receivedCount] = *frame;
+    }
+    receivedCount++;
+}
+
+/*
+ * Three nodes on one virtual bus named after this process: a and b are
+ * driven directly through the transport, channel 1 joins through its own
+ * context.
+ */
+class CANVbusTest : public ::testing::Test {
+protected:
+    char name[64];
+    canVbus_t a;
+    canVbus_t b;
+    canVbus_t local;
+    canConfig_t config;
+    canChannel_t* channel;
+
+    void SetUp() override {
+        timeBase_useVirtual(0);
+        snprintf(name, sizeof(name), "/cooling_vbus_test_%d", (int)getpid());
+        (void)canVbus_unlink(name);
+
+        memset(&a, 0, sizeof(a));
+        memset(&b, 0, sizeof(b));
+        memset(&local, 0, sizeof(local));
+        a.name = name;
+        b.name = name;
+        local.name = name;
+
+        config = {};
+        config.baudrate = 500000;
+        config.transport = &canTransport_vbus;
+        config.transportContext = &local;
+        ASSERT_TRUE(canTransport_vbus.open(&a, &config));
+        ASSERT_TRUE(canTransport_vbus.open(&b, &config));
+
+        channel = canChannel_get(1);
+        ASSERT_TRUE(canChannel_init(channel, &config));
+        canChannel_setRxCallback(channel, receivingCallback);
+        receivedCount = 0;
+    }
+
+    void TearDown() override {
+        canChannel_init(channel, nullptr);
+        canTransport_vbus.close(&a);
+        canTransport_vbus.close(&b);
+        (void)canVbus_unlink(name);
+        timeBase_useMonotonic();
+    }
+
+    static canFrame_t makeFrame(uint32_t id, uint8_t fill) {
+        canFrame_t frame = {};
+        frame.id = id;
+        frame.dlc = 8;
+        memset(frame.data, fill, 8);
+        return frame;
+    }
+
+    static uint32_t drain(canVbus_t* node, canFrame_t* frames, uint32_t max) {
+        uint32_t count = 0;
+        canFrame_t frame;
+        while (canTransport_vbus.recv(node, &frame) == CAN_STATUS_OK) {
+            if (count < max) {
+                frames[count] = frame;
+            }
+            count++;
+        }
+        return count;
+    }
+
+    static void sleepNs(uint64_t ns) {
+        struct timespec delay;
+        delay.tv_sec = (time_t)(ns / 1000000000U);
+        delay.tv_nsec = (long)(ns % 1000000000U);
+        nanosleep(&delay, nullptr);
+    }
+};
+
+TEST_F(CANVbusTest, BroadcastTest) {
+    canFrame_t frames[8];
+    canFrame_t frame = makeFrame(0x123, 0x5A);
+
+    EXPECT_EQ(canVbus_nodeCount(&a), 3u);
+    ASSERT_EQ(canTransport_vbus.send(&a, &frame), CAN_STATUS_OK);
+
+    /* Every other node sees the frame; the sender does not */
+    ASSERT_EQ(drain(&b, frames, 8), 1u);
+    EXPECT_EQ(frames[0].id, 0x123u);
+    EXPECT_EQ(frames[0].data[7], 0x5A);
+    EXPECT_EQ(drain(&a, frames, 8), 0u);
+    canChannel_processMessages(channel);
+    ASSERT_EQ(receivedCount, 1u);
+    EXPECT_EQ(received[0].id, 0x123u);
+
+    /* The channel transmits to both other nodes */
+    frame = makeFrame(0x456, 0x11);
+    EXPECT_EQ(canChannel_sendFrame(channel, &frame), CAN_STATUS_OK);
+    ASSERT_EQ(drain(&a, frames, 8), 1u);
+    EXPECT_EQ(frames[0].id, 0x456u);
+    ASSERT_EQ(drain(&b, frames, 8), 1u);
+    EXPECT_EQ(frames[0].data[0], 0x11);
+    canChannel_processMessages(channel);
+    EXPECT_EQ(receivedCount, 1u);
+
+    /* A node joining later starts at the current head */
+    canVbus_t late = {};
+    late.name = name;
+    ASSERT_TRUE(canTransport_vbus.open(&late, &config));
+    EXPECT_EQ(drain(&late, frames, 8), 0u);
+    EXPECT_NE(late.nodeId, a.nodeId);
+    canTransport_vbus.close(&late);
+    EXPECT_EQ(canVbus_nodeCount(&a), 3u);
+}
+
+TEST_F(CANVbusTest, ArbitrationOrderTest) {
+    canFrame_t frames[8];
+    canFrame_t high = makeFrame(0x300, 0);
+    canFrame_t extended = makeFrame(0x100, 0);
+    canFrame_t low = makeFrame(0x100, 0);
+    canFrame_t middle = makeFrame(0x200, 0);
+    const canFrame_t* batch[] = {&high, &extended, &low, &middle};
+    uint32_t sent = 0;
+
+    extended.id = (0x100u << 18) | 0x42;
+    extended.extended = true;
+    b.arbitrationOrder = true;
+
+    ASSERT_EQ(canTransport_vbus.sendBatch(&a, batch, 4, &sent), CAN_STATUS_OK);
+    EXPECT_EQ(sent, 4u);
+
+    /* Frames that arrive together come out lowest arbitration key first;
+       a standard frame beats an extended one with the same base ID */
+    ASSERT_EQ(drain(&b, frames, 8), 4u);
+    EXPECT_EQ(frames[0].id, 0x100u);
+    EXPECT_FALSE(frames[0].extended);
+    EXPECT_TRUE(frames[1].extended);
+    EXPECT_EQ(frames[2].id, 0x200u);
+    EXPECT_EQ(frames[3].id, 0x300u);
+    EXPECT_GT(b.stats.rxReorderCount, 0u);
+
+    /* Without it, ring order */
+    canChannel_processMessages(channel);
+    ASSERT_EQ(receivedCount, 4u);
+    EXPECT_EQ(received[0].id, 0x300u);
+    EXPECT_EQ(received[3].id, 0x200u);
+}
+
+TEST_F(CANVbusTest, BitTimingTest) {
+    canFrame_t frames[8];
+    canFrame_t frame = makeFrame(0x123, 0xFF);
+    const canFrame_t* batch[] = {&frame, &frame};
+    uint32_t sent = 0;
+    uint64_t frameNs;
+
+    /* At 1 kbit/s a classic frame holds the bus for over 100 ms */
+    canTransport_vbus.close(&a);
+    canTransport_vbus.close(&b);
+    config.baudrate = 1000;
+    a.bitTiming = true;
+    ASSERT_TRUE(canTransport_vbus.open(&a, &config));
+    ASSERT_TRUE(canTransport_vbus.open(&b, &config));
+    frameNs = canTiming_frameTimeNs(canTiming_frameBits(&frame), config.baudrate, 0);
+    ASSERT_GT(frameNs, 100000000u);
+
+    ASSERT_EQ(canTransport_vbus.sendBatch(&a, batch, 2, &sent), CAN_STATUS_OK);
+
+    /* The bus is booked far beyond the TX backlog, so further sends wait */
+    EXPECT_EQ(canTransport_vbus.send(&a, &frame), CAN_STATUS_OVERRUN);
+    EXPECT_EQ(a.stats.txFrameCount, 2u);
+
+    /* Nothing is delivered while the first frame is still on the wire... */
+    EXPECT_EQ(drain(&b, frames, 8), 0u);
+
+    /* ...then the frames arrive one frame time apart */
+    sleepNs(frameNs + (frameNs / 10));
+    EXPECT_EQ(drain(&b, frames, 8), 1u);
+    sleepNs(frameNs);
+    EXPECT_EQ(drain(&b, frames, 8), 1u);
+}
+
+TEST_F(CANVbusTest, OverrunTest) {
+    canFrame_t frames[8];
+    canFrame_t frame = makeFrame(0x100, 0);
+
+    /* A reader that falls a full ring behind skips to the head */
+    for (uint32_t i = 0; i < CAN_VBUS_DEPTH + 10; i++) {
+        frame.data[0] = (uint8_t)i;
+        ASSERT_EQ(canTransport_vbus.send(&a, &frame), CAN_STATUS_OK);
+    }
+    EXPECT_EQ(drain(&b, frames, 8), 0u);
+    EXPECT_EQ(b.stats.rxDropCount, CAN_VBUS_DEPTH + 10);
+
+    /* ...and keeps receiving from there */
+    ASSERT_EQ(canTransport_vbus.send(&a, &frame), CAN_STATUS_OK);
+    EXPECT_EQ(drain(&b, frames, 8), 1u);
+    EXPECT_EQ(a.stats.txFrameCount, CAN_VBUS_DEPTH + 11);
+}
+
+TEST_F(CANVbusTest, UnpublishedSlotTest) {
+    canFrame_t frames[8];
+    canFrame_t frame = makeFrame(0x123, 0);
+
+    /* A producer that dies after claiming a position never publishes it */
+    ASSERT_TRUE(canVbus_claimForTest(&a));
+    ASSERT_EQ(canTransport_vbus.send(&a, &frame), CAN_STATUS_OK);
+
+    /* Readers wait behind the claimed position for a while... */
+    EXPECT_EQ(drain(&b, frames, 8), 0u);
+    EXPECT_EQ(b.stats.rxDropCount, 0u);
+
+    /* ...then skip it as a drop and receive what follows */
+    sleepNs((CAN_VBUS_UNPUBLISHED_TIMEOUT_MS + 10u) * 1000000u);
+    ASSERT_EQ(drain(&b, frames, 8), 1u);
+    EXPECT_EQ(frames[0].id, 0x123u);
+    EXPECT_EQ(b.stats.rxDropCount, 1u);
+
+    ASSERT_EQ(canTransport_vbus.send(&a, &frame), CAN_STATUS_OK);
+    EXPECT_EQ(drain(&b, frames, 8), 1u);
+    EXPECT_EQ(b.stats.rxDropCount, 1u);
+}
+
+TEST_F(CANVbusTest, MultiProcessTest) {
+    const uint32_t perNode = 200;
+    const uint32_t nodes = 3;
+    canFrame_t frames[8];
+    pid_t children[nodes];
+    uint32_t count = 0;
+    uint32_t lastSeen[nodes] = {};
+    bool ordered = true;
+
+    /* Each child joins as its own node and sends a numbered sequence */
+    for (uint32_t n = 0; n < nodes; n++) {
+        children[n] = fork();
+        ASSERT_GE(children[n], 0);
+        if (children[n] == 0) {
+            canVbus_t node = {};
+            canConfig_t childConfig = {};
+            node.name = name;
+            if (!canTransport_vbus.open(&node, &childConfig)) {
+                _exit(1);
+            }
+            for (uint32_t i = 1; i <= perNode; i++) {
+                canFrame_t frame = makeFrame(0x500 + n, 0);
+                memcpy(frame.data, &i, sizeof(i));
+                (void)canTransport_vbus.send(&node, &frame);
+            }
+            canTransport_vbus.close(&node);
+            _exit(0);
+        }
+    }
+
+    for (pid_t child : children) {
+        int status = 0;
+        ASSERT_EQ(waitpid(child, &status, 0), child);
+        EXPECT_TRUE(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+    }
+
+    /* Every frame arrives once, and each sender's frames in order */
+    canFrame_t frame;
+    while (canTransport_vbus.recv(&b, &frame) == CAN_STATUS_OK) {
+        uint32_t sequence;
+        uint32_t n = frame.id - 0x500;
+        ASSERT_LT(n, nodes);
+        memcpy(&sequence, frame.data, sizeof(sequence));
+        ordered = ordered && (sequence == lastSeen[n] + 1);
+        lastSeen[n] = sequence;
+        count++;
+    }
+    EXPECT_EQ(count, nodes * perNode);
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(b.stats.rxDropCount, 0u);
+    EXPECT_EQ(drain(&a, frames, 8), nodes * perNode);
+    EXPECT_EQ(canVbus_nodeCount(&b), 3u);
+}
@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+extern "C" {
+    #include "can_manager.h"
+    #include "can_xcp.h"
+}
+
+static std::vector<canFrame_t> txFrames;
+
+static void recordingTap(const canFrame_t* frame, bool tx) {
+    if (tx) {
+        txFrames.push_back(*frame);
+    }
+}
+
+struct measurement_t {
+    float value;
+    uint32_t counter;
+};
+
+static measurement_t calibration;
+static measurement_t readOnly;
+
+class CANXcpTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        canConfig_t config = {};
+        config.tap = recordingTap;
+        ASSERT_TRUE(canManager_init(&config));
+        canManager_setRxCallback(nullptr);
+
+        canXcpConfig_t xcp = {};
+        xcp.croId = CAN_MSG_XCP_CRO;
+        xcp.dtoId = CAN_MSG_XCP_DTO;
+        ASSERT_TRUE(canXcp_init(&xcp));
+        calibration = {1.5f, 7};
+        readOnly = {2.5f, 9};
+        ASSERT_TRUE(canXcp_addRegion(0x1000, &calibration, sizeof(calibration), true));
+        ASSERT_TRUE(canXcp_addRegion(0x2000, &readOnly, sizeof(readOnly), false));
+        txFrames.clear();
+    }
+
+    /* Send one command and return the response bytes */
+    std::vector<uint8_t> command(std::initializer_list<uint8_t> bytes) {
+        canFrame_t frame = {};
+        frame.id = CAN_MSG_XCP_CRO;
+        frame.dlc = (uint8_t)bytes.size();
+        std::copy(bytes.begin(), bytes.end(), frame.data);
+        txFrames.clear();
+        canManager_dispatchFrame(&frame);
+        if (txFrames.empty()) {
+            return {};
+        }
+        return std::vector<uint8_t>(txFrames[0].data, txFrames[0].data + txFrames[0].dlc);
+    }
+
+    void configureDaq(uint8_t prescaler) {
+        ASSERT_EQ(command({CAN_XCP_CMD_FREE_DAQ})[0], CAN_XCP_PID_RES);
+        ASSERT_EQ(command({CAN_XCP_CMD_ALLOC_DAQ, 0, 1, 0})[0], CAN_XCP_PID_RES);
+        ASSERT_EQ(command({CAN_XCP_CMD_ALLOC_ODT, 0, 0, 0, 1})[0], CAN_XCP_PID_RES);
+        ASSERT_EQ(command({CAN_XCP_CMD_ALLOC_ODT_ENTRY, 0, 0, 0, 0, 2})[0], CAN_XCP_PID_RES);
+        ASSERT_EQ(command({CAN_XCP_CMD_SET_DAQ_PTR, 0, 0, 0, 0, 0})[0], CAN_XCP_PID_RES);
+        ASSERT_EQ(command({CAN_XCP_CMD_WRITE_DAQ, 0xFF, 4, 0, 0x00, 0x10, 0, 0})[0], CAN_XCP_PID_RES);
+        ASSERT_EQ(command({CAN_XCP_CMD_WRITE_DAQ, 0xFF, 2, 0, 0x04, 0x20, 0, 0})[0], CAN_XCP_PID_RES);
+        ASSERT_EQ(command({CAN_XCP_CMD_SET_DAQ_LIST_MODE, 0, 0, 0, CAN_XCP_EVENT_LOOP, 0, prescaler, 0})[0],
+                  CAN_XCP_PID_RES);
+    }
+};
+
+TEST_F(CANXcpTest, ConnectAndStatusTest) {
+    EXPECT_TRUE(command({CAN_XCP_CMD_GET_STATUS}).empty());
+    EXPECT_FALSE(canXcp_isConnected());
+
+    std::vector<uint8_t> res = command({CAN_XCP_CMD_CONNECT, 0});
+    ASSERT_EQ(res.size(), 8u);
+    EXPECT_EQ(res[0], CAN_XCP_PID_RES);
+    EXPECT_EQ(res[1], CAN_XCP_RESOURCE_DAQ);
+    EXPECT_EQ(res[3], CAN_XCP_MAX_CTO);
+    EXPECT_TRUE(canXcp_isConnected());
+
+    res = command({CAN_XCP_CMD_GET_STATUS});
+    ASSERT_EQ(res.size(), 6u);
+    EXPECT_EQ(res[1], 0u);
+
+    res = command({0xC0});
+    ASSERT_EQ(res.size(), 2u);
+    EXPECT_EQ(res[0], CAN_XCP_PID_ERR);
+    EXPECT_EQ(res[1], CAN_XCP_ERR_CMD_UNKNOWN);
+
+    EXPECT_EQ(command({CAN_XCP_CMD_DISCONNECT})[0], CAN_XCP_PID_RES);
+    EXPECT_FALSE(canXcp_isConnected());
+    EXPECT_EQ(canXcp_getStats()->errorCount, 1u);
+}
+
+TEST_F(CANXcpTest, UploadDownloadTest) {
+    command({CAN_XCP_CMD_CONNECT, 0});
+
+    std::vector<uint8_t> res = command({CAN_XCP_CMD_SHORT_UPLOAD, 4, 0, 0, 0x00, 0x10, 0, 0});
+    ASSERT_EQ(res.size(), 5u);
+    float value;
+    std::memcpy(&value, &res[1], sizeof(value));
+    EXPECT_FLOAT_EQ(value, 1.5f);
+
+    /* DOWNLOAD writes at the MTA and advances it */
+    float newValue = 3.25f;
+    uint8_t bytes[4];
+    std::memcpy(bytes, &newValue, sizeof(bytes));
+    EXPECT_EQ(command({CAN_XCP_CMD_SET_MTA, 0, 0, 0, 0x00, 0x10, 0, 0})[0], CAN_XCP_PID_RES);
+    EXPECT_EQ(command({CAN_XCP_CMD_DOWNLOAD, 4, bytes[0], bytes[1], bytes[2], bytes[3]})[0], CAN_XCP_PID_RES);
+    EXPECT_EQ(command({CAN_XCP_CMD_DOWNLOAD, 1, 42})[0], CAN_XCP_PID_RES);
+    EXPECT_FLOAT_EQ(calibration.value, 3.25f);
+    EXPECT_EQ(calibration.counter, 42u);
+
+    EXPECT_EQ(command({CAN_XCP_CMD_SET_MTA, 0, 0, 0, 0x00, 0x20, 0, 0})[0], CAN_XCP_PID_RES);
+    res = command({CAN_XCP_CMD_UPLOAD, 4});
+    ASSERT_EQ(res.size(), 5u);
+    std::memcpy(&value, &res[1], sizeof(value));
+    EXPECT_FLOAT_EQ(value, 2.5f);
+
+    res = command({CAN_XCP_CMD_DOWNLOAD, 1, 0});
+    EXPECT_EQ(res[1], CAN_XCP_ERR_WRITE_PROTECTED);
+    res = command({CAN_XCP_CMD_SHORT_UPLOAD, 4, 0, 0, 0x06, 0x10, 0, 0});
+    EXPECT_EQ(res[1], CAN_XCP_ERR_ACCESS_DENIED);
+    res = command({CAN_XCP_CMD_SHORT_UPLOAD, 4, 0, 0, 0x00, 0x30, 0, 0});
+    EXPECT_EQ(res[1], CAN_XCP_ERR_ACCESS_DENIED);
+}
+
+TEST_F(CANXcpTest, DaqListTest) {
+    command({CAN_XCP_CMD_CONNECT, 0});
+    configureDaq(1);
+
+    /* Nothing is sampled until the list runs */
+    canXcp_event(CAN_XCP_EVENT_LOOP);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 0u);
+
+    std::vector<uint8_t> res = command({CAN_XCP_CMD_START_STOP_DAQ_LIST, 1, 0, 0});
+    ASSERT_EQ(res.size(), 2u);
+    EXPECT_EQ(res[1], 0u);
+    EXPECT_TRUE(canXcp_isDaqRunning());
+    EXPECT_EQ(command({CAN_XCP_CMD_GET_STATUS})[1], CAN_XCP_SESSION_DAQ_RUNNING);
+
+    calibration.value = 4.0f;
+    readOnly.counter = 0x1234;
+    canXcp_event(CAN_XCP_EVENT_LOOP);
+    txFrames.clear();
+    canManager_flushTx();
+    ASSERT_EQ(txFrames.size(), 1u);
+    EXPECT_EQ(txFrames[0].id, (uint32_t)CAN_MSG_XCP_DTO);
+    EXPECT_EQ(txFrames[0].dlc, 7u);
+    EXPECT_EQ(txFrames[0].data[0], 0u);
+    float value;
+    std::memcpy(&value, &txFrames[0].data[1], sizeof(value));
+    EXPECT_FLOAT_EQ(value, 4.0f);
+    EXPECT_EQ(txFrames[0].data[5], 0x34u);
+    EXPECT_EQ(txFrames[0].data[6], 0x12u);
+
+    /* Reconfiguration is refused while measuring */
+    EXPECT_EQ(command({CAN_XCP_CMD_ALLOC_DAQ, 0, 1, 0})[1], CAN_XCP_ERR_DAQ_ACTIVE);
+
+    EXPECT_EQ(command({CAN_XCP_CMD_START_STOP_SYNCH, 0})[0], CAN_XCP_PID_RES);
+    EXPECT_FALSE(canXcp_isDaqRunning());
+    canXcp_event(CAN_XCP_EVENT_LOOP);
+    EXPECT_EQ(canManager_getStats()->txQueueDepth, 0u);
+    EXPECT_EQ(canXcp_getStats()->dtoCount, 1u);
+}
+
+TEST_F(CANXcpTest, PrescalerAndSynchTest) {
+    command({CAN_XCP_CMD_CONNECT, 0});
+    configureDaq(3);
+
+    EXPECT_EQ(command({CAN_XCP_CMD_START_STOP_DAQ_LIST, 2, 0, 0})[0], CAN_XCP_PID_RES);
+    EXPECT_FALSE(canXcp_isDaqRunning());
+    EXPECT_EQ(command({CAN_XCP_CMD_START_STOP_SYNCH, 1})[0], CAN_XCP_PID_RES);
+    EXPECT_TRUE(canXcp_isDaqRunning());
+
+    for (int i = 0; i < 9; i++) {
+        canXcp_event(CAN_XCP_EVENT_LOOP);
+    }
+    EXPECT_EQ(canXcp_getStats()->dtoCount, 3u);
+    canManager_flushTx();
+}
+
+TEST_F(CANXcpTest, DaqConfigErrorsTest) {
+    command({CAN_XCP_CMD_CONNECT, 0});
+
+    EXPECT_EQ(command({CAN_XCP_CMD_ALLOC_DAQ, 0, CAN_XCP_DAQ_LISTS + 1, 0})[1], CAN_XCP_ERR_MEMORY_OVERFLOW);
+    EXPECT_EQ(command({CAN_XCP_CMD_ALLOC_DAQ, 0, 1, 0})[0], CAN_XCP_PID_RES);
+    EXPECT_EQ(command({CAN_XCP_CMD_ALLOC_DAQ, 0, 1, 0})[1], CAN_XCP_ERR_SEQUENCE);
+    EXPECT_EQ(command({CAN_XCP_CMD_ALLOC_ODT, 0, 1, 0, 1})[1], CAN_XCP_ERR_OUT_OF_RANGE);
+    EXPECT_EQ(command({CAN_XCP_CMD_ALLOC_ODT, 0, 0, 0, 1})[0], CAN_XCP_PID_RES);
+    EXPECT_EQ(command({CAN_XCP_CMD_ALLOC_ODT_ENTRY, 0, 0, 0, 0, 1})[0], CAN_XCP_PID_RES);
+    EXPECT_EQ(command({CAN_XCP_CMD_WRITE_DAQ, 0xFF, 4, 0, 0x00, 0x10, 0, 0})[1], CAN_XCP_ERR_SEQUENCE);
+    EXPECT_EQ(command({CAN_XCP_CMD_SET_DAQ_PTR, 0, 0, 0, 0, 0})[0], CAN_XCP_PID_RES);
+    EXPECT_EQ(command({CAN_XCP_CMD_WRITE_DAQ, 0xFF, 4, 0, 0x00, 0x50, 0, 0})[1], CAN_XCP_ERR_ACCESS_DENIED);
+    EXPECT_EQ(command({CAN_XCP_CMD_WRITE_DAQ, 0xFF, 4, 0, 0x00, 0x10, 0, 0})[0], CAN_XCP_PID_RES);
+    EXPECT_EQ(command({CAN_XCP_CMD_WRITE_DAQ, 0xFF, 4, 0, 0x00, 0x10, 0, 0})[1], CAN_XCP_ERR_OUT_OF_RANGE);
+    EXPECT_EQ(command({CAN_XCP_CMD_START_STOP_DAQ_LIST, 1, 0, 0})[1], CAN_XCP_ERR_DAQ_CONFIG);
+    EXPECT_EQ(command({CAN_XCP_CMD_SET_DAQ_LIST_MODE, 0, 0, 0, 5, 0, 1, 0})[1], CAN_XCP_ERR_OUT_OF_RANGE);
+}
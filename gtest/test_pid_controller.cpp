@@ -1,16 +1,19 @@
 #include <gtest/gtest.h>
 extern "C" {
     #include "pid_controller.h"
+    #include "time_base.h"
 }
 
 class PIDControllerTest : public ::testing::Test {
 protected:
     void SetUp() override {
+        timeBase_useVirtual(0);
         ASSERT_TRUE(pid_init());
     }
 
     void TearDown() override {
         pid_reset();
+        timeBase_useMonotonic();
     }
 };
 
@@ -132,4 +135,29 @@ TEST_F(PIDControllerTest, ComputeWithVariousInputsTest) {
         EXPECT_GE(output, PID_DEFAULT_OUTPUT_MIN);
         EXPECT_LE(output, PID_DEFAULT_OUTPUT_MAX);
     }
-}
\ No newline at end of file
+}
+
+TEST_F(PIDControllerTest, TimeScalingTest) {
+    pid_setOutputLimits(PID_DEFAULT_OUTPUT_MIN, PID_DEFAULT_OUTPUT_MAX);
+    pid_setGains(0.0f, 1.0f, 0.0f);
+    pid_setSetpoint(100.0f);
+    
+    EXPECT_FLOAT_EQ(pid_compute(90.0f), 10.0f);
+    
+    timeBase_advanceUs(2U * PID_NOMINAL_PERIOD_US);
+    EXPECT_FLOAT_EQ(pid_compute(90.0f), 30.0f);
+    
+    timeBase_advanceUs(PID_NOMINAL_PERIOD_US / 2U);
+    EXPECT_FLOAT_EQ(pid_compute(90.0f), 35.0f);
+}
+
+TEST_F(PIDControllerTest, ZeroIntervalTest) {
+    pid_setOutputLimits(PID_DEFAULT_OUTPUT_MIN, PID_DEFAULT_OUTPUT_MAX);
+    pid_setGains(0.0f, 1.0f, 0.0f);
+    pid_setSetpoint(100.0f);
+    
+    EXPECT_FLOAT_EQ(pid_compute(90.0f), 10.0f);
+    
+    /* A second call without time passing integrates the minimum interval */
+    EXPECT_FLOAT_EQ(pid_compute(90.0f), 10.0f + (10.0f * PID_DT_SCALE_MIN));
+}
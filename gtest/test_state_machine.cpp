@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <string>
 extern "C" {
     #include "state_machine.h"
     #include "temp_sensor.h"
@@ -7,19 +8,22 @@ extern "C" {
     #include "pump_control.h"
     #include "fan_control.h"
     #include "can_manager.h"
+    #include "time_base.h"
 }
 
 class StateMachineTest : public ::testing::Test {
 protected:
     void SetUp() override {
-        canConfig_t canConfig;
+        canConfig_t canConfig = {};
         canConfig.baudrate = 250000;
+        timeBase_useVirtual(0);
         canManager_init(&canConfig);
     }
 
     void TearDown() override {
         pump_enable(false);
         fan_enable(false);
+        timeBase_useMonotonic();
     }
 };
 
@@ -71,6 +75,7 @@ TEST_F(StateMachineTest, CANIntegrationTest) {
     
     for (int i = 0; i < 5; i++) {
         sm_update();
+        canManager_flushTx();
     }
     
     const canStats_t* finalStats = canManager_getStats();
@@ -160,6 +165,42 @@ TEST_F(StateMachineTest, LongRunningOperationTest) {
         }
     }
 }
+
+TEST_F(StateMachineTest, StateTimeTest) {
+    sm_update();
+    smState_t state = sm_getCurrentState();
+    uint32_t before = sm_getStateTimeMs();
+    
+    /* Without an update nothing can transition */
+    timeBase_advanceUs(250000U);
+    EXPECT_EQ(sm_getCurrentState(), state);
+    EXPECT_EQ(sm_getStateTimeMs(), before + 250U);
+    
+    /* An update keeps accumulating unless it transitions */
+    sm_update();
+    EXPECT_EQ(sm_getStateTimeMs(), (sm_getCurrentState() == state) ? (before + 250U) : 0U);
+}
+
+TEST_F(StateMachineTest, StateTimeRestartTest) {
+    /* The state machine cannot be reset, so the first transition out of
+       INIT is checked in a freshly started process */
+    const std::string deathTestStyle = ::testing::GTEST_FLAG(death_test_style);
+    ::testing::GTEST_FLAG(death_test_style) = "threadsafe";
+    EXPECT_EXIT({
+        bool ok = (sm_getCurrentState() == SM_INIT);
+        timeBase_advanceUs(500000U);
+        ok = ok && (sm_getStateTimeMs() == 500U);
+        sm_update();
+        smState_t state = sm_getCurrentState();
+        ok = ok && (state != SM_INIT) && (sm_getStateTimeMs() == 0U);
+        timeBase_advanceUs(100000U);
+        sm_update();
+        ok = ok && (sm_getStateTimeMs() == ((sm_getCurrentState() == state) ? 100U : 0U));
+        exit(ok ? 0 : 1);
+    }, ::testing::ExitedWithCode(0), "");
+    ::testing::GTEST_FLAG(death_test_style) = deathTestStyle;
+}
+
 //Below test do not pass as ignition and level switch is simulated. Also state machine can not reset.
 /*
 TEST_F(StateMachineTest, StateTransitionTest) {
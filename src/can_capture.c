@@ -0,0 +1,435 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "can_capture.h"
+#include "time_base.h"
+#include <stdatomic.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#define CAN_CAPTURE_WRITE_BATCH (64U)
+
+_Static_assert((CAN_CAPTURE_DEPTH & (CAN_CAPTURE_DEPTH - 1U)) == 0U,
+               "CAN_CAPTURE_DEPTH must be a power of two");
+
+static canCaptureRecord_t captureRing[CAN_CAPTURE_DEPTH];
+static atomic_uint captureHead;
+static atomic_uint captureTail;
+static atomic_bool captureActive;
+static atomic_bool writerRunning;
+static atomic_uint recordedCount;
+static atomic_uint droppedCount;
+static atomic_uint writtenCount;
+static atomic_uint writeErrorCount;
+static FILE* captureFile = NULL;
+static pthread_t writerThread;
+
+static void* canCapture_writerMain(void* arg);
+static uint32_t canCapture_drain(void);
+static uint32_t canCapture_encode(const canCaptureRecord_t* record, uint8_t* buffer);
+static void canCapture_sleepUs(uint64_t us);
+
+/*
+ * Open a capture file and start the background writer
+ */
+bool canCapture_start(const char* path)
+{
+    if ((path == NULL) || atomic_load_explicit(&captureActive, memory_order_relaxed)) {
+        return false;
+    }
+
+    captureFile = fopen(path, "wb");
+    if (captureFile == NULL) {
+        return false;
+    }
+
+    if (fwrite(CAN_CAPTURE_MAGIC, 1U, CAN_CAPTURE_HEADER_SIZE, captureFile) != CAN_CAPTURE_HEADER_SIZE) {
+        fclose(captureFile);
+        captureFile = NULL;
+        return false;
+    }
+
+    atomic_store_explicit(&captureHead, 0U, memory_order_relaxed);
+    atomic_store_explicit(&captureTail, 0U, memory_order_relaxed);
+    atomic_store_explicit(&recordedCount, 0U, memory_order_relaxed);
+    atomic_store_explicit(&droppedCount, 0U, memory_order_relaxed);
+    atomic_store_explicit(&writtenCount, 0U, memory_order_relaxed);
+    atomic_store_explicit(&writeErrorCount, 0U, memory_order_relaxed);
+    atomic_store_explicit(&writerRunning, true, memory_order_relaxed);
+
+    if (pthread_create(&writerThread, NULL, canCapture_writerMain, NULL) != 0) {
+        fclose(captureFile);
+        captureFile = NULL;
+        return false;
+    }
+
+    atomic_store_explicit(&captureActive, true, memory_order_release);
+
+    return true;
+}
+
+/*
+ * Stop recording, write out everything still buffered and close the file.
+ * Call from the thread that records frames.
+ */
+void canCapture_stop(void)
+{
+    if (!atomic_load_explicit(&captureActive, memory_order_relaxed)) {
+        return;
+    }
+
+    atomic_store_explicit(&captureActive, false, memory_order_relaxed);
+    atomic_store_explicit(&writerRunning, false, memory_order_release);
+    pthread_join(writerThread, NULL);
+
+    fclose(captureFile);
+    captureFile = NULL;
+}
+
+/*
+ * Whether frames are currently being recorded
+ */
+bool canCapture_isActive(void)
+{
+    return atomic_load_explicit(&captureActive, memory_order_relaxed);
+}
+
+/*
+ * Record one frame. Never blocks: when the writer falls behind the frame
+ * is dropped and counted. Single producer (the CAN manager thread).
+ */
+void canCapture_record(const canFrame_t* frame, bool tx)
+{
+    uint32_t head;
+    canCaptureRecord_t* slot;
+
+    if (!atomic_load_explicit(&captureActive, memory_order_acquire)) {
+        return;
+    }
+
+    head = atomic_load_explicit(&captureHead, memory_order_relaxed);
+    if ((head - atomic_load_explicit(&captureTail, memory_order_acquire)) >= CAN_CAPTURE_DEPTH) {
+        atomic_fetch_add_explicit(&droppedCount, 1U, memory_order_relaxed);
+        return;
+    }
+
+    slot = &captureRing[head & (CAN_CAPTURE_DEPTH - 1U)];
+    slot->frame = *frame;
+    if (slot->frame.timestampUs == 0U) {
+        slot->frame.timestampUs = timeBase_nowUs();
+    }
+    slot->tx = tx;
+
+    atomic_store_explicit(&captureHead, head + 1U, memory_order_release);
+    atomic_fetch_add_explicit(&recordedCount, 1U, memory_order_relaxed);
+}
+
+/*
+ * Get capture statistics
+ */
+canCaptureStats_t canCapture_getStats(void)
+{
+    canCaptureStats_t stats;
+
+    stats.recordedCount = atomic_load_explicit(&recordedCount, memory_order_relaxed);
+    stats.droppedCount = atomic_load_explicit(&droppedCount, memory_order_relaxed);
+    stats.writtenCount = atomic_load_explicit(&writtenCount, memory_order_relaxed);
+    stats.writeErrorCount = atomic_load_explicit(&writeErrorCount, memory_order_relaxed);
+
+    return stats;
+}
+
+/*
+ * Open a capture file for reading and check its header
+ */
+bool canCapture_openReader(canCaptureReader_t* reader, const char* path)
+{
+    char magic[CAN_CAPTURE_HEADER_SIZE];
+
+    if ((reader == NULL) || (path == NULL)) {
+        return false;
+    }
+
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL) {
+        return false;
+    }
+
+    if ((fread(magic, 1U, sizeof(magic), reader->file) != sizeof(magic)) ||
+        (memcmp(magic, CAN_CAPTURE_MAGIC, sizeof(magic)) != 0)) {
+        canCapture_closeReader(reader);
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Read the next record; false at end of file or on a truncated record
+ */
+bool canCapture_readRecord(canCaptureReader_t* reader, canCaptureRecord_t* record)
+{
+    uint8_t header[CAN_CAPTURE_RECORD_SIZE];
+    uint8_t flags;
+    uint8_t length;
+    uint32_t i;
+
+    if ((reader == NULL) || (reader->file == NULL) || (record == NULL)) {
+        return false;
+    }
+
+    if (fread(header, 1U, sizeof(header), reader->file) != sizeof(header)) {
+        return false;
+    }
+
+    memset(record, 0, sizeof(*record));
+    for (i = 0U; i < 8U; i++) {
+        record->frame.timestampUs |= (uint64_t)header[i] << (8U * i);
+    }
+    for (i = 0U; i < 4U; i++) {
+        record->frame.id |= (uint32_t)header[8U + i] << (8U * i);
+    }
+    record->frame.dlc = header[12];
+    flags = header[13];
+    record->frame.extended = (flags & CAN_CAPTURE_FLAG_EXTENDED) != 0U;
+    record->frame.remote = (flags & CAN_CAPTURE_FLAG_REMOTE) != 0U;
+    record->frame.fd = (flags & CAN_CAPTURE_FLAG_FD) != 0U;
+    record->frame.brs = (flags & CAN_CAPTURE_FLAG_BRS) != 0U;
+    record->tx = (flags & CAN_CAPTURE_FLAG_TX) != 0U;
+
+    length = record->frame.remote ? 0U : canManager_frameLength(&record->frame);
+    if ((length > 0U) && (fread(record->frame.data, 1U, length, reader->file) != length)) {
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Close a capture reader
+ */
+void canCapture_closeReader(canCaptureReader_t* reader)
+{
+    if ((reader != NULL) && (reader->file != NULL)) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+}
+
+/*
+ * Convert a binary capture to candump log format, e.g.
+ * "(12.000345) can0 123#DEADBEEF" or "(12.000345) can0 110##1<data>" for FD
+ */
+bool canCapture_exportCandump(const char* capturePath, const char* textPath, const char* interfaceName)
+{
+    canCaptureReader_t reader;
+    canCaptureRecord_t record;
+    FILE* text;
+    bool ok = true;
+
+    if ((textPath == NULL) || !canCapture_openReader(&reader, capturePath)) {
+        return false;
+    }
+
+    text = fopen(textPath, "w");
+    if (text == NULL) {
+        canCapture_closeReader(&reader);
+        return false;
+    }
+
+    if (interfaceName == NULL) {
+        interfaceName = "can0";
+    }
+
+    while (ok && canCapture_readRecord(&reader, &record)) {
+        const canFrame_t* frame = &record.frame;
+        uint8_t length = canManager_frameLength(frame);
+        uint32_t i;
+
+        ok = fprintf(text, "(%llu.%06llu) %s ",
+                     (unsigned long long)(frame->timestampUs / 1000000U),
+                     (unsigned long long)(frame->timestampUs % 1000000U), interfaceName) > 0;
+        ok = ok && (fprintf(text, frame->extended ? "%08X" : "%03X", (unsigned int)frame->id) > 0);
+
+        if (frame->fd) {
+            ok = ok && (fprintf(text, "##%X", frame->brs ? 1U : 0U) > 0);
+        } else if (frame->remote) {
+            ok = ok && (fprintf(text, "#R") > 0);
+            length = 0U;
+            if (frame->dlc > 0U) {
+                ok = ok && (fprintf(text, "%u", (unsigned int)frame->dlc) > 0);
+            }
+        } else {
+            ok = ok && (fputc('#', text) != EOF);
+        }
+
+        for (i = 0U; ok && (i < length); i++) {
+            ok = fprintf(text, "%02X", frame->data[i]) > 0;
+        }
+        ok = ok && (fputc('\n', text) != EOF);
+    }
+
+    canCapture_closeReader(&reader);
+
+    return (fclose(text) == 0) && ok;
+}
+
+/*
+ * Feed the received frames of a capture back through the RX queue and
+ * canManager_processMessages, either with the recorded inter-frame timing
+ * or as fast as possible. Timestamps are cleared so the RX path stamps
+ * frames at replay time and latency/cycle statistics stay meaningful.
+ */
+bool canCapture_replay(const char* path, canReplaySpeed_t speed, bool includeTx, uint32_t* replayed)
+{
+    canCaptureReader_t reader;
+    canCaptureRecord_t record;
+    uint64_t firstTimestamp = 0U;
+    uint64_t startUs = 0U;
+    uint32_t count = 0U;
+    bool first = true;
+
+    if (!canCapture_openReader(&reader, path)) {
+        return false;
+    }
+
+    while (canCapture_readRecord(&reader, &record)) {
+        canStatus_t status;
+
+        if (record.tx && !includeTx) {
+            continue;
+        }
+
+        if (first) {
+            firstTimestamp = record.frame.timestampUs;
+            startUs = timeBase_nowUs();
+            first = false;
+        }
+
+        if (speed == CAN_REPLAY_ORIGINAL_SPEED) {
+            timeBase_sleepUntilUs(startUs + (record.frame.timestampUs - firstTimestamp));
+        }
+
+        record.frame.timestampUs = 0U;
+        status = canManager_enqueueRxFrame(&record.frame);
+        if (status == CAN_STATUS_OVERRUN) {
+            canManager_processMessages();
+            status = canManager_enqueueRxFrame(&record.frame);
+        }
+        if (status == CAN_STATUS_OK) {
+            count++;
+        }
+
+        if (speed == CAN_REPLAY_ORIGINAL_SPEED) {
+            canManager_processMessages();
+        }
+    }
+
+    canManager_processMessages();
+    canCapture_closeReader(&reader);
+
+    if (replayed != NULL) {
+        *replayed = count;
+    }
+
+    return true;
+}
+
+/*
+ * Background writer: drain the ring in batches every write period, then
+ * once more after stop so nothing recorded is lost
+ */
+static void* canCapture_writerMain(void* arg)
+{
+    (void)arg;
+
+    while (atomic_load_explicit(&writerRunning, memory_order_acquire)) {
+        if (canCapture_drain() == 0U) {
+            canCapture_sleepUs((uint64_t)CAN_CAPTURE_WRITE_PERIOD_MS * 1000U);
+        }
+    }
+
+    while (canCapture_drain() > 0U) {
+    }
+    fflush(captureFile);
+
+    return NULL;
+}
+
+/*
+ * Encode and write up to one batch of records, returns records consumed
+ */
+static uint32_t canCapture_drain(void)
+{
+    uint8_t buffer[CAN_CAPTURE_WRITE_BATCH * (CAN_CAPTURE_RECORD_SIZE + CAN_FD_MAX_DATA_LENGTH)];
+    uint32_t tail = atomic_load_explicit(&captureTail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&captureHead, memory_order_acquire);
+    uint32_t count = head - tail;
+    uint32_t size = 0U;
+    uint32_t i;
+
+    if (count > CAN_CAPTURE_WRITE_BATCH) {
+        count = CAN_CAPTURE_WRITE_BATCH;
+    }
+
+    for (i = 0U; i < count; i++) {
+        size += canCapture_encode(&captureRing[(tail + i) & (CAN_CAPTURE_DEPTH - 1U)], &buffer[size]);
+    }
+
+    atomic_store_explicit(&captureTail, tail + count, memory_order_release);
+
+    if (count > 0U) {
+        if (fwrite(buffer, 1U, size, captureFile) == size) {
+            atomic_fetch_add_explicit(&writtenCount, count, memory_order_relaxed);
+        } else {
+            atomic_fetch_add_explicit(&writeErrorCount, 1U, memory_order_relaxed);
+        }
+    }
+
+    return count;
+}
+
+/*
+ * Serialize one record: timestamp (8), ID (4), DLC (1), flags (1), payload,
+ * all little endian. Returns the encoded size.
+ */
+static uint32_t canCapture_encode(const canCaptureRecord_t* record, uint8_t* buffer)
+{
+    const canFrame_t* frame = &record->frame;
+    uint8_t flags = 0U;
+    uint8_t length;
+    uint32_t i;
+
+    for (i = 0U; i < 8U; i++) {
+        buffer[i] = (uint8_t)(frame->timestampUs >> (8U * i));
+    }
+    for (i = 0U; i < 4U; i++) {
+        buffer[8U + i] = (uint8_t)(frame->id >> (8U * i));
+    }
+
+    flags |= frame->extended ? CAN_CAPTURE_FLAG_EXTENDED : 0U;
+    flags |= frame->remote ? CAN_CAPTURE_FLAG_REMOTE : 0U;
+    flags |= frame->fd ? CAN_CAPTURE_FLAG_FD : 0U;
+    flags |= frame->brs ? CAN_CAPTURE_FLAG_BRS : 0U;
+    flags |= record->tx ? CAN_CAPTURE_FLAG_TX : 0U;
+    buffer[12] = frame->dlc;
+    buffer[13] = flags;
+
+    length = frame->remote ? 0U : canManager_frameLength(frame);
+    memcpy(&buffer[CAN_CAPTURE_RECORD_SIZE], frame->data, length);
+
+    return CAN_CAPTURE_RECORD_SIZE + length;
+}
+
+/*
+ * Sleep for a number of microseconds on the real clock (the writer thread
+ * must keep draining even while a virtual time base is active)
+ */
+static void canCapture_sleepUs(uint64_t us)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(us / 1000000U);
+    ts.tv_nsec = (long)((us % 1000000U) * 1000U);
+    nanosleep(&ts, NULL);
+}
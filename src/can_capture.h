@@ -0,0 +1,56 @@
+#ifndef CAN_CAPTURE_H
+#define CAN_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "can_manager.h"
+
+#ifndef CAN_CAPTURE_DEPTH
+#define CAN_CAPTURE_DEPTH           (1024U)
+#endif
+#define CAN_CAPTURE_WRITE_PERIOD_MS (10U)
+
+#define CAN_CAPTURE_MAGIC           "CANCAP01"
+#define CAN_CAPTURE_HEADER_SIZE     (8U)
+#define CAN_CAPTURE_RECORD_SIZE     (14U)
+
+#define CAN_CAPTURE_FLAG_EXTENDED   (0x01U)
+#define CAN_CAPTURE_FLAG_REMOTE     (0x02U)
+#define CAN_CAPTURE_FLAG_FD         (0x04U)
+#define CAN_CAPTURE_FLAG_BRS        (0x08U)
+#define CAN_CAPTURE_FLAG_TX         (0x80U)
+
+typedef struct {
+    canFrame_t frame;
+    bool tx;
+} canCaptureRecord_t;
+
+typedef struct {
+    uint32_t recordedCount;
+    uint32_t droppedCount;
+    uint32_t writtenCount;
+    uint32_t writeErrorCount;
+} canCaptureStats_t;
+
+typedef struct {
+    FILE* file;
+} canCaptureReader_t;
+
+typedef enum {
+    CAN_REPLAY_ORIGINAL_SPEED = 0,
+    CAN_REPLAY_MAX_SPEED
+} canReplaySpeed_t;
+
+bool canCapture_start(const char* path);
+void canCapture_stop(void);
+bool canCapture_isActive(void);
+void canCapture_record(const canFrame_t* frame, bool tx);
+canCaptureStats_t canCapture_getStats(void);
+bool canCapture_openReader(canCaptureReader_t* reader, const char* path);
+bool canCapture_readRecord(canCaptureReader_t* reader, canCaptureRecord_t* record);
+void canCapture_closeReader(canCaptureReader_t* reader);
+bool canCapture_exportCandump(const char* capturePath, const char* textPath, const char* interfaceName);
+bool canCapture_replay(const char* path, canReplaySpeed_t speed, bool includeTx, uint32_t* replayed);
+
+#endif
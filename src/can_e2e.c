@@ -0,0 +1,224 @@
+#include "can_e2e.h"
+#include <stddef.h>
+#include <string.h>
+
+#define CAN_E2E_HEADER_MAX (5U)
+
+static uint8_t crc8Table[CAN_E2E_SLICES][256];
+static uint16_t crc16Table[CAN_E2E_SLICES][256];
+static bool tablesReady = false;
+
+static uint16_t canE2e_compute(const canE2eConfig_t* config, const canFrame_t* frame, uint8_t counterByte);
+
+/*
+ * Build the slicing-by-8 tables: table k holds the CRC of a byte followed
+ * by k zero bytes. Idempotent; call once before channels go multi-threaded.
+ */
+void canE2e_init(void)
+{
+    uint32_t value;
+    uint32_t slice;
+    uint8_t bit;
+
+    if (tablesReady) {
+        return;
+    }
+
+    for (value = 0U; value < 256U; value++) {
+        uint32_t crc8 = value;
+        uint32_t crc16 = value << 8;
+
+        for (bit = 0U; bit < 8U; bit++) {
+            crc8 = ((crc8 & 0x80U) != 0U) ? ((crc8 << 1) ^ CAN_E2E_CRC8_POLY) : (crc8 << 1);
+            crc16 = ((crc16 & 0x8000U) != 0U) ? ((crc16 << 1) ^ CAN_E2E_CRC16_POLY) : (crc16 << 1);
+        }
+        crc8Table[0][value] = (uint8_t)crc8;
+        crc16Table[0][value] = (uint16_t)crc16;
+    }
+
+    for (slice = 1U; slice < CAN_E2E_SLICES; slice++) {
+        for (value = 0U; value < 256U; value++) {
+            uint16_t previous = crc16Table[slice - 1U][value];
+
+            crc8Table[slice][value] = crc8Table[0][crc8Table[slice - 1U][value]];
+            crc16Table[slice][value] = (uint16_t)((previous << 8) ^ crc16Table[0][previous >> 8]);
+        }
+    }
+
+    tablesReady = true;
+}
+
+/*
+ * Update a CRC-8 SAE J1850 register over data, eight bytes per step. Pass
+ * CAN_E2E_CRC8_INIT to start and XOR the result with CAN_E2E_CRC8_XOROUT.
+ */
+uint8_t canE2e_crc8(const uint8_t* data, uint32_t length, uint8_t crc)
+{
+    while (length >= CAN_E2E_SLICES) {
+        crc = (uint8_t)(crc8Table[7][crc ^ data[0]] ^ crc8Table[6][data[1]] ^
+                        crc8Table[5][data[2]] ^ crc8Table[4][data[3]] ^
+                        crc8Table[3][data[4]] ^ crc8Table[2][data[5]] ^
+                        crc8Table[1][data[6]] ^ crc8Table[0][data[7]]);
+        data += CAN_E2E_SLICES;
+        length -= CAN_E2E_SLICES;
+    }
+
+    while (length > 0U) {
+        crc = crc8Table[0][crc ^ *data];
+        data++;
+        length--;
+    }
+
+    return crc;
+}
+
+/*
+ * Update a CRC-16 CCITT-FALSE register over data, eight bytes per step.
+ * Pass CAN_E2E_CRC16_INIT to start.
+ */
+uint16_t canE2e_crc16(const uint8_t* data, uint32_t length, uint16_t crc)
+{
+    while (length >= CAN_E2E_SLICES) {
+        crc ^= (uint16_t)(((uint16_t)data[0] << 8) | data[1]);
+        crc = (uint16_t)(crc16Table[7][crc >> 8] ^ crc16Table[6][crc & 0xFFU] ^
+                         crc16Table[5][data[2]] ^ crc16Table[4][data[3]] ^
+                         crc16Table[3][data[4]] ^ crc16Table[2][data[5]] ^
+                         crc16Table[1][data[6]] ^ crc16Table[0][data[7]]);
+        data += CAN_E2E_SLICES;
+        length -= CAN_E2E_SLICES;
+    }
+
+    while (length > 0U) {
+        crc = (uint16_t)((crc << 8) ^ crc16Table[0][(crc >> 8) ^ *data]);
+        data++;
+        length--;
+    }
+
+    return crc;
+}
+
+/*
+ * Bytes a profile adds after the payload: CRC plus the counter byte
+ */
+uint8_t canE2e_overhead(canE2eProfile_t profile)
+{
+    switch (profile) {
+        case CAN_E2E_PROFILE_CRC8:
+            return 2U;
+
+        case CAN_E2E_PROFILE_CRC16:
+            return 3U;
+
+        case CAN_E2E_PROFILE_NONE:
+        default:
+            return 0U;
+    }
+}
+
+/*
+ * Append CRC and alive counter to a frame carrying exactly dataLength
+ * payload bytes, growing its DLC. Fails if the result does not fit.
+ */
+bool canE2e_protect(const canE2eConfig_t* config, canE2eState_t* state, canFrame_t* frame)
+{
+    uint8_t overhead;
+    uint8_t length;
+    uint8_t frameLength;
+    uint8_t counterIndex;
+    uint16_t crc;
+
+    if ((config == NULL) || (state == NULL) || (frame == NULL) || frame->remote) {
+        return false;
+    }
+
+    overhead = canE2e_overhead(config->profile);
+    length = (uint8_t)(config->dataLength + overhead);
+    if ((overhead == 0U) || (canManager_frameLength(frame) != config->dataLength) ||
+        (length > (frame->fd ? CAN_FD_MAX_DATA_LENGTH : CAN_MAX_DATA_LENGTH))) {
+        return false;
+    }
+
+    frame->dlc = frame->fd ? canManager_lengthToDlc(length) : length;
+    frameLength = canManager_frameLength(frame);
+    memset(&frame->data[config->dataLength], 0, (size_t)(frameLength - config->dataLength));
+
+    counterIndex = (uint8_t)(length - 1U);
+    frame->data[counterIndex] = state->txCounter;
+    state->txCounter = (uint8_t)((state->txCounter + 1U) & CAN_E2E_COUNTER_MASK);
+
+    crc = canE2e_compute(config, frame, frame->data[counterIndex]);
+    frame->data[config->dataLength] = (uint8_t)(crc & 0xFFU);
+    if (config->profile == CAN_E2E_PROFILE_CRC16) {
+        frame->data[config->dataLength + 1U] = (uint8_t)(crc >> 8);
+    }
+
+    return true;
+}
+
+/*
+ * Verify CRC and alive counter of a received frame. The first valid frame
+ * synchronizes the counter; after that a repeated counter is an error and
+ * a jump of more than one is accepted but reported as lost frames.
+ */
+canE2eResult_t canE2e_check(const canE2eConfig_t* config, canE2eState_t* state, const canFrame_t* frame)
+{
+    uint8_t overhead = canE2e_overhead(config->profile);
+    uint8_t counterIndex = (uint8_t)(config->dataLength + overhead - 1U);
+    uint8_t counter;
+    uint8_t delta;
+    uint16_t received;
+
+    if ((overhead == 0U) || frame->remote || (canManager_frameLength(frame) <= counterIndex)) {
+        return CAN_E2E_ERROR_LENGTH;
+    }
+
+    received = frame->data[config->dataLength];
+    if (config->profile == CAN_E2E_PROFILE_CRC16) {
+        received |= (uint16_t)((uint16_t)frame->data[config->dataLength + 1U] << 8);
+    }
+    if (canE2e_compute(config, frame, frame->data[counterIndex]) != received) {
+        return CAN_E2E_ERROR_CRC;
+    }
+
+    counter = frame->data[counterIndex] & CAN_E2E_COUNTER_MASK;
+    if (!state->rxSynced) {
+        state->rxSynced = true;
+        state->rxCounter = counter;
+        return CAN_E2E_OK;
+    }
+
+    delta = (uint8_t)((counter - state->rxCounter) & CAN_E2E_COUNTER_MASK);
+    if (delta == 0U) {
+        return CAN_E2E_ERROR_REPEATED;
+    }
+    state->rxCounter = counter;
+
+    return (delta == 1U) ? CAN_E2E_OK : CAN_E2E_OK_LOST;
+}
+
+/*
+ * CRC over the message ID (little endian, 2 or 4 bytes), the counter byte
+ * and the payload, so a frame replayed under another ID fails the check
+ */
+static uint16_t canE2e_compute(const canE2eConfig_t* config, const canFrame_t* frame, uint8_t counterByte)
+{
+    uint8_t buffer[CAN_E2E_HEADER_MAX + CAN_FD_MAX_DATA_LENGTH];
+    uint32_t length = 0U;
+
+    /* One contiguous buffer keeps short classic payloads on the sliced path */
+    buffer[length++] = (uint8_t)(frame->id & 0xFFU);
+    buffer[length++] = (uint8_t)((frame->id >> 8) & 0xFFU);
+    if (frame->extended) {
+        buffer[length++] = (uint8_t)((frame->id >> 16) & 0xFFU);
+        buffer[length++] = (uint8_t)((frame->id >> 24) & 0xFFU);
+    }
+    buffer[length++] = counterByte;
+    memcpy(&buffer[length], frame->data, config->dataLength);
+    length += config->dataLength;
+
+    if (config->profile == CAN_E2E_PROFILE_CRC16) {
+        return canE2e_crc16(buffer, length, CAN_E2E_CRC16_INIT);
+    }
+
+    return (uint8_t)(canE2e_crc8(buffer, length, CAN_E2E_CRC8_INIT) ^ CAN_E2E_CRC8_XOROUT);
+}
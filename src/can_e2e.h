@@ -0,0 +1,62 @@
+#ifndef CAN_E2E_H
+#define CAN_E2E_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_manager.h"
+
+#ifndef CAN_E2E_ENTRIES
+#define CAN_E2E_ENTRIES             (8U)
+#endif
+#define CAN_E2E_SLICES              (8U)
+#define CAN_E2E_COUNTER_MASK        (0x0FU)
+
+/* CRC-8 SAE J1850: poly 0x1D, init 0xFF, xorout 0xFF */
+#define CAN_E2E_CRC8_POLY           (0x1DU)
+#define CAN_E2E_CRC8_INIT           (0xFFU)
+#define CAN_E2E_CRC8_XOROUT         (0xFFU)
+
+/* CRC-16 CCITT-FALSE: poly 0x1021, init 0xFFFF, no xorout */
+#define CAN_E2E_CRC16_POLY          (0x1021U)
+#define CAN_E2E_CRC16_INIT          (0xFFFFU)
+
+typedef enum {
+    CAN_E2E_PROFILE_NONE = 0,
+    CAN_E2E_PROFILE_CRC8,
+    CAN_E2E_PROFILE_CRC16
+} canE2eProfile_t;
+
+typedef enum {
+    CAN_E2E_OK = 0,
+    CAN_E2E_OK_LOST,
+    CAN_E2E_ERROR_LENGTH,
+    CAN_E2E_ERROR_CRC,
+    CAN_E2E_ERROR_REPEATED
+} canE2eResult_t;
+
+/*
+ * Protected frame layout: dataLength payload bytes, then the CRC (little
+ * endian for CRC-16), then one byte carrying the alive counter in its low
+ * nibble. The CRC covers the message ID, the counter byte and the payload.
+ */
+struct canE2eConfig {
+    uint32_t id;
+    bool extended;
+    canE2eProfile_t profile;
+    uint8_t dataLength;
+};
+
+typedef struct {
+    uint8_t txCounter;
+    uint8_t rxCounter;
+    bool rxSynced;
+} canE2eState_t;
+
+void canE2e_init(void);
+uint8_t canE2e_crc8(const uint8_t* data, uint32_t length, uint8_t crc);
+uint16_t canE2e_crc16(const uint8_t* data, uint32_t length, uint16_t crc);
+uint8_t canE2e_overhead(canE2eProfile_t profile);
+bool canE2e_protect(const canE2eConfig_t* config, canE2eState_t* state, canFrame_t* frame);
+canE2eResult_t canE2e_check(const canE2eConfig_t* config, canE2eState_t* state, const canFrame_t* frame);
+
+#endif
@@ -0,0 +1,170 @@
+#include "can_gateway.h"
+#include "time_base.h"
+#include <stddef.h>
+#include <string.h>
+
+_Static_assert(CAN_GATEWAY_ROUTES < 0xFFU, "CAN_GATEWAY_ROUTES must fit in uint8_t");
+
+typedef struct {
+    bool active;
+    canGatewayRoute_t route;
+    canGatewayRouteStats_t stats;
+    bool forwarded;
+    uint64_t lastForwardUs;
+} canGatewayRouteState_t;
+
+static canGatewayRouteState_t routes[CAN_GATEWAY_ROUTES];
+static uint8_t sourceRoutes[CAN_CHANNELS_MAX][CAN_GATEWAY_ROUTES];
+static uint8_t sourceRouteCount[CAN_CHANNELS_MAX];
+
+static void canGateway_rebuild(void);
+static void canGateway_routeFrame(canChannel_t* channel, const canFrame_t* frame);
+static void canGateway_forward(canGatewayRouteState_t* state, const canFrame_t* frame, uint64_t now);
+
+/*
+ * Remove all routes and detach the gateway from every channel
+ */
+void canGateway_init(void)
+{
+    memset(routes, 0, sizeof(routes));
+    canGateway_rebuild();
+}
+
+/*
+ * Configure one route (NULL removes it). Frames accepted on the source
+ * channel whose ID matches ((id ^ match.id) & match.mask) == 0 are sent on
+ * the destination channel, optionally under a new ID and at most once per
+ * minIntervalUs. Routes attach to the channels' RX path, so set them after
+ * canChannel_init; bridged channels must be served from the same thread.
+ */
+bool canGateway_setRoute(uint8_t index, const canGatewayRoute_t* route)
+{
+    if (index >= CAN_GATEWAY_ROUTES) {
+        return false;
+    }
+
+    if (route == NULL) {
+        routes[index].active = false;
+    } else {
+        uint32_t idMask = route->match.extended ? CAN_EXT_ID_MASK : (CAN_STD_ID_COUNT - 1U);
+        uint32_t rewriteMask = route->rewriteExtended ? CAN_EXT_ID_MASK : (CAN_STD_ID_COUNT - 1U);
+
+        if ((route->source >= CAN_CHANNELS_MAX) || (route->destination >= CAN_CHANNELS_MAX) ||
+            (route->source == route->destination) || ((route->match.id & ~idMask) != 0U) ||
+            (route->rewrite && ((route->rewriteId & ~rewriteMask) != 0U))) {
+            return false;
+        }
+        memset(&routes[index], 0, sizeof(routes[index]));
+        routes[index].route = *route;
+        routes[index].route.match.mask &= idMask;
+        routes[index].active = true;
+    }
+
+    canGateway_rebuild();
+
+    return true;
+}
+
+/*
+ * Counters of one route
+ */
+const canGatewayRouteStats_t* canGateway_getRouteStats(uint8_t index)
+{
+    canGatewayRouteStats_t* stats;
+
+    if (index >= CAN_GATEWAY_ROUTES) {
+        return NULL;
+    }
+
+    stats = &routes[index].stats;
+    stats->latencyAvgUs = (stats->forwardedCount > 0U) ?
+        (uint32_t)(stats->latencyTotalUs / stats->forwardedCount) : 0U;
+
+    return stats;
+}
+
+/*
+ * Group the active routes by source channel and hook the gateway into the
+ * RX path of every channel that is a source
+ */
+static void canGateway_rebuild(void)
+{
+    uint8_t source;
+    uint8_t i;
+
+    memset(sourceRouteCount, 0, sizeof(sourceRouteCount));
+
+    for (i = 0U; i < CAN_GATEWAY_ROUTES; i++) {
+        if (routes[i].active) {
+            source = routes[i].route.source;
+            sourceRoutes[source][sourceRouteCount[source]] = i;
+            sourceRouteCount[source]++;
+        }
+    }
+
+    for (source = 0U; source < CAN_CHANNELS_MAX; source++) {
+        canChannel_setRouter(canChannel_get(source),
+                             (sourceRouteCount[source] > 0U) ? canGateway_routeFrame : NULL);
+    }
+}
+
+/*
+ * RX router: forward a frame on every matching route of its channel
+ */
+static void canGateway_routeFrame(canChannel_t* channel, const canFrame_t* frame)
+{
+    uint8_t source = canChannel_getIndex(channel);
+    uint64_t now = 0U;
+    uint8_t i;
+
+    for (i = 0U; i < sourceRouteCount[source]; i++) {
+        canGatewayRouteState_t* state = &routes[sourceRoutes[source][i]];
+        const canFilter_t* match = &state->route.match;
+
+        if ((frame->extended == match->extended) && (((frame->id ^ match->id) & match->mask) == 0U)) {
+            if (now == 0U) {
+                now = timeBase_nowUs();
+            }
+            canGateway_forward(state, frame, now);
+        }
+    }
+}
+
+/*
+ * Send a frame on a route's destination, subject to its rate limit. Frames
+ * are forwarded in place unless the ID is rewritten.
+ */
+static void canGateway_forward(canGatewayRouteState_t* state, const canFrame_t* frame, uint64_t now)
+{
+    const canGatewayRoute_t* route = &state->route;
+    canGatewayRouteStats_t* stats = &state->stats;
+    canFrame_t rewritten;
+    uint64_t latency;
+
+    if ((route->minIntervalUs > 0U) && state->forwarded &&
+        ((now - state->lastForwardUs) < route->minIntervalUs)) {
+        stats->rateLimitedCount++;
+        return;
+    }
+
+    if (route->rewrite) {
+        rewritten = *frame;
+        rewritten.id = route->rewriteId;
+        rewritten.extended = route->rewriteExtended;
+        frame = &rewritten;
+    }
+
+    if (canChannel_sendFrame(canChannel_get(route->destination), frame) != CAN_STATUS_OK) {
+        stats->droppedCount++;
+        return;
+    }
+
+    state->forwarded = true;
+    state->lastForwardUs = now;
+    latency = (now > frame->timestampUs) ? (now - frame->timestampUs) : 0U;
+    stats->forwardedCount++;
+    stats->latencyTotalUs += latency;
+    if (latency > stats->latencyMaxUs) {
+        stats->latencyMaxUs = (uint32_t)latency;
+    }
+}
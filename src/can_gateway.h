@@ -0,0 +1,35 @@
+#ifndef CAN_GATEWAY_H
+#define CAN_GATEWAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_manager.h"
+
+#ifndef CAN_GATEWAY_ROUTES
+#define CAN_GATEWAY_ROUTES          (16U)
+#endif
+
+typedef struct {
+    uint8_t source;
+    uint8_t destination;
+    canFilter_t match;
+    bool rewrite;
+    uint32_t rewriteId;
+    bool rewriteExtended;
+    uint32_t minIntervalUs;
+} canGatewayRoute_t;
+
+typedef struct {
+    uint32_t forwardedCount;
+    uint32_t rateLimitedCount;
+    uint32_t droppedCount;
+    uint32_t latencyAvgUs;
+    uint32_t latencyMaxUs;
+    uint64_t latencyTotalUs;
+} canGatewayRouteStats_t;
+
+void canGateway_init(void);
+bool canGateway_setRoute(uint8_t index, const canGatewayRoute_t* route);
+const canGatewayRouteStats_t* canGateway_getRouteStats(uint8_t index);
+
+#endif
@@ -0,0 +1,526 @@
+#include "can_isotp.h"
+#include "time_base.h"
+#include <stddef.h>
+#include <string.h>
+
+typedef enum {
+    CAN_ISOTP_TX_IDLE = 0,
+    CAN_ISOTP_TX_WAIT_FC,
+    CAN_ISOTP_TX_SENDING
+} canIsotpTxState_t;
+
+typedef enum {
+    CAN_ISOTP_RX_IDLE = 0,
+    CAN_ISOTP_RX_RECEIVING
+} canIsotpRxState_t;
+
+typedef struct {
+    bool open;
+    canIsotpConfig_t config;
+    canIsotpStats_t stats;
+
+    canIsotpTxState_t txState;
+    uint8_t txBuffer[CAN_ISOTP_MAX_PAYLOAD];
+    uint32_t txLength;
+    uint32_t txOffset;
+    uint8_t txSequence;
+    uint8_t txBlockSize;
+    uint8_t txBlockCount;
+    uint8_t txWaitCount;
+    uint32_t txStMinUs;
+    uint64_t txNextUs;
+    uint64_t txDeadlineUs;
+
+    canIsotpRxState_t rxState;
+    uint8_t rxBuffer[CAN_ISOTP_MAX_PAYLOAD];
+    uint32_t rxLength;
+    uint32_t rxOffset;
+    uint8_t rxSequence;
+    uint8_t rxBlockCount;
+    uint64_t rxDeadlineUs;
+} canIsotpChannel_t;
+
+static canIsotpChannel_t channels[CAN_ISOTP_CHANNELS];
+
+static canIsotpChannel_t* canIsotp_findChannel(const canFrame_t* frame);
+static canStatus_t canIsotp_sendFrame(canIsotpChannel_t* channel, const uint8_t* data, uint8_t length);
+static canStatus_t canIsotp_sendFlowControl(canIsotpChannel_t* channel, uint8_t flowStatus);
+static void canIsotp_rxHandler(const canFrame_t* frame);
+static void canIsotp_rxSingle(canIsotpChannel_t* channel, const uint8_t* data, uint8_t length);
+static void canIsotp_rxFirst(canIsotpChannel_t* channel, const uint8_t* data, uint8_t length);
+static void canIsotp_rxConsecutive(canIsotpChannel_t* channel, const uint8_t* data, uint8_t length);
+static void canIsotp_rxFlowControl(canIsotpChannel_t* channel, const uint8_t* data, uint8_t length);
+static void canIsotp_pollChannel(canIsotpChannel_t* channel, uint64_t now);
+static void canIsotp_deliver(canIsotpChannel_t* channel, const uint8_t* data, uint32_t length);
+
+/*
+ * Open an ISO-TP channel on a pair of CAN IDs. The receive ID is routed
+ * through the CAN manager's handler table, so channels must be (re)opened
+ * after canManager_init.
+ */
+bool canIsotp_open(uint8_t channel, const canIsotpConfig_t* config)
+{
+    uint8_t i;
+
+    if ((channel >= CAN_ISOTP_CHANNELS) || (config == NULL)) {
+        return false;
+    }
+
+    for (i = 0U; i < CAN_ISOTP_CHANNELS; i++) {
+        if ((i != channel) && channels[i].open && (channels[i].config.rxId == config->rxId) &&
+            (channels[i].config.extended == config->extended)) {
+            return false;
+        }
+    }
+
+    canIsotp_close(channel);
+
+    if (!canManager_registerHandler(config->rxId, config->extended, canIsotp_rxHandler)) {
+        return false;
+    }
+
+    channels[channel].config = *config;
+    channels[channel].open = true;
+
+    return true;
+}
+
+/*
+ * Close a channel, dropping any transfer in progress
+ */
+void canIsotp_close(uint8_t channel)
+{
+    if (channel >= CAN_ISOTP_CHANNELS) {
+        return;
+    }
+
+    if (channels[channel].open) {
+        canManager_unregisterHandler(channels[channel].config.rxId, channels[channel].config.extended);
+    }
+
+    memset(&channels[channel], 0, sizeof(channels[channel]));
+}
+
+/*
+ * Start sending a message. Up to 7 bytes go out as a single frame; longer
+ * messages send a first frame and continue from canIsotp_poll once the
+ * receiver's flow control arrives.
+ */
+canStatus_t canIsotp_send(uint8_t channel, const uint8_t* data, uint32_t length)
+{
+    canIsotpChannel_t* isotp;
+    uint8_t frame[CAN_MAX_DATA_LENGTH];
+    canStatus_t status;
+
+    if ((channel >= CAN_ISOTP_CHANNELS) || (data == NULL) || (length == 0U) ||
+        (length > CAN_ISOTP_MAX_PAYLOAD)) {
+        return CAN_STATUS_ERROR;
+    }
+
+    isotp = &channels[channel];
+    if (!isotp->open || (isotp->txState != CAN_ISOTP_TX_IDLE)) {
+        return CAN_STATUS_ERROR;
+    }
+
+    if (length <= CAN_ISOTP_SF_MAX) {
+        frame[0] = (uint8_t)((CAN_ISOTP_PCI_SF << 4) | length);
+        memcpy(&frame[1], data, length);
+
+        status = canIsotp_sendFrame(isotp, frame, (uint8_t)(length + 1U));
+        if (status == CAN_STATUS_OK) {
+            isotp->stats.txMessages++;
+        }
+        return status;
+    }
+
+    frame[0] = (uint8_t)((CAN_ISOTP_PCI_FF << 4) | (length >> 8));
+    frame[1] = (uint8_t)(length & 0xFFU);
+    memcpy(&frame[2], data, CAN_ISOTP_FF_DATA);
+
+    status = canIsotp_sendFrame(isotp, frame, CAN_MAX_DATA_LENGTH);
+    if (status != CAN_STATUS_OK) {
+        return status;
+    }
+
+    memcpy(isotp->txBuffer, data, length);
+    isotp->txLength = length;
+    isotp->txOffset = CAN_ISOTP_FF_DATA;
+    isotp->txSequence = 1U;
+    isotp->txWaitCount = 0U;
+    isotp->txDeadlineUs = timeBase_nowUs() + ((uint64_t)CAN_ISOTP_TIMEOUT_BS_MS * 1000U);
+    isotp->txState = CAN_ISOTP_TX_WAIT_FC;
+
+    return CAN_STATUS_OK;
+}
+
+/*
+ * Whether a multi-frame transmission is still in progress
+ */
+bool canIsotp_txBusy(uint8_t channel)
+{
+    return (channel < CAN_ISOTP_CHANNELS) && (channels[channel].txState != CAN_ISOTP_TX_IDLE);
+}
+
+/*
+ * Whether a multi-frame reception is still in progress
+ */
+bool canIsotp_rxBusy(uint8_t channel)
+{
+    return (channel < CAN_ISOTP_CHANNELS) && (channels[channel].rxState != CAN_ISOTP_RX_IDLE);
+}
+
+/*
+ * Send due consecutive frames and expire N_Bs / N_Cr timeouts.
+ * Call once per main loop after canManager_processMessages.
+ */
+void canIsotp_poll(void)
+{
+    uint64_t now = timeBase_nowUs();
+    uint8_t i;
+
+    for (i = 0U; i < CAN_ISOTP_CHANNELS; i++) {
+        if (channels[i].open) {
+            canIsotp_pollChannel(&channels[i], now);
+        }
+    }
+}
+
+/*
+ * Get channel statistics
+ */
+const canIsotpStats_t* canIsotp_getStats(uint8_t channel)
+{
+    if (channel >= CAN_ISOTP_CHANNELS) {
+        return NULL;
+    }
+
+    return &channels[channel].stats;
+}
+
+/*
+ * Decode the STmin byte of a flow control frame: 0-127 ms, or 100-900 us
+ * for 0xF1-0xF9. Reserved values mean the maximum of 127 ms.
+ */
+uint32_t canIsotp_stMinToUs(uint8_t stMin)
+{
+    if (stMin <= 0x7FU) {
+        return (uint32_t)stMin * 1000U;
+    }
+
+    if ((stMin >= 0xF1U) && (stMin <= 0xF9U)) {
+        return (uint32_t)(stMin - 0xF0U) * 100U;
+    }
+
+    return 127U * 1000U;
+}
+
+/*
+ * Channel whose receive ID matches the frame
+ */
+static canIsotpChannel_t* canIsotp_findChannel(const canFrame_t* frame)
+{
+    uint8_t i;
+
+    for (i = 0U; i < CAN_ISOTP_CHANNELS; i++) {
+        if (channels[i].open && (channels[i].config.rxId == frame->id) &&
+            (channels[i].config.extended == frame->extended)) {
+            return &channels[i];
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Send one classic CAN frame on the channel's transmit ID, padded to
+ * 8 bytes when the channel uses padding
+ */
+static canStatus_t canIsotp_sendFrame(canIsotpChannel_t* channel, const uint8_t* data, uint8_t length)
+{
+    canFrame_t frame = {0};
+    canStatus_t status;
+
+    frame.id = channel->config.txId;
+    frame.extended = channel->config.extended;
+    frame.dlc = channel->config.padding ? CAN_MAX_DATA_LENGTH : length;
+    memset(frame.data, CAN_ISOTP_PADDING, CAN_MAX_DATA_LENGTH);
+    memcpy(frame.data, data, length);
+
+    status = canManager_sendFrame(&frame);
+    if (status == CAN_STATUS_OK) {
+        channel->stats.txFrames++;
+    }
+
+    return status;
+}
+
+/*
+ * Send a flow control frame with this channel's block size and STmin
+ */
+static canStatus_t canIsotp_sendFlowControl(canIsotpChannel_t* channel, uint8_t flowStatus)
+{
+    uint8_t data[3];
+
+    data[0] = (uint8_t)((CAN_ISOTP_PCI_FC << 4) | flowStatus);
+    data[1] = channel->config.blockSize;
+    data[2] = channel->config.stMin;
+
+    return canIsotp_sendFrame(channel, data, 3U);
+}
+
+/*
+ * CAN manager handler for every open channel's receive ID
+ */
+static void canIsotp_rxHandler(const canFrame_t* frame)
+{
+    canIsotpChannel_t* channel = canIsotp_findChannel(frame);
+    uint8_t length = canManager_frameLength(frame);
+
+    if ((channel == NULL) || (length == 0U) || frame->remote) {
+        return;
+    }
+
+    channel->stats.rxFrames++;
+
+    switch (frame->data[0] >> 4) {
+        case CAN_ISOTP_PCI_SF:
+            canIsotp_rxSingle(channel, frame->data, length);
+            break;
+        case CAN_ISOTP_PCI_FF:
+            canIsotp_rxFirst(channel, frame->data, length);
+            break;
+        case CAN_ISOTP_PCI_CF:
+            canIsotp_rxConsecutive(channel, frame->data, length);
+            break;
+        case CAN_ISOTP_PCI_FC:
+            canIsotp_rxFlowControl(channel, frame->data, length);
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * Single frame: deliver directly. A reception in progress is abandoned.
+ */
+static void canIsotp_rxSingle(canIsotpChannel_t* channel, const uint8_t* data, uint8_t length)
+{
+    uint8_t messageLength = data[0] & 0x0FU;
+
+    if ((messageLength == 0U) || (messageLength > CAN_ISOTP_SF_MAX) || (messageLength >= length)) {
+        return;
+    }
+
+    if (channel->rxState != CAN_ISOTP_RX_IDLE) {
+        channel->stats.abortCount++;
+        channel->rxState = CAN_ISOTP_RX_IDLE;
+    }
+
+    canIsotp_deliver(channel, &data[1], messageLength);
+}
+
+/*
+ * First frame: start reassembly and grant the sender a first block, or
+ * refuse with an overflow flow control if the message cannot be buffered.
+ * The 32-bit length escape is only valid for messages over 4095 bytes; an
+ * escaped first frame announcing less is ignored (ISO 15765-2).
+ */
+static void canIsotp_rxFirst(canIsotpChannel_t* channel, const uint8_t* data, uint8_t length)
+{
+    uint32_t messageLength = ((uint32_t)(data[0] & 0x0FU) << 8) | data[1];
+    uint32_t dataOffset = 2U;
+
+    if (length < CAN_MAX_DATA_LENGTH) {
+        return;
+    }
+
+    if (messageLength == 0U) {
+        messageLength = ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) |
+                        ((uint32_t)data[4] << 8) | data[5];
+        if (messageLength <= 0xFFFU) {
+            return;
+        }
+        dataOffset = 6U;
+    } else if (messageLength <= CAN_ISOTP_SF_MAX) {
+        return;
+    }
+
+    if (channel->rxState != CAN_ISOTP_RX_IDLE) {
+        channel->stats.abortCount++;
+        channel->rxState = CAN_ISOTP_RX_IDLE;
+    }
+
+    if (messageLength > CAN_ISOTP_MAX_PAYLOAD) {
+        channel->stats.overflowCount++;
+        (void)canIsotp_sendFlowControl(channel, CAN_ISOTP_FS_OVERFLOW);
+        return;
+    }
+
+    memcpy(channel->rxBuffer, &data[dataOffset], CAN_MAX_DATA_LENGTH - dataOffset);
+    channel->rxLength = messageLength;
+    channel->rxOffset = CAN_MAX_DATA_LENGTH - dataOffset;
+    channel->rxSequence = 1U;
+    channel->rxBlockCount = 0U;
+    channel->rxDeadlineUs = timeBase_nowUs() + ((uint64_t)CAN_ISOTP_TIMEOUT_CR_MS * 1000U);
+    channel->rxState = CAN_ISOTP_RX_RECEIVING;
+
+    (void)canIsotp_sendFlowControl(channel, CAN_ISOTP_FS_CTS);
+}
+
+/*
+ * Consecutive frame: append in sequence, ask for the next block when this
+ * one is complete and deliver the message after the last byte
+ */
+static void canIsotp_rxConsecutive(canIsotpChannel_t* channel, const uint8_t* data, uint8_t length)
+{
+    uint32_t remaining;
+    uint32_t count;
+
+    if (channel->rxState != CAN_ISOTP_RX_RECEIVING) {
+        return;
+    }
+
+    if ((data[0] & 0x0FU) != channel->rxSequence) {
+        channel->stats.sequenceErrors++;
+        channel->rxState = CAN_ISOTP_RX_IDLE;
+        return;
+    }
+
+    remaining = channel->rxLength - channel->rxOffset;
+    count = (remaining < CAN_ISOTP_CF_DATA) ? remaining : CAN_ISOTP_CF_DATA;
+    if (count > (uint32_t)(length - 1U)) {
+        channel->stats.abortCount++;
+        channel->rxState = CAN_ISOTP_RX_IDLE;
+        return;
+    }
+
+    memcpy(&channel->rxBuffer[channel->rxOffset], &data[1], count);
+    channel->rxOffset += count;
+    channel->rxSequence = (uint8_t)((channel->rxSequence + 1U) & 0x0FU);
+
+    if (channel->rxOffset >= channel->rxLength) {
+        channel->rxState = CAN_ISOTP_RX_IDLE;
+        canIsotp_deliver(channel, channel->rxBuffer, channel->rxLength);
+        return;
+    }
+
+    channel->rxDeadlineUs = timeBase_nowUs() + ((uint64_t)CAN_ISOTP_TIMEOUT_CR_MS * 1000U);
+
+    if (channel->config.blockSize != 0U) {
+        channel->rxBlockCount++;
+        if (channel->rxBlockCount >= channel->config.blockSize) {
+            channel->rxBlockCount = 0U;
+            (void)canIsotp_sendFlowControl(channel, CAN_ISOTP_FS_CTS);
+        }
+    }
+}
+
+/*
+ * Flow control from the receiver of our transmission
+ */
+static void canIsotp_rxFlowControl(canIsotpChannel_t* channel, const uint8_t* data, uint8_t length)
+{
+    uint64_t now;
+
+    if ((channel->txState != CAN_ISOTP_TX_WAIT_FC) || (length < 3U)) {
+        return;
+    }
+
+    now = timeBase_nowUs();
+
+    switch (data[0] & 0x0FU) {
+        case CAN_ISOTP_FS_CTS:
+            channel->txBlockSize = data[1];
+            channel->txBlockCount = 0U;
+            channel->txStMinUs = canIsotp_stMinToUs(data[2]);
+            channel->txNextUs = now;
+            channel->txState = CAN_ISOTP_TX_SENDING;
+            canIsotp_pollChannel(channel, now);
+            break;
+        case CAN_ISOTP_FS_WAIT:
+            channel->stats.flowControlWaits++;
+            channel->txWaitCount++;
+            if (channel->txWaitCount > CAN_ISOTP_WAIT_MAX) {
+                channel->stats.abortCount++;
+                channel->txState = CAN_ISOTP_TX_IDLE;
+            } else {
+                channel->txDeadlineUs = now + ((uint64_t)CAN_ISOTP_TIMEOUT_BS_MS * 1000U);
+            }
+            break;
+        case CAN_ISOTP_FS_OVERFLOW:
+            channel->stats.overflowCount++;
+            channel->stats.abortCount++;
+            channel->txState = CAN_ISOTP_TX_IDLE;
+            break;
+        default:
+            channel->stats.abortCount++;
+            channel->txState = CAN_ISOTP_TX_IDLE;
+            break;
+    }
+}
+
+/*
+ * Advance one channel: send consecutive frames while STmin allows and the
+ * block is open, and expire the flow control and consecutive frame timers.
+ * A frame the CAN manager refuses is retried on the next poll.
+ */
+static void canIsotp_pollChannel(canIsotpChannel_t* channel, uint64_t now)
+{
+    uint8_t data[CAN_MAX_DATA_LENGTH];
+
+    while ((channel->txState == CAN_ISOTP_TX_SENDING) && (now >= channel->txNextUs)) {
+        uint32_t remaining = channel->txLength - channel->txOffset;
+        uint32_t count = (remaining < CAN_ISOTP_CF_DATA) ? remaining : CAN_ISOTP_CF_DATA;
+
+        data[0] = (uint8_t)((CAN_ISOTP_PCI_CF << 4) | channel->txSequence);
+        memcpy(&data[1], &channel->txBuffer[channel->txOffset], count);
+        if (canIsotp_sendFrame(channel, data, (uint8_t)(count + 1U)) != CAN_STATUS_OK) {
+            break;
+        }
+
+        channel->txOffset += count;
+        channel->txSequence = (uint8_t)((channel->txSequence + 1U) & 0x0FU);
+
+        if (channel->txOffset >= channel->txLength) {
+            channel->stats.txMessages++;
+            channel->txState = CAN_ISOTP_TX_IDLE;
+            break;
+        }
+
+        if (channel->txBlockSize != 0U) {
+            channel->txBlockCount++;
+            if (channel->txBlockCount >= channel->txBlockSize) {
+                channel->txWaitCount = 0U;
+                channel->txDeadlineUs = now + ((uint64_t)CAN_ISOTP_TIMEOUT_BS_MS * 1000U);
+                channel->txState = CAN_ISOTP_TX_WAIT_FC;
+                break;
+            }
+        }
+
+        channel->txNextUs = now + channel->txStMinUs;
+    }
+
+    if ((channel->txState == CAN_ISOTP_TX_WAIT_FC) && (now > channel->txDeadlineUs)) {
+        channel->stats.timeoutCount++;
+        channel->txState = CAN_ISOTP_TX_IDLE;
+    }
+
+    if ((channel->rxState == CAN_ISOTP_RX_RECEIVING) && (now > channel->rxDeadlineUs)) {
+        channel->stats.timeoutCount++;
+        channel->rxState = CAN_ISOTP_RX_IDLE;
+    }
+}
+
+/*
+ * Hand a complete message to the channel's callback
+ */
+static void canIsotp_deliver(canIsotpChannel_t* channel, const uint8_t* data, uint32_t length)
+{
+    uint8_t index = (uint8_t)(channel - channels);
+
+    channel->stats.rxMessages++;
+
+    if (channel->config.rxCallback != NULL) {
+        channel->config.rxCallback(index, data, length);
+    }
+}
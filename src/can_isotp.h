@@ -0,0 +1,63 @@
+#ifndef CAN_ISOTP_H
+#define CAN_ISOTP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_manager.h"
+
+#ifndef CAN_ISOTP_CHANNELS
+#define CAN_ISOTP_CHANNELS          (4U)
+#endif
+#define CAN_ISOTP_MAX_PAYLOAD       (4095U)
+#define CAN_ISOTP_SF_MAX            (7U)
+#define CAN_ISOTP_FF_DATA           (6U)
+#define CAN_ISOTP_CF_DATA           (7U)
+#define CAN_ISOTP_PADDING           (0xCCU)
+
+#define CAN_ISOTP_TIMEOUT_BS_MS     (1000U)
+#define CAN_ISOTP_TIMEOUT_CR_MS     (1000U)
+#define CAN_ISOTP_WAIT_MAX          (10U)
+
+#define CAN_ISOTP_PCI_SF            (0x0U)
+#define CAN_ISOTP_PCI_FF            (0x1U)
+#define CAN_ISOTP_PCI_CF            (0x2U)
+#define CAN_ISOTP_PCI_FC            (0x3U)
+
+#define CAN_ISOTP_FS_CTS            (0x0U)
+#define CAN_ISOTP_FS_WAIT           (0x1U)
+#define CAN_ISOTP_FS_OVERFLOW       (0x2U)
+
+typedef void (*canIsotpRxCallback_t)(uint8_t channel, const uint8_t* data, uint32_t length);
+
+typedef struct {
+    uint32_t txId;
+    uint32_t rxId;
+    bool extended;
+    uint8_t blockSize;
+    uint8_t stMin;
+    bool padding;
+    canIsotpRxCallback_t rxCallback;
+} canIsotpConfig_t;
+
+typedef struct {
+    uint32_t txMessages;
+    uint32_t rxMessages;
+    uint32_t txFrames;
+    uint32_t rxFrames;
+    uint32_t flowControlWaits;
+    uint32_t timeoutCount;
+    uint32_t sequenceErrors;
+    uint32_t overflowCount;
+    uint32_t abortCount;
+} canIsotpStats_t;
+
+bool canIsotp_open(uint8_t channel, const canIsotpConfig_t* config);
+void canIsotp_close(uint8_t channel);
+canStatus_t canIsotp_send(uint8_t channel, const uint8_t* data, uint32_t length);
+bool canIsotp_txBusy(uint8_t channel);
+bool canIsotp_rxBusy(uint8_t channel);
+void canIsotp_poll(void);
+const canIsotpStats_t* canIsotp_getStats(uint8_t channel);
+uint32_t canIsotp_stMinToUs(uint8_t stMin);
+
+#endif
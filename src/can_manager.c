@@ -4,424 +4,2608 @@
 #include "fan_control.h"
 #include "state_machine.h"
 #include "pid_controller.h"
+#include "can_ring.h"
+#include "can_transport.h"
+#include "can_db.h"
+#include "can_capture.h"
+#include "can_timing.h"
+#include "can_e2e.h"
+#include "time_base.h"
 #include <stdio.h>
 #include <string.h>
-#include <time.h>
 #include <unistd.h>
 
-#define MAIN_LOOP_DELAY (100U)
-#define CAN_TX_INTERVAL_MS (1000U)
-#define CAN_RX_QUEUE_SIZE 32
+_Static_assert((CAN_DB_TEMP_STATUS_ID == CAN_MSG_TEMP_STATUS) &&
+               (CAN_DB_PUMP_STATUS_ID == CAN_MSG_PUMP_STATUS) &&
+               (CAN_DB_FAN_STATUS_ID == CAN_MSG_FAN_STATUS) &&
+               (CAN_DB_SYSTEM_STATUS_ID == CAN_MSG_SYSTEM_STATUS) &&
+               (CAN_DB_PID_PARAMS_ID == CAN_MSG_PID_PARAMS) &&
+               (CAN_DB_CONSOLIDATED_STATUS_ID == CAN_MSG_CONSOLIDATED_STATUS) &&
+               (CAN_DB_SETPOINT_CMD_ID == CAN_MSG_SETPOINT_CMD) &&
+               (CAN_DB_PID_TUNE_CMD_ID == CAN_MSG_PID_TUNE_CMD) &&
+               (CAN_DB_SYSTEM_CMD_ID == CAN_MSG_SYSTEM_CMD),
+               "DBC message IDs out of sync with can_manager.h");
+_Static_assert(CAN_DB_CONSOLIDATED_STATUS_LENGTH <= CAN_FD_MAX_DATA_LENGTH,
+               "Consolidated status does not fit in a CAN-FD frame");
+_Static_assert((CAN_EXT_HANDLER_BITS > 0U) && (CAN_EXT_HANDLER_BITS < 16U),
+               "CAN_EXT_HANDLER_BITS out of range");
+_Static_assert(CAN_FILTER_BANK_SIZE < 0xFFU, "CAN_FILTER_BANK_SIZE must fit in uint8_t");
+_Static_assert(CAN_ID_STATS_MAX < 0xFFU, "CAN_ID_STATS_MAX must fit in uint8_t");
+_Static_assert((CAN_RX_QUEUE_DEPTH_MAX & (CAN_RX_QUEUE_DEPTH_MAX - 1U)) == 0U,
+               "CAN_RX_QUEUE_DEPTH_MAX must be a power of two");
+_Static_assert((CAN_CHANNELS_MAX > 0U) && (CAN_CHANNELS_MAX <= 0xFFU),
+               "CAN_CHANNELS_MAX must fit in uint8_t");
+_Static_assert(CAN_COALESCE_SLOTS < 0xFFU, "CAN_COALESCE_SLOTS must fit in uint8_t");
 
-static canConfig_t canConfig;
-static canStats_t canStats;
-static canRxCallback_t rxCallback = NULL;
-static canFrame_t rxQueue[CAN_RX_QUEUE_SIZE];
-static uint8_t rxQueueHead = 0;
-static uint8_t rxQueueTail = 0;
-static uint8_t rxQueueCount = 0;
+#define CAN_FILTER_REJECT (0xFFU)
+#define CAN_ID_STATS_NONE (0xFFU)
+#define CAN_COALESCE_NONE (0xFFU)
+#define CAN_E2E_NONE      (0xFFFFFFFFU)
+
+typedef struct {
+    uint32_t id;
+    canRxHandler_t handler;
+    bool used;
+    bool deleted;
+} canExtHandlerSlot_t;
+
+/*
+ * Everything one bus needs. A channel is owned by the thread that serves
+ * it (plus one RX producer); channels share no mutable state, so separate
+ * buses run in parallel without locks. The RX ring is cache-line aligned,
+ * which keeps neighbouring channels off each other's lines. The TX queue
+ * has one spare entry past its depth, so a reservation always has a slot.
+ */
+struct canChannel {
+    canRing_t rxQueue;
+    canFrame_t rxQueueStorage[CAN_RX_QUEUE_DEPTH_MAX];
+    atomic_uint rxOverruns;
+    atomic_uint rxHighWater;
+    atomic_uint rxFiltered;
+    canConfig_t config;
+    canStats_t stats;
+    const canTransport_t* transport;
+    canRxCallback_t rxCallback;
+    canRxRouter_t router;
+    canRxHandler_t stdHandlers[CAN_STD_ID_COUNT];
+    canExtHandlerSlot_t extHandlers[CAN_EXT_HANDLER_SLOTS];
+    canFilter_t filterBank[CAN_FILTER_BANK_SIZE];
+    bool filterActive[CAN_FILTER_BANK_SIZE];
+    atomic_uint filterHits[CAN_FILTER_BANK_SIZE];
+    uint8_t stdFilterMatch[CAN_STD_ID_COUNT];
+    uint8_t extFilterList[CAN_FILTER_BANK_SIZE];
+    uint8_t extFilterCount;
+    bool filtersEnabled;
+    uint8_t coalesceIndex[CAN_STD_ID_COUNT];
+    uint32_t coalesceIds[CAN_COALESCE_SLOTS];
+    canFrame_t coalescePending[CAN_COALESCE_SLOTS];
+    bool coalesceValid[CAN_COALESCE_SLOTS];
+    uint32_t coalesceCount;
+    canE2eConfig_t e2eConfig[CAN_E2E_ENTRIES];
+    canE2eState_t e2eState[CAN_E2E_ENTRIES];
+    uint32_t e2eCount;
+    canFrame_t txQueue[CAN_TX_QUEUE_DEPTH + 1U];
+    uint64_t txQueueTime[CAN_TX_QUEUE_DEPTH];
+    uint32_t txQueueCount;
+    uint32_t txMailbox[CAN_STD_ID_COUNT / 32U];
+    canBusState_t busState;
+    uint32_t txErrorCounter;
+    uint32_t busOffStreak;
+    uint64_t busRecoveryUs;
+    uint64_t txQueueTimeTotalUs;
+    uint64_t txQueueTimeFrames;
+    canIdStats_t idStats[CAN_ID_STATS_MAX];
+    uint8_t stdIdStatsIndex[CAN_STD_ID_COUNT];
+    uint32_t idStatsCount;
+    uint64_t busTimeNs;
+    uint64_t busWindowStartUs;
+    uint64_t busWindowTimeNs;
+};
+
+static canChannel_t channels[CAN_CHANNELS_MAX];
+static canChannel_t* const defaultChannel = &channels[CAN_CHANNEL_DEFAULT];
+
+typedef enum {
+    CAN_TX_SLOT_TEMP = 0,
+    CAN_TX_SLOT_PUMP,
+    CAN_TX_SLOT_FAN,
+    CAN_TX_SLOT_SYSTEM,
+    CAN_TX_SLOT_PID,
+    CAN_TX_SLOT_CONSOLIDATED,
+    CAN_TX_SLOT_COUNT
+} canTxSlot_t;
+
+typedef struct {
+    canFrame_t frame;
+    uint32_t lastTxMs;
+    bool valid;
+} canTxSlotState_t;
+
+static canTxSlotState_t txSlots[CAN_TX_SLOT_COUNT];
+static canStatusSnapshot_t lastSentSignals;
+static uint32_t scheduleStartMs = 0;
+
+typedef struct {
+    uint32_t id;
+    canTxSlot_t slot;
+    uint8_t length;
+    bool fd;
+    uint32_t periodMs;
+    uint32_t offsetMs;
+    uint32_t nextDueMs;
+} canScheduleEntry_t;
+
+/*
+ * Default periodic schedule: offsets put at most two classic frames in
+ * any tick. The consolidated FD frame replaces the four classic frames
+ * when enabled.
+ */
+static const canScheduleEntry_t txScheduleDefault[] = {
+    {CAN_MSG_TEMP_STATUS, CAN_TX_SLOT_TEMP, CAN_DB_TEMP_STATUS_LENGTH, false, 100U, 0U, 0U},
+    {CAN_MSG_PUMP_STATUS, CAN_TX_SLOT_PUMP, CAN_DB_PUMP_STATUS_LENGTH, false, 500U, 100U, 0U},
+    {CAN_MSG_FAN_STATUS, CAN_TX_SLOT_FAN, CAN_DB_FAN_STATUS_LENGTH, false, 500U, 300U, 0U},
+    {CAN_MSG_PID_PARAMS, CAN_TX_SLOT_PID, CAN_DB_PID_PARAMS_LENGTH, false, 5000U, 200U, 0U},
+    {CAN_MSG_CONSOLIDATED_STATUS, CAN_TX_SLOT_CONSOLIDATED, CAN_DB_CONSOLIDATED_STATUS_LENGTH, true, 100U, 0U, 0U}
+};
+
+#define CAN_SCHEDULE_SIZE (sizeof(txScheduleDefault) / sizeof(txScheduleDefault[0]))
+
+static canScheduleEntry_t txSchedule[CAN_SCHEDULE_SIZE];
+
+static const uint8_t fdDlcLength[CAN_FD_MAX_DLC + 1U] = {
+    0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U
+};
 
 static void canManager_handleSetpointCmd(const canFrame_t* frame);
 static void canManager_handlePidTuneCmd(const canFrame_t* frame);
 static void canManager_handleSystemCmd(const canFrame_t* frame);
-static bool canManager_queueRxFrame(const canFrame_t* frame);
-static bool canManager_dequeueRxFrame(canFrame_t* frame);
+static void canManager_pollTransport(canChannel_t* channel);
+static void canManager_tapFrame(const canChannel_t* channel, const canFrame_t* frame, bool tx);
+static void canManager_recordFrame(canChannel_t* channel, const canFrame_t* frame, bool tx, uint64_t timestampUs);
+static void canManager_rollBusWindow(canChannel_t* channel, uint64_t now);
+static void canManager_recordTxStatus(canChannel_t* channel, canStatus_t status, uint32_t sent);
+static void canManager_enterBusOff(canChannel_t* channel);
+static bool canManager_busAvailable(canChannel_t* channel);
+static void canManager_expireTx(canChannel_t* channel);
+static canIdStats_t* canManager_findIdStats(canChannel_t* channel, const canFrame_t* frame);
+static uint32_t canManager_findE2e(const canChannel_t* channel, const canFrame_t* frame);
+static bool canManager_checkE2e(canChannel_t* channel, const canFrame_t* frame);
+static void canManager_findLastCoalesced(canChannel_t* channel, uint32_t count, uint32_t* lastPosition);
+static uint8_t canManager_coalesceSlot(const canChannel_t* channel, const canFrame_t* frame);
+static void canManager_coalesceFrame(canChannel_t* channel, uint8_t slot, const canFrame_t* frame);
+static void canManager_flushCoalescedSlot(canChannel_t* channel, uint8_t slot);
+static void canManager_flushCoalesced(canChannel_t* channel);
+static uint32_t canManager_latencyBucket(uint64_t latencyUs);
+static canFrame_t* canManager_reserveStatus(uint32_t id, uint8_t length, bool extended, bool fd);
+static canStatus_t canManager_commitStatus(canTxSlot_t slot, canFrame_t* frame);
+static bool canManager_slotDue(canTxSlot_t slot);
+static bool canManager_movedPast(float value, float reference, float deadband);
+static void canManager_readSnapshot(canStatusSnapshot_t* snapshot);
+static void canManager_sendOnChange(const canStatusSnapshot_t* snapshot);
+static bool canManager_scheduleActive(const canScheduleEntry_t* entry);
+static bool canManager_scheduleDue(const canScheduleEntry_t* entry, uint32_t timeMs);
+static void canManager_sendSlot(canTxSlot_t slot, const canStatusSnapshot_t* snapshot);
+static uint32_t canManager_gcd(uint32_t a, uint32_t b);
+static bool canManager_validateFrame(const canChannel_t* channel, const canFrame_t* frame);
+static uint32_t canManager_extHash(uint32_t id);
+static canRxHandler_t canManager_lookupHandler(const canChannel_t* channel, const canFrame_t* frame);
+static void canManager_rebuildFilters(canChannel_t* channel);
+static bool canManager_acceptFrame(canChannel_t* channel, const canFrame_t* frame);
 void can_rx_callback(const canFrame_t* frame);
 
 /*
- * Initialize CAN manager
+ * Channel handle by index, NULL if out of range. Channel 0 is the default
+ * channel behind the canManager_* functions.
+ */
+canChannel_t* canChannel_get(uint8_t index)
+{
+    if (index >= CAN_CHANNELS_MAX) {
+        return NULL;
+    }
+    
+    return &channels[index];
+}
+
+/*
+ * Index of a channel handle
+ */
+uint8_t canChannel_getIndex(const canChannel_t* channel)
+{
+    return (channel != NULL) ? (uint8_t)(channel - channels) : 0U;
+}
+
+/*
+ * Initialize one channel: queues, statistics, filters and backend. The
+ * channel starts with no handlers, RX callback or router.
+ */
+bool canChannel_init(canChannel_t* channel, const canConfig_t* config)
+{
+    bool initResult = false;
+    
+    if (channel == NULL) {
+        return false;
+    }
+    
+    if ((channel->transport != NULL) && (channel->transport->close != NULL)) {
+        channel->transport->close(channel->config.transportContext);
+    }
+    channel->transport = NULL;
+    
+    if (config == NULL) {
+        memset(&channel->config, 0, sizeof(channel->config));
+        channel->config.baudrate = 250000;
+    } else {
+        channel->config = *config;
+    }
+    
+    if (channel->config.rxQueueDepth == 0U) {
+        channel->config.rxQueueDepth = CAN_RX_QUEUE_DEPTH_DEFAULT;
+    }
+    
+    if (channel->config.rxQueueDepth > CAN_RX_QUEUE_DEPTH_MAX) {
+        return false;
+    }
+    
+    if (channel->config.transport == NULL) {
+        channel->config.transport = &canTransport_null;
+    }
+    
+    if (channel->config.heartbeatMs == 0U) {
+        channel->config.heartbeatMs = CAN_TX_HEARTBEAT_MS_DEFAULT;
+    }
+    
+    if (channel->config.txTimeoutMs == 0U) {
+        channel->config.txTimeoutMs = CAN_TX_TIMEOUT_MS_DEFAULT;
+    }
+    
+    memset(&channel->stats, 0, sizeof(channel->stats));
+    channel->txQueueCount = 0;
+    channel->txQueueTimeTotalUs = 0;
+    channel->txQueueTimeFrames = 0;
+    memset(channel->txMailbox, 0, sizeof(channel->txMailbox));
+    channel->busState = CAN_BUS_STATE_ACTIVE;
+    channel->txErrorCounter = 0U;
+    channel->busOffStreak = 0U;
+    channel->busRecoveryUs = 0U;
+    memset(channel->idStats, 0, sizeof(channel->idStats));
+    memset(channel->stdIdStatsIndex, CAN_ID_STATS_NONE, sizeof(channel->stdIdStatsIndex));
+    channel->idStatsCount = 0;
+    channel->busTimeNs = 0;
+    channel->busWindowTimeNs = 0;
+    channel->busWindowStartUs = timeBase_nowUs();
+    atomic_store_explicit(&channel->rxOverruns, 0U, memory_order_relaxed);
+    atomic_store_explicit(&channel->rxHighWater, 0U, memory_order_relaxed);
+    atomic_store_explicit(&channel->rxFiltered, 0U, memory_order_relaxed);
+    canChannel_clearFilters(channel);
+    
+    initResult = canRing_init(&channel->rxQueue, channel->rxQueueStorage, channel->config.rxQueueDepth);
+    
+    if (initResult && (channel->config.transport->open != NULL)) {
+        initResult = channel->config.transport->open(channel->config.transportContext, &channel->config);
+    }
+    
+    if (initResult) {
+        channel->transport = channel->config.transport;
+    }
+    
+    memset(channel->stdHandlers, 0, sizeof(channel->stdHandlers));
+    memset(channel->extHandlers, 0, sizeof(channel->extHandlers));
+    memset(channel->coalesceIndex, CAN_COALESCE_NONE, sizeof(channel->coalesceIndex));
+    memset(channel->coalesceValid, 0, sizeof(channel->coalesceValid));
+    channel->coalesceCount = 0U;
+    channel->e2eCount = 0U;
+    channel->rxCallback = NULL;
+    channel->router = NULL;
+    
+    return initResult;
+}
+
+/*
+ * Send CAN frame
+ */
+canStatus_t canChannel_sendFrame(canChannel_t* channel, const canFrame_t* frame)
+{
+    canFrame_t protectedFrame;
+    canE2eState_t e2eState;
+    canStatus_t status;
+    uint32_t e2e;
+    
+    if ((channel == NULL) || (frame == NULL)) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    if (!canManager_validateFrame(channel, frame)) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    if (channel->transport == NULL) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    if (!canManager_busAvailable(channel)) {
+        return CAN_STATUS_BUS_OFF;
+    }
+    
+    /* The alive counter only advances for frames the backend takes */
+    e2e = canManager_findE2e(channel, frame);
+    if (e2e != CAN_E2E_NONE) {
+        protectedFrame = *frame;
+        e2eState = channel->e2eState[e2e];
+        if (!canE2e_protect(&channel->e2eConfig[e2e], &e2eState, &protectedFrame)) {
+            return CAN_STATUS_ERROR;
+        }
+        frame = &protectedFrame;
+    }
+    
+    status = channel->transport->send(channel->config.transportContext, frame);
+    if (status == CAN_STATUS_OK) {
+        if (e2e != CAN_E2E_NONE) {
+            channel->e2eState[e2e].txCounter = e2eState.txCounter;
+        }
+        canManager_tapFrame(channel, frame, true);
+        channel->stats.txCount++;
+        canManager_recordFrame(channel, frame, true, timeBase_nowUs());
+        canManager_recordTxStatus(channel, status, 1U);
+    } else {
+        canManager_recordTxStatus(channel, status, 0U);
+    }
+    
+    return status;
+}
+
+/*
+ * Queue frame for the next canChannel_flushTx (a copy into the slot from
+ * canChannel_reserveTx, then canChannel_commitTx)
+ */
+canStatus_t canChannel_queueFrame(canChannel_t* channel, const canFrame_t* frame)
+{
+    canFrame_t* slot;
+    
+    if ((channel == NULL) || (frame == NULL)) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    slot = canChannel_reserveTx(channel);
+    *slot = *frame;
+    
+    return canChannel_commitTx(channel, slot);
+}
+
+/*
+ * Reserve the next TX queue slot to build a frame in place. Header fields
+ * are cleared, the payload is not. The slot stays private until
+ * canChannel_commitTx; a reservation that is never committed costs
+ * nothing, and the next one returns the same slot.
+ */
+canFrame_t* canChannel_reserveTx(canChannel_t* channel)
+{
+    canFrame_t* slot;
+    
+    if (channel == NULL) {
+        return NULL;
+    }
+    
+    slot = &channel->txQueue[channel->txQueueCount];
+    slot->id = 0U;
+    slot->dlc = 0U;
+    slot->extended = false;
+    slot->remote = false;
+    slot->fd = false;
+    slot->brs = false;
+    slot->timestampUs = 0U;
+    
+    return slot;
+}
+
+/*
+ * Publish a reserved frame to the TX queue. A frame whose ID has a TX
+ * mailbox replaces the queued frame of that ID in place, so a congested
+ * bus sends the latest value instead of a backlog of stale ones. The
+ * queue belongs to the channel's thread, so publishing is just the count
+ * update; no copy is made unless a mailbox frame is replaced.
+ */
+canStatus_t canChannel_commitTx(canChannel_t* channel, canFrame_t* frame)
+{
+    uint32_t index;
+    uint32_t e2e;
+    bool replace = false;
+    
+    if ((channel == NULL) || (frame != &channel->txQueue[channel->txQueueCount])) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    if (!canManager_validateFrame(channel, frame)) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    index = channel->txQueueCount;
+    if (!frame->extended && ((channel->txMailbox[frame->id / 32U] & (1UL << (frame->id % 32U))) != 0U)) {
+        for (index = 0U; index < channel->txQueueCount; index++) {
+            if (!channel->txQueue[index].extended && (channel->txQueue[index].id == frame->id)) {
+                replace = true;
+                break;
+            }
+        }
+    }
+    
+    if (!replace && (channel->txQueueCount >= CAN_TX_QUEUE_DEPTH)) {
+        channel->stats.txOverrunCount++;
+        return CAN_STATUS_OVERRUN;
+    }
+    
+    e2e = canManager_findE2e(channel, frame);
+    if ((e2e != CAN_E2E_NONE) &&
+        !canE2e_protect(&channel->e2eConfig[e2e], &channel->e2eState[e2e], frame)) {
+        return CAN_STATUS_ERROR;
+    }
+    channel->txQueueTime[index] = timeBase_nowUs();
+    
+    if (replace) {
+        channel->txQueue[index] = *frame;
+        channel->stats.txReplacedCount++;
+        return CAN_STATUS_OK;
+    }
+    
+    channel->txQueueCount++;
+    if (channel->txQueueCount > channel->stats.txQueueHighWater) {
+        channel->stats.txQueueHighWater = channel->txQueueCount;
+    }
+    
+    return CAN_STATUS_OK;
+}
+
+/*
+ * Send all queued frames in bus arbitration order through one backend call.
+ * Frames the backend could not take stay queued for the next flush, and
+ * are tapped only once actually sent; frames older than the TX timeout are
+ * aborted first. While the channel is bus off nothing is sent and the
+ * queue waits for recovery.
+ */
+canStatus_t canChannel_flushTx(canChannel_t* channel)
+{
+    const canFrame_t* batch[CAN_TX_QUEUE_DEPTH];
+    uint32_t order[CAN_TX_QUEUE_DEPTH];
+    uint32_t keys[CAN_TX_QUEUE_DEPTH];
+    uint32_t sent = 0;
+    uint32_t queued;
+    uint32_t i;
+    uint32_t j;
+    uint64_t now;
+    canStatus_t status = CAN_STATUS_OK;
+    
+    if (channel == NULL) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    canManager_rollBusWindow(channel, timeBase_nowUs());
+    canManager_expireTx(channel);
+    queued = channel->txQueueCount;
+    if (queued == 0U) {
+        return CAN_STATUS_OK;
+    }
+    
+    if (channel->transport == NULL) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    if (!canManager_busAvailable(channel)) {
+        return CAN_STATUS_BUS_OFF;
+    }
+    
+    /* Stable insertion sort: equal keys keep submission order */
+    for (i = 0U; i < queued; i++) {
+        uint32_t key = canManager_arbitrationKey(&channel->txQueue[i]);
+    
+        for (j = i; (j > 0U) && (keys[j - 1U] > key); j--) {
+            keys[j] = keys[j - 1U];
+            order[j] = order[j - 1U];
+        }
+        keys[j] = key;
+        order[j] = i;
+    }
+    
+    for (i = 0U; i < queued; i++) {
+        batch[i] = &channel->txQueue[order[i]];
+    }
+    
+    if (channel->transport->sendBatch != NULL) {
+        status = channel->transport->sendBatch(channel->config.transportContext, batch, queued, &sent);
+    } else {
+        while ((sent < queued) && (status == CAN_STATUS_OK)) {
+            status = channel->transport->send(channel->config.transportContext, batch[sent]);
+            if (status == CAN_STATUS_OK) {
+                sent++;
+            }
+        }
+    }
+    
+    now = timeBase_nowUs();
+    for (i = 0U; i < sent; i++) {
+        uint64_t waited = now - channel->txQueueTime[order[i]];
+    
+        channel->txQueueTimeTotalUs += waited;
+        if (waited > channel->stats.txQueueTimeMaxUs) {
+            channel->stats.txQueueTimeMaxUs = (uint32_t)waited;
+        }
+        channel->stats.txLatencyHistogram[canManager_latencyBucket(waited)]++;
+        canManager_tapFrame(channel, batch[i], true);
+        canManager_recordFrame(channel, batch[i], true, now);
+    }
+    canManager_recordTxStatus(channel, status, sent);
+    channel->txQueueTimeFrames += sent;
+    channel->stats.txCount += sent;
+    channel->stats.txFlushCount++;
+    
+    if (sent < queued) {
+        canFrame_t remaining[CAN_TX_QUEUE_DEPTH];
+        uint64_t remainingTime[CAN_TX_QUEUE_DEPTH];
+        uint32_t count = queued - sent;
+    
+        for (i = 0U; i < count; i++) {
+            remaining[i] = channel->txQueue[order[sent + i]];
+            remainingTime[i] = channel->txQueueTime[order[sent + i]];
+        }
+        memcpy(channel->txQueue, remaining, count * sizeof(canFrame_t));
+        memcpy(channel->txQueueTime, remainingTime, count * sizeof(uint64_t));
+        channel->txQueueCount = count;
+    } else {
+        channel->txQueueCount = 0U;
+    }
+    
+    return status;
+}
+
+/*
+ * Receive CAN frame (non-blocking)
+ */
+canStatus_t canChannel_receiveFrame(canChannel_t* channel, canFrame_t* frame)
+{
+    if ((channel == NULL) || (frame == NULL)) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    if (canRing_pop(&channel->rxQueue, frame)) {
+        channel->stats.rxCount++;
+        return CAN_STATUS_OK;
+    }
+    
+    return CAN_STATUS_TIMEOUT;
+}
+
+/*
+ * Oldest received frame in place in the RX queue, or NULL when empty.
+ * The pointer stays valid until canChannel_consumeFrames releases it.
+ */
+const canFrame_t* canChannel_peekFrame(canChannel_t* channel)
+{
+    if (channel == NULL) {
+        return NULL;
+    }
+    
+    return canRing_peek(&channel->rxQueue);
+}
+
+/*
+ * Contiguous span of up to maxCount received frames in the RX queue.
+ * The span ends at the ring's wrap point, so a second call may return
+ * more frames after the first span is consumed.
+ */
+uint32_t canChannel_peekFrames(canChannel_t* channel, const canFrame_t** frames, uint32_t maxCount)
+{
+    if ((channel == NULL) || (frames == NULL)) {
+        return 0U;
+    }
+    
+    return canRing_peekSpan(&channel->rxQueue, frames, maxCount);
+}
+
+/*
+ * Release the oldest count frames after peeking at them
+ */
+void canChannel_consumeFrames(canChannel_t* channel, uint32_t count)
+{
+    uint32_t queued;
+    
+    if (channel == NULL) {
+        return;
+    }
+    
+    queued = canRing_count(&channel->rxQueue);
+    if (count > queued) {
+        count = queued;
+    }
+    
+    canRing_consume(&channel->rxQueue, count);
+    channel->stats.rxCount += count;
+}
+
+/*
+ * Push a received frame into the RX queue. Safe to call from one receive
+ * thread (or ISR) concurrently with canChannel_processMessages. Frames
+ * without a receive timestamp are stamped here.
+ */
+canStatus_t canChannel_enqueueRxFrame(canChannel_t* channel, const canFrame_t* frame)
+{
+    uint32_t depth;
+    bool pushed;
+    
+    if ((channel == NULL) || (frame == NULL)) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    if (!canManager_validateFrame(channel, frame)) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    if (!canManager_acceptFrame(channel, frame)) {
+        atomic_fetch_add_explicit(&channel->rxFiltered, 1U, memory_order_relaxed);
+        return CAN_STATUS_OK;
+    }
+    
+    if (frame->timestampUs == 0U) {
+        canFrame_t stamped = *frame;
+    
+        stamped.timestampUs = timeBase_nowUs();
+        pushed = canRing_push(&channel->rxQueue, &stamped);
+    } else {
+        pushed = canRing_push(&channel->rxQueue, frame);
+    }
+    
+    if (!pushed) {
+        atomic_fetch_add_explicit(&channel->rxOverruns, 1U, memory_order_relaxed);
+        return CAN_STATUS_OVERRUN;
+    }
+    
+    depth = canRing_count(&channel->rxQueue);
+    if (depth > atomic_load_explicit(&channel->rxHighWater, memory_order_relaxed)) {
+        atomic_store_explicit(&channel->rxHighWater, depth, memory_order_relaxed);
+    }
+    
+    return CAN_STATUS_OK;
+}
+
+/*
+ * Configure one acceptance filter (NULL disables it). A frame is accepted
+ * when ((frame.id ^ filter.id) & filter.mask) == 0 for any active filter of
+ * the same ID type; with no active filters every frame is accepted.
+ * Reconfigure only while the receive thread is stopped.
+ */
+bool canChannel_setFilter(canChannel_t* channel, uint8_t index, const canFilter_t* filter)
+{
+    if ((channel == NULL) || (index >= CAN_FILTER_BANK_SIZE)) {
+        return false;
+    }
+    
+    if (filter == NULL) {
+        channel->filterActive[index] = false;
+    } else {
+        uint32_t idMask = filter->extended ? CAN_EXT_ID_MASK : (CAN_STD_ID_COUNT - 1U);
+    
+        if ((filter->id & ~idMask) != 0U) {
+            return false;
+        }
+        channel->filterBank[index] = *filter;
+        channel->filterBank[index].mask &= idMask;
+        channel->filterActive[index] = true;
+    }
+    
+    atomic_store_explicit(&channel->filterHits[index], 0U, memory_order_relaxed);
+    canManager_rebuildFilters(channel);
+    
+    return true;
+}
+
+/*
+ * Disable all acceptance filters (accept everything)
+ */
+void canChannel_clearFilters(canChannel_t* channel)
+{
+    uint32_t i;
+    
+    if (channel == NULL) {
+        return;
+    }
+    
+    for (i = 0U; i < CAN_FILTER_BANK_SIZE; i++) {
+        channel->filterActive[i] = false;
+        atomic_store_explicit(&channel->filterHits[i], 0U, memory_order_relaxed);
+    }
+    
+    canManager_rebuildFilters(channel);
+}
+
+/*
+ * Number of frames accepted by one filter
+ */
+uint32_t canChannel_getFilterHits(canChannel_t* channel, uint8_t index)
+{
+    if ((channel == NULL) || (index >= CAN_FILTER_BANK_SIZE)) {
+        return 0U;
+    }
+    
+    return atomic_load_explicit(&channel->filterHits[index], memory_order_relaxed);
+}
+
+/*
+ * Register callback for received messages
+ */
+void canChannel_setRxCallback(canChannel_t* channel, canRxCallback_t callback)
+{
+    if (channel != NULL) {
+        channel->rxCallback = callback;
+    }
+}
+
+/*
+ * Install a router that sees every accepted frame on this channel before
+ * its handlers run, e.g. the gateway. NULL removes it.
+ */
+void canChannel_setRouter(canChannel_t* channel, canRxRouter_t router)
+{
+    if (channel != NULL) {
+        channel->router = router;
+    }
+}
+
+/*
+ * Protect one message ID with an E2E profile, or remove its protection
+ * with CAN_E2E_PROFILE_NONE. Frames sent on the channel get CRC and alive
+ * counter appended; received frames that fail the check are dropped before
+ * dispatch and counted. Reconfiguring an ID resets its counters.
+ */
+bool canChannel_setE2e(canChannel_t* channel, const canE2eConfig_t* config)
+{
+    canFrame_t key;
+    uint32_t entry;
+    uint8_t maxLength;
+    
+    if ((channel == NULL) || (config == NULL)) {
+        return false;
+    }
+    
+    key.id = config->id;
+    key.extended = config->extended;
+    entry = canManager_findE2e(channel, &key);
+    
+    if (config->profile == CAN_E2E_PROFILE_NONE) {
+        if (entry == CAN_E2E_NONE) {
+            return false;
+        }
+        channel->e2eCount--;
+        channel->e2eConfig[entry] = channel->e2eConfig[channel->e2eCount];
+        channel->e2eState[entry] = channel->e2eState[channel->e2eCount];
+        return true;
+    }
+    
+    maxLength = channel->config.fdEnabled ? CAN_FD_MAX_DATA_LENGTH : CAN_MAX_DATA_LENGTH;
+    if ((config->id > (config->extended ? CAN_EXT_ID_MASK : (CAN_STD_ID_COUNT - 1U))) ||
+        ((config->dataLength + canE2e_overhead(config->profile)) > maxLength)) {
+        return false;
+    }
+    
+    if (entry == CAN_E2E_NONE) {
+        if (channel->e2eCount >= CAN_E2E_ENTRIES) {
+            return false;
+        }
+        entry = channel->e2eCount;
+        channel->e2eCount++;
+    }
+    
+    canE2e_init();
+    channel->e2eConfig[entry] = *config;
+    memset(&channel->e2eState[entry], 0, sizeof(channel->e2eState[entry]));
+    
+    return true;
+}
+
+/*
+ * Enable or disable last-writer-wins coalescing for one standard ID. While
+ * enabled, canChannel_processMessages dispatches only the newest frame of
+ * that ID per call, in place of the last one received; older ones are
+ * counted as superseded. Reconfigure only from the thread processing the
+ * channel.
+ */
+bool canChannel_setCoalescing(canChannel_t* channel, uint32_t id, bool enabled)
+{
+    uint8_t slot;
+    uint32_t last;
+    
+    if ((channel == NULL) || (id >= CAN_STD_ID_COUNT)) {
+        return false;
+    }
+    
+    slot = channel->coalesceIndex[id];
+    if (enabled) {
+        if (slot != CAN_COALESCE_NONE) {
+            return true;
+        }
+        if (channel->coalesceCount >= CAN_COALESCE_SLOTS) {
+            return false;
+        }
+        slot = (uint8_t)channel->coalesceCount;
+        channel->coalesceIds[slot] = id;
+        channel->coalesceValid[slot] = false;
+        channel->coalesceIndex[id] = slot;
+        channel->coalesceCount++;
+        return true;
+    }
+    
+    if (slot == CAN_COALESCE_NONE) {
+        return false;
+    }
+    
+    /* Move the last slot into the freed one to keep the table dense */
+    last = channel->coalesceCount - 1U;
+    channel->coalesceIds[slot] = channel->coalesceIds[last];
+    channel->coalescePending[slot] = channel->coalescePending[last];
+    channel->coalesceValid[slot] = channel->coalesceValid[last];
+    channel->coalesceIndex[channel->coalesceIds[slot]] = slot;
+    channel->coalesceIndex[id] = CAN_COALESCE_NONE;
+    channel->coalesceCount = last;
+    
+    return true;
+}
+
+/*
+ * Enable or disable the latest-value TX mailbox for one standard ID (see
+ * canChannel_queueFrame)
+ */
+bool canChannel_setTxMailbox(canChannel_t* channel, uint32_t id, bool enabled)
+{
+    uint32_t bit;
+    
+    if ((channel == NULL) || (id >= CAN_STD_ID_COUNT)) {
+        return false;
+    }
+    
+    bit = (uint32_t)(1UL << (id % 32U));
+    if (enabled) {
+        channel->txMailbox[id / 32U] |= bit;
+    } else {
+        channel->txMailbox[id / 32U] &= ~bit;
+    }
+    
+    return true;
+}
+
+/*
+ * Drop every queued TX frame; returns the number aborted
+ */
+uint32_t canChannel_abortTx(canChannel_t* channel)
+{
+    uint32_t aborted;
+    
+    if (channel == NULL) {
+        return 0U;
+    }
+    
+    aborted = channel->txQueueCount;
+    channel->txQueueCount = 0U;
+    channel->stats.txAbortCount += aborted;
+    
+    return aborted;
+}
+
+/*
+ * Fault confinement state, after applying a due bus-off recovery
+ */
+canBusState_t canChannel_getBusState(canChannel_t* channel)
+{
+    if (channel == NULL) {
+        return CAN_BUS_STATE_BUS_OFF;
+    }
+    
+    (void)canManager_busAvailable(channel);
+    
+    return channel->busState;
+}
+
+/*
+ * Register handler for one message ID. Standard IDs index a flat table;
+ * extended IDs go into an open-addressed hash. Re-registering replaces the
+ * existing handler.
+ */
+bool canChannel_registerHandler(canChannel_t* channel, uint32_t id, bool extended, canRxHandler_t handler)
+{
+    uint32_t slot;
+    uint32_t probe;
+    uint32_t freeSlot = CAN_EXT_HANDLER_SLOTS;
+    
+    if ((channel == NULL) || (handler == NULL)) {
+        return false;
+    }
+    
+    if (!extended) {
+        if (id >= CAN_STD_ID_COUNT) {
+            return false;
+        }
+        channel->stdHandlers[id] = handler;
+        return true;
+    }
+    
+    if (id > CAN_EXT_ID_MASK) {
+        return false;
+    }
+    
+    slot = canManager_extHash(id);
+    for (probe = 0U; probe < CAN_EXT_HANDLER_SLOTS; probe++) {
+        canExtHandlerSlot_t* entry = &channel->extHandlers[slot];
+    
+        if (!entry->used) {
+            if (freeSlot == CAN_EXT_HANDLER_SLOTS) {
+                freeSlot = slot;
+            }
+            break;
+        }
+        if (entry->deleted) {
+            if (freeSlot == CAN_EXT_HANDLER_SLOTS) {
+                freeSlot = slot;
+            }
+        } else if (entry->id == id) {
+            entry->handler = handler;
+            return true;
+        }
+        slot = (slot + 1U) & (CAN_EXT_HANDLER_SLOTS - 1U);
+    }
+    
+    if (freeSlot == CAN_EXT_HANDLER_SLOTS) {
+        return false;
+    }
+    
+    channel->extHandlers[freeSlot].id = id;
+    channel->extHandlers[freeSlot].handler = handler;
+    channel->extHandlers[freeSlot].used = true;
+    channel->extHandlers[freeSlot].deleted = false;
+    
+    return true;
+}
+
+/*
+ * Remove handler for one message ID
+ */
+bool canChannel_unregisterHandler(canChannel_t* channel, uint32_t id, bool extended)
+{
+    uint32_t slot;
+    uint32_t probe;
+    
+    if (channel == NULL) {
+        return false;
+    }
+    
+    if (!extended) {
+        if ((id >= CAN_STD_ID_COUNT) || (channel->stdHandlers[id] == NULL)) {
+            return false;
+        }
+        channel->stdHandlers[id] = NULL;
+        return true;
+    }
+    
+    slot = canManager_extHash(id);
+    for (probe = 0U; probe < CAN_EXT_HANDLER_SLOTS; probe++) {
+        canExtHandlerSlot_t* entry = &channel->extHandlers[slot];
+    
+        if (!entry->used) {
+            break;
+        }
+        if (!entry->deleted && (entry->id == id)) {
+            entry->deleted = true;
+            entry->handler = NULL;
+            return true;
+        }
+        slot = (slot + 1U) & (CAN_EXT_HANDLER_SLOTS - 1U);
+    }
+    
+    return false;
+}
+
+/*
+ * Run the registered handler and the RX callback for one frame
+ */
+void canChannel_dispatchFrame(canChannel_t* channel, const canFrame_t* frame)
+{
+    canRxHandler_t handler;
+    
+    if ((channel == NULL) || (frame == NULL)) {
+        return;
+    }
+    
+    handler = canManager_lookupHandler(channel, frame);
+    if (handler != NULL) {
+        handler(frame);
+    }
+    
+    if (channel->rxCallback != NULL) {
+        channel->rxCallback(frame);
+    }
+}
+
+/*
+ * Get CAN statistics. Counters are owned by the thread running
+ * canChannel_processMessages/flushTx; read them from that thread for a
+ * consistent snapshot. Bus load is that of the last completed
+ * CAN_BUS_LOAD_WINDOW_US window.
+ */
+const canStats_t* canChannel_getStats(canChannel_t* channel)
+{
+    canStats_t* stats;
+    uint32_t i;
+    
+    if (channel == NULL) {
+        return NULL;
+    }
+    
+    stats = &channel->stats;
+    
+    for (i = 0U; i < channel->idStatsCount; i++) {
+        canIdStats_t* entry = &channel->idStats[i];
+    
+        entry->cycleAvgUs = (entry->cycleSamples > 0U) ?
+            (uint32_t)(entry->cycleTotalUs / entry->cycleSamples) : 0U;
+    }
+    
+    stats->busTimeUs = channel->busTimeNs / 1000U;
+    stats->idStatsCount = channel->idStatsCount;
+    stats->idStats = channel->idStats;
+    stats->rxOverrunCount = atomic_load_explicit(&channel->rxOverruns, memory_order_relaxed);
+    stats->rxQueueHighWater = atomic_load_explicit(&channel->rxHighWater, memory_order_relaxed);
+    stats->rxFilteredCount = atomic_load_explicit(&channel->rxFiltered, memory_order_relaxed);
+    stats->txQueueDepth = channel->txQueueCount;
+    stats->busState = channel->busState;
+    stats->txErrorCounter = channel->txErrorCounter;
+    stats->txQueueTimeAvgUs = (channel->txQueueTimeFrames > 0U) ?
+        (uint32_t)(channel->txQueueTimeTotalUs / channel->txQueueTimeFrames) : 0U;
+    
+    return stats;
+}
+
+/*
+ * Statistics for one message ID, NULL if it has not been seen
+ */
+const canIdStats_t* canChannel_getIdStats(canChannel_t* channel, uint32_t id, bool extended)
+{
+    canFrame_t key;
+    canIdStats_t* entry;
+    
+    if (channel == NULL) {
+        return NULL;
+    }
+    
+    key.id = id;
+    key.extended = extended;
+    entry = canManager_findIdStats(channel, &key);
+    
+    if (entry != NULL) {
+        entry->cycleAvgUs = (entry->cycleSamples > 0U) ?
+            (uint32_t)(entry->cycleTotalUs / entry->cycleSamples) : 0U;
+    }
+    
+    return entry;
+}
+
+/*
+ * Process the received CAN messages queued on entry; frames arriving
+ * meanwhile wait for the next call. Coalesced command IDs are applied
+ * once per call, with the newest frame, at the position of their last
+ * occurrence.
+ */
+void canChannel_processMessages(canChannel_t* channel)
+{
+    uint32_t lastPosition[CAN_COALESCE_SLOTS];
+    const canFrame_t* frames;
+    uint32_t pending;
+    uint32_t done;
+    uint32_t count;
+    uint32_t i;
+    
+    if (channel == NULL) {
+        return;
+    }
+    
+    canManager_rollBusWindow(channel, timeBase_nowUs());
+    canManager_pollTransport(channel);
+    
+    pending = canRing_count(&channel->rxQueue);
+    canManager_findLastCoalesced(channel, pending, lastPosition);
+    
+    /* Handlers see the frames in place; each span is released after dispatch */
+    for (done = 0U; done < pending; done += count) {
+        count = canChannel_peekFrames(channel, &frames, pending - done);
+        if (count == 0U) {
+            break;
+        }
+        for (i = 0U; i < count; i++) {
+            const canFrame_t* frame = &frames[i];
+            uint64_t now;
+            uint64_t latency;
+            uint8_t slot;
+    
+            canManager_tapFrame(channel, frame, false);
+            if (channel->router != NULL) {
+                channel->router(channel, frame);
+            }
+            slot = canManager_coalesceSlot(channel, frame);
+            if (canManager_checkE2e(channel, frame)) {
+                if (slot == CAN_COALESCE_NONE) {
+                    canChannel_dispatchFrame(channel, frame);
+                } else {
+                    canManager_coalesceFrame(channel, slot, frame);
+                }
+            }
+            if ((slot != CAN_COALESCE_NONE) && (lastPosition[slot] == (done + i))) {
+                canManager_flushCoalescedSlot(channel, slot);
+            }
+    
+            now = timeBase_nowUs();
+            latency = (now > frame->timestampUs) ? (now - frame->timestampUs) : 0U;
+            if (latency > channel->stats.rxLatencyMaxUs) {
+                channel->stats.rxLatencyMaxUs = (uint32_t)latency;
+            }
+            channel->stats.rxLatencyHistogram[canManager_latencyBucket(latency)]++;
+            canManager_recordFrame(channel, frame, false, frame->timestampUs);
+        }
+        canChannel_consumeFrames(channel, count);
+    }
+    
+    /* Frames parked after a handler changed the coalescing table */
+    canManager_flushCoalesced(channel);
+}
+
+/*
+ * Initialize the default channel and the status schedule, and register
+ * the built-in command handlers
+ */
+bool canManager_init(const canConfig_t* config)
+{
+    bool initResult = canChannel_init(defaultChannel, config);
+    uint32_t i;
+    
+    memset(txSlots, 0, sizeof(txSlots));
+    memset(&lastSentSignals, 0, sizeof(lastSentSignals));
+    scheduleStartMs = timeBase_nowMs();
+    memcpy(txSchedule, txScheduleDefault, sizeof(txSchedule));
+    for (i = 0U; i < CAN_SCHEDULE_SIZE; i++) {
+        txSchedule[i].nextDueMs = scheduleStartMs + txSchedule[i].offsetMs;
+    }
+    
+    canManager_registerHandler(CAN_MSG_SETPOINT_CMD, false, canManager_handleSetpointCmd);
+    canManager_registerHandler(CAN_MSG_PID_TUNE_CMD, false, canManager_handlePidTuneCmd);
+    canManager_registerHandler(CAN_MSG_SYSTEM_CMD, false, canManager_handleSystemCmd);
+    canManager_setCoalescing(CAN_MSG_SETPOINT_CMD, true);
+    canManager_setCoalescing(CAN_MSG_PID_TUNE_CMD, true);
+    canManager_setTxMailbox(CAN_MSG_TEMP_STATUS, true);
+    canManager_setTxMailbox(CAN_MSG_PUMP_STATUS, true);
+    canManager_setTxMailbox(CAN_MSG_FAN_STATUS, true);
+    canManager_setTxMailbox(CAN_MSG_SYSTEM_STATUS, true);
+    canManager_setTxMailbox(CAN_MSG_PID_PARAMS, true);
+    canManager_setTxMailbox(CAN_MSG_CONSOLIDATED_STATUS, true);
+    
+    canManager_setRxCallback(can_rx_callback);
+    
+    return initResult;
+}
+
+/*
+ * Send CAN frame on the default channel
+ */
+canStatus_t canManager_sendFrame(const canFrame_t* frame)
+{
+    return canChannel_sendFrame(defaultChannel, frame);
+}
+
+/*
+ * Queue frame for the next canManager_flushTx
+ */
+canStatus_t canManager_queueFrame(const canFrame_t* frame)
+{
+    return canChannel_queueFrame(defaultChannel, frame);
+}
+
+/*
+ * Reserve the next TX slot on the default channel
+ */
+canFrame_t* canManager_reserveTx(void)
+{
+    return canChannel_reserveTx(defaultChannel);
+}
+
+/*
+ * Publish a frame reserved with canManager_reserveTx
+ */
+canStatus_t canManager_commitTx(canFrame_t* frame)
+{
+    return canChannel_commitTx(defaultChannel, frame);
+}
+
+/*
+ * Send all frames queued on the default channel
+ */
+canStatus_t canManager_flushTx(void)
+{
+    return canChannel_flushTx(defaultChannel);
+}
+
+/*
+ * Receive CAN frame from the default channel (non-blocking)
+ */
+canStatus_t canManager_receiveFrame(canFrame_t* frame)
+{
+    return canChannel_receiveFrame(defaultChannel, frame);
+}
+
+/*
+ * Oldest received frame on the default channel, in place
+ */
+const canFrame_t* canManager_peekFrame(void)
+{
+    return canChannel_peekFrame(defaultChannel);
+}
+
+/*
+ * Contiguous span of received frames on the default channel
+ */
+uint32_t canManager_peekFrames(const canFrame_t** frames, uint32_t maxCount)
+{
+    return canChannel_peekFrames(defaultChannel, frames, maxCount);
+}
+
+/*
+ * Release peeked frames on the default channel
+ */
+void canManager_consumeFrames(uint32_t count)
+{
+    canChannel_consumeFrames(defaultChannel, count);
+}
+
+/*
+ * Push a received frame into the default channel's RX queue
+ */
+canStatus_t canManager_enqueueRxFrame(const canFrame_t* frame)
+{
+    return canChannel_enqueueRxFrame(defaultChannel, frame);
+}
+
+/*
+ * Configure one acceptance filter on the default channel
+ */
+bool canManager_setFilter(uint8_t index, const canFilter_t* filter)
+{
+    return canChannel_setFilter(defaultChannel, index, filter);
+}
+
+/*
+ * Disable all acceptance filters on the default channel
+ */
+void canManager_clearFilters(void)
+{
+    canChannel_clearFilters(defaultChannel);
+}
+
+/*
+ * Number of frames accepted by one filter on the default channel
+ */
+uint32_t canManager_getFilterHits(uint8_t index)
+{
+    return canChannel_getFilterHits(defaultChannel, index);
+}
+
+/*
+ * Register callback for messages received on the default channel
+ */
+void canManager_setRxCallback(canRxCallback_t callback)
+{
+    canChannel_setRxCallback(defaultChannel, callback);
+}
+
+/*
+ * Configure E2E protection for one message ID on the default channel
+ */
+bool canManager_setE2e(const canE2eConfig_t* config)
+{
+    return canChannel_setE2e(defaultChannel, config);
+}
+
+/*
+ * Enable or disable coalescing for one standard ID on the default channel.
+ * canManager_init enables it for the setpoint and PID tuning commands.
+ */
+bool canManager_setCoalescing(uint32_t id, bool enabled)
+{
+    return canChannel_setCoalescing(defaultChannel, id, enabled);
+}
+
+/*
+ * Latest-value TX mailbox for one standard ID on the default channel.
+ * canManager_init enables it for the status messages.
+ */
+bool canManager_setTxMailbox(uint32_t id, bool enabled)
+{
+    return canChannel_setTxMailbox(defaultChannel, id, enabled);
+}
+
+/*
+ * Drop every queued TX frame on the default channel
+ */
+uint32_t canManager_abortTx(void)
+{
+    return canChannel_abortTx(defaultChannel);
+}
+
+/*
+ * Fault confinement state of the default channel
+ */
+canBusState_t canManager_getBusState(void)
+{
+    return canChannel_getBusState(defaultChannel);
+}
+
+/*
+ * Register handler for one message ID on the default channel.
+ * canManager_init restores the built-in handlers only.
+ */
+bool canManager_registerHandler(uint32_t id, bool extended, canRxHandler_t handler)
+{
+    return canChannel_registerHandler(defaultChannel, id, extended, handler);
+}
+
+/*
+ * Remove handler for one message ID on the default channel
+ */
+bool canManager_unregisterHandler(uint32_t id, bool extended)
+{
+    return canChannel_unregisterHandler(defaultChannel, id, extended);
+}
+
+/*
+ * Run the default channel's handler and RX callback for one frame
+ */
+void canManager_dispatchFrame(const canFrame_t* frame)
+{
+    canChannel_dispatchFrame(defaultChannel, frame);
+}
+
+/*
+ * Get statistics of the default channel
+ */
+const canStats_t* canManager_getStats(void)
+{
+    return canChannel_getStats(defaultChannel);
+}
+
+/*
+ * Statistics for one message ID on the default channel
+ */
+const canIdStats_t* canManager_getIdStats(uint32_t id, bool extended)
+{
+    return canChannel_getIdStats(defaultChannel, id, extended);
+}
+
+/*
+ * Process messages received on the default channel
+ */
+void canManager_processMessages(void)
+{
+    canChannel_processMessages(defaultChannel);
+}
+
+/*
+ * Send temperature status message
+ */
+canStatus_t canManager_sendTempStatus(float temperature, uint8_t status)
+{
+    canFrame_t* frame = canManager_reserveStatus(CAN_DB_TEMP_STATUS_ID, CAN_DB_TEMP_STATUS_LENGTH,
+                                                 CAN_DB_TEMP_STATUS_EXTENDED, false);
+    canDbTempStatus_t msg;
+    
+    msg.temperature = temperature;
+    msg.status = status;
+    (void)canDb_packTempStatus(&msg, frame->data);
+    
+    return canManager_commitStatus(CAN_TX_SLOT_TEMP, frame);
+}
+
+/*
+ * Send pump status message
+ */
+canStatus_t canManager_sendPumpStatus(float dutyCycle, uint8_t state, bool enabled)
+{
+    canFrame_t* frame = canManager_reserveStatus(CAN_DB_PUMP_STATUS_ID, CAN_DB_PUMP_STATUS_LENGTH,
+                                                 CAN_DB_PUMP_STATUS_EXTENDED, false);
+    canDbPumpStatus_t msg;
+    
+    msg.dutyCycle = dutyCycle;
+    msg.state = state;
+    msg.enabled = enabled ? 1U : 0U;
+    (void)canDb_packPumpStatus(&msg, frame->data);
+    
+    return canManager_commitStatus(CAN_TX_SLOT_PUMP, frame);
+}
+
+/*
+ * Send fan status message
+ */
+canStatus_t canManager_sendFanStatus(float dutyCycle, uint8_t state, bool enabled)
+{
+    canFrame_t* frame = canManager_reserveStatus(CAN_DB_FAN_STATUS_ID, CAN_DB_FAN_STATUS_LENGTH,
+                                                 CAN_DB_FAN_STATUS_EXTENDED, false);
+    canDbFanStatus_t msg;
+    
+    msg.dutyCycle = dutyCycle;
+    msg.state = state;
+    msg.enabled = enabled ? 1U : 0U;
+    (void)canDb_packFanStatus(&msg, frame->data);
+    
+    return canManager_commitStatus(CAN_TX_SLOT_FAN, frame);
+}
+
+/*
+ * Send system status message
+ */
+canStatus_t canManager_sendSystemStatus(uint8_t systemState, ignitionState_t ignition, levelState_t coolantLevel, uint8_t faultCode)
+{
+    canFrame_t* frame = canManager_reserveStatus(CAN_DB_SYSTEM_STATUS_ID, CAN_DB_SYSTEM_STATUS_LENGTH,
+                                                 CAN_DB_SYSTEM_STATUS_EXTENDED, false);
+    canDbSystemStatus_t msg;
+    
+    msg.systemState = systemState;
+    msg.ignition = (uint8_t)ignition;
+    msg.coolantLevel = (uint8_t)coolantLevel;
+    msg.faultCode = faultCode;
+    (void)canDb_packSystemStatus(&msg, frame->data);
+    
+    return canManager_commitStatus(CAN_TX_SLOT_SYSTEM, frame);
+}
+
+/*
+ * Send PID parameters message
+ */
+canStatus_t canManager_sendPidParams(float kp, float ki, float kd, float setpoint)
+{
+    canFrame_t* frame = canManager_reserveStatus(CAN_DB_PID_PARAMS_ID, CAN_DB_PID_PARAMS_LENGTH,
+                                                 CAN_DB_PID_PARAMS_EXTENDED, false);
+    canDbPidParams_t msg;
+    
+    msg.kp = kp;
+    msg.ki = ki;
+    msg.kd = kd;
+    msg.setpoint = setpoint;
+    (void)canDb_packPidParams(&msg, frame->data);
+    
+    return canManager_commitStatus(CAN_TX_SLOT_PID, frame);
+}
+
+/*
+ * Send every periodic status signal in one CAN-FD frame with bit rate switch
+ */
+canStatus_t canManager_sendConsolidatedStatus(const canStatusSnapshot_t* snapshot)
+{
+    canFrame_t* frame;
+    canDbConsolidatedStatus_t msg;
+    
+    if (snapshot == NULL) {
+        return CAN_STATUS_ERROR;
+    }
+    
+    frame = canManager_reserveStatus(CAN_DB_CONSOLIDATED_STATUS_ID, CAN_DB_CONSOLIDATED_STATUS_LENGTH,
+                                     CAN_DB_CONSOLIDATED_STATUS_EXTENDED, true);
+    
+    msg.temperature = snapshot->temperature;
+    msg.tempStatus = snapshot->tempStatus;
+    msg.pumpState = snapshot->pumpState;
+    msg.pumpEnabled = snapshot->pumpEnabled ? 1U : 0U;
+    msg.fanState = snapshot->fanState;
+    msg.fanEnabled = snapshot->fanEnabled ? 1U : 0U;
+    msg.pumpDutyCycle = snapshot->pumpDutyCycle;
+    msg.fanDutyCycle = snapshot->fanDutyCycle;
+    msg.kp = snapshot->kp;
+    msg.ki = snapshot->ki;
+    msg.kd = snapshot->kd;
+    msg.setpoint = snapshot->setpoint;
+    (void)canDb_packConsolidatedStatus(&msg, frame->data);
+    
+    return canManager_commitStatus(CAN_TX_SLOT_CONSOLIDATED, frame);
+}
+
+/*
+ * Payload length in bytes for a DLC code (CAN-FD mapping above 8)
+ */
+uint8_t canManager_dlcToLength(uint8_t dlc)
+{
+    return (dlc <= CAN_FD_MAX_DLC) ? fdDlcLength[dlc] : (uint8_t)CAN_FD_MAX_DATA_LENGTH;
+}
+
+/*
+ * Smallest DLC code whose payload holds length bytes
+ */
+uint8_t canManager_lengthToDlc(uint8_t length)
+{
+    uint8_t dlc = 0U;
+    
+    while ((dlc < CAN_FD_MAX_DLC) && (fdDlcLength[dlc] < length)) {
+        dlc++;
+    }
+    
+    return dlc;
+}
+
+/*
+ * Payload length in bytes of a frame
+ */
+uint8_t canManager_frameLength(const canFrame_t* frame)
+{
+    if (!frame->fd) {
+        return (frame->dlc <= CAN_MAX_DATA_LENGTH) ? frame->dlc : (uint8_t)CAN_MAX_DATA_LENGTH;
+    }
+    
+    return canManager_dlcToLength(frame->dlc);
+}
+
+/*
+ * Send periodic CAN status messages, called once per main loop iteration
+ * (at least every CAN_SCHEDULE_TICK_MS). In periodic mode each message
+ * follows its own period and phase offset from the schedule table, timed
+ * by the time base; a late call sends each overdue message once and keeps
+ * its phase. In on-change mode a message goes out when one
+ * of its signals moves past the configured deadband or when its heartbeat
+ * expires.
+ */
+void canManager_periodicSend(void)
+{
+    canStatusSnapshot_t snapshot;
+    bool snapshotRead = false;
+    uint32_t nowMs = timeBase_nowMs();
+    uint32_t i;
+    
+    if (defaultChannel->config.txMode == CAN_TX_MODE_ON_CHANGE) {
+        canManager_readSnapshot(&snapshot);
+        canManager_sendOnChange(&snapshot);
+        return;
+    }
+    
+    for (i = 0U; i < CAN_SCHEDULE_SIZE; i++) {
+        canScheduleEntry_t* entry = &txSchedule[i];
+        
+        if (!canManager_scheduleActive(entry) || ((int32_t)(nowMs - entry->nextDueMs) < 0)) {
+            continue;
+        }
+        
+        if (!snapshotRead) {
+            canManager_readSnapshot(&snapshot);
+            snapshotRead = true;
+        }
+        canManager_sendSlot(entry->slot, &snapshot);
+        
+        while ((int32_t)(nowMs - entry->nextDueMs) >= 0) {
+            entry->nextDueMs += entry->periodMs;
+        }
+    }
+}
+
+/*
+ * Change the period and phase offset of one scheduled status message.
+ * Both must be multiples of CAN_SCHEDULE_TICK_MS and the offset below the
+ * period. canManager_init restores the default schedule.
+ */
+bool canManager_setSchedule(uint32_t id, uint32_t periodMs, uint32_t offsetMs)
+{
+    uint32_t i;
+    
+    if ((periodMs == 0U) || ((periodMs % CAN_SCHEDULE_TICK_MS) != 0U) ||
+        ((offsetMs % CAN_SCHEDULE_TICK_MS) != 0U) || (offsetMs >= periodMs)) {
+        return false;
+    }
+    
+    for (i = 0U; i < CAN_SCHEDULE_SIZE; i++) {
+        if (txSchedule[i].id == id) {
+            txSchedule[i].periodMs = periodMs;
+            txSchedule[i].offsetMs = offsetMs;
+            txSchedule[i].nextDueMs = scheduleStartMs + offsetMs;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+/*
+ * Worst case the active schedule puts on the bus in a single tick, found
+ * by walking one hyperperiod (LCM of all periods) tick by tick. Frame
+ * times use worst-case bit stuffing.
+ */
+void canManager_getScheduleReport(canScheduleReport_t* report)
+{
+    uint32_t hyperperiod = CAN_SCHEDULE_TICK_MS;
+    uint64_t worstBusNs = 0U;
+    uint32_t timeMs;
+    uint32_t i;
+    
+    if (report == NULL) {
+        return;
+    }
+    
+    memset(report, 0, sizeof(*report));
+    report->tickMs = CAN_SCHEDULE_TICK_MS;
+    
+    for (i = 0U; i < CAN_SCHEDULE_SIZE; i++) {
+        if (canManager_scheduleActive(&txSchedule[i])) {
+            uint32_t period = txSchedule[i].periodMs;
+            uint64_t lcm = ((uint64_t)hyperperiod / canManager_gcd(hyperperiod, period)) * period;
+            
+            hyperperiod = (lcm > CAN_SCHEDULE_HYPERPERIOD_MAX_MS) ? CAN_SCHEDULE_HYPERPERIOD_MAX_MS : (uint32_t)lcm;
+        }
+    }
+    report->hyperperiodMs = hyperperiod;
+    
+    for (timeMs = 0U; timeMs < hyperperiod; timeMs += CAN_SCHEDULE_TICK_MS) {
+        uint32_t frames = 0U;
+        uint64_t busNs = 0U;
+        
+        for (i = 0U; i < CAN_SCHEDULE_SIZE; i++) {
+            const canScheduleEntry_t* entry = &txSchedule[i];
+            
+            if (canManager_scheduleActive(entry) && canManager_scheduleDue(entry, timeMs)) {
+                canFrameBits_t bits = canTiming_worstCaseBits(entry->length, false, entry->fd, entry->fd);
+                
+                frames++;
+                busNs += canTiming_frameTimeNs(bits, defaultChannel->config.baudrate,
+                                               defaultChannel->config.dataBaudrate);
+            }
+        }
+        
+        if (frames > report->framesPerTickMax) {
+            report->framesPerTickMax = frames;
+        }
+        if (busNs > worstBusNs) {
+            worstBusNs = busNs;
+        }
+    }
+    
+    report->busTimePerTickMaxUs = (uint32_t)(worstBusNs / 1000U);
+    report->busLoadPermilleMax = (uint32_t)(worstBusNs / ((uint64_t)CAN_SCHEDULE_TICK_MS * 1000U));
+}
+
+/*
+ * Copy out the active periodic schedule, e.g. as the message set for an
+ * offline response-time analysis. Returns the number of entries written.
+ */
+uint32_t canManager_getSchedule(canScheduleInfo_t* entries, uint32_t maxEntries)
+{
+    uint32_t count = 0U;
+    uint32_t i;
+    
+    if (entries == NULL) {
+        return 0U;
+    }
+    
+    for (i = 0U; (i < CAN_SCHEDULE_SIZE) && (count < maxEntries); i++) {
+        if (canManager_scheduleActive(&txSchedule[i])) {
+            entries[count].id = txSchedule[i].id;
+            entries[count].length = txSchedule[i].length;
+            entries[count].fd = txSchedule[i].fd;
+            entries[count].periodMs = txSchedule[i].periodMs;
+            entries[count].offsetMs = txSchedule[i].offsetMs;
+            count++;
+        }
+    }
+    
+    return count;
+}
+
+/*
+ * Debug tap that prints every frame to stdout
+ */
+void canManager_printTap(const canFrame_t* frame, bool tx)
+{
+    uint8_t length = canManager_frameLength(frame);
+    
+    printf("CAN %s%s: ID=0x%03X, DLC=%d, Data=", tx ? "TX" : "RX", frame->fd ? " FD" : "",
+           frame->id, frame->dlc);
+    for (int i = 0; i < length; i++) {
+        printf("%02X ", frame->data[i]);
+    }
+    printf("\n");
+}
+
+/*
+ * Convert float to CAN data bytes (little endian)
+ */
+void canManager_floatToBytes(float value, uint8_t* data)
+{
+    union {
+        float f;
+        uint8_t bytes[4];
+    } converter;
+    
+    converter.f = value;
+    
+    data[0] = converter.bytes[0];
+    data[1] = converter.bytes[1];
+    data[2] = converter.bytes[2];
+    data[3] = converter.bytes[3];
+}
+
+/*
+ * Convert CAN data bytes to float (little endian)
+ */
+float canManager_bytesToFloat(const uint8_t* data)
+{
+    union {
+        float f;
+        uint8_t bytes[4];
+    } converter;
+    
+    converter.bytes[0] = data[0];
+    converter.bytes[1] = data[1];
+    converter.bytes[2] = data[2];
+    converter.bytes[3] = data[3];
+    
+    return converter.f;
+}
+
+/*
+ * Handle setpoint command message
+ */
+static void canManager_handleSetpointCmd(const canFrame_t* frame)
+{
+    canDbSetpointCmd_t msg;
+    
+    if (canDb_unpackSetpointCmd(&msg, frame->data, canManager_frameLength(frame))) {
+        if (!pid_setSetpoint(msg.setpoint)) {
+            printf("CAN: Failed to update setpoint\n");
+        }
+    }
+}
+
+/*
+ * Handle PID tuning command message
+ */
+static void canManager_handlePidTuneCmd(const canFrame_t* frame)
+{
+    canDbPidTuneCmd_t msg;
+    
+    if (canDb_unpackPidTuneCmd(&msg, frame->data, canManager_frameLength(frame))) {
+        if (!pid_setGains(msg.kp, msg.ki, msg.kd)) {
+            printf("CAN: Failed to update PID gains\n");
+        }
+    }
+}
+
+/*
+ * Handle system command message
+ */
+static void canManager_handleSystemCmd(const canFrame_t* frame)
+{
+    canDbSystemCmd_t msg;
+    
+    if (canDb_unpackSystemCmd(&msg, frame->data, canManager_frameLength(frame))) {
+        uint8_t command = msg.command;
+        
+        switch (command) {
+            case 0x01:
+                printf("CAN: System reset command received\n");
+                pid_reset();
+                break;
+                
+            case 0x02:
+                printf("CAN: Emergency stop command received\n");
+                pump_enable(false);
+                fan_enable(false);
+                break;
+                
+            case 0x03:
+                printf("CAN: System enable command received\n");
+                pump_enable(true);
+                fan_enable(true);
+                break;
+                
+            default:
+                printf("CAN: Unknown system command: 0x%02X\n", command);
+                break;
+        }
+    }
+}
+
+/*
+ * CAN receive callback function
+ */
+void can_rx_callback(const canFrame_t* frame)
+{
+    printf("CAN RX Callback: ID=0x%03X, DLC=%d\n", frame->id, frame->dlc);
+}
+
+
+/*
+ * Move frames from a polled backend into the RX queue. A polled backend is
+ * the RX queue producer, so it must not be combined with a receive thread
+ * calling canChannel_enqueueRxFrame on the same channel.
+ */
+static void canManager_pollTransport(canChannel_t* channel)
+{
+    canFrame_t frame;
+    const canTransport_t* transport = channel->transport;
+    
+    if ((transport == NULL) || (transport->recv == NULL)) {
+        return;
+    }
+    
+    /* Stop while the queue is full so the backend keeps what it holds */
+    while ((canRing_count(&channel->rxQueue) < canRing_depth(&channel->rxQueue)) &&
+           (transport->recv(channel->config.transportContext, &frame) == CAN_STATUS_OK)) {
+        if (canChannel_enqueueRxFrame(channel, &frame) != CAN_STATUS_OK) {
+            break;
+        }
+    }
+}
+
+/*
+ * Hand a transmitted or received frame to the channel's debug tap and, on
+ * the default channel, to the capture log (which takes a single producer)
+ */
+static void canManager_tapFrame(const canChannel_t* channel, const canFrame_t* frame, bool tx)
+{
+    if (channel->config.tap != NULL) {
+        channel->config.tap(frame, tx);
+    }
+    
+    if (channel == defaultChannel) {
+        canCapture_record(frame, tx);
+    }
+}
+
+/*
+ * Close the bus load window once it is CAN_BUS_LOAD_WINDOW_US old and
+ * publish its load. Windows stay aligned to the channel's start; whole
+ * windows that passed without any frame recorded were idle.
+ */
+static void canManager_rollBusWindow(canChannel_t* channel, uint64_t now)
+{
+    uint64_t elapsed = now - channel->busWindowStartUs;
+    
+    if ((now < channel->busWindowStartUs) || (elapsed < CAN_BUS_LOAD_WINDOW_US)) {
+        return;
+    }
+    
+    channel->stats.busLoadPermille = (elapsed < (2U * CAN_BUS_LOAD_WINDOW_US)) ?
+        (uint32_t)(channel->busWindowTimeNs / CAN_BUS_LOAD_WINDOW_US) : 0U;
+    channel->busWindowStartUs += (elapsed / CAN_BUS_LOAD_WINDOW_US) * CAN_BUS_LOAD_WINDOW_US;
+    channel->busWindowTimeNs = 0U;
+}
+
+/*
+ * Account one frame on the bus: bus time for the load estimate, plus the
+ * per-ID count and cycle time. Jitter is the deviation of each cycle from
+ * the mean cycle, smoothed with gain 1/16 as in RFC 3550.
+ */
+static void canManager_recordFrame(canChannel_t* channel, const canFrame_t* frame, bool tx, uint64_t timestampUs)
+{
+    uint32_t frameTimeNs = canTiming_frameTimeNs(canTiming_frameBits(frame),
+                                                 channel->config.baudrate, channel->config.dataBaudrate);
+    canIdStats_t* entry = canManager_findIdStats(channel, frame);
+    
+    canManager_rollBusWindow(channel, timeBase_nowUs());
+    channel->busTimeNs += frameTimeNs;
+    channel->busWindowTimeNs += frameTimeNs;
+    
+    if (entry == NULL) {
+        if ((channel->idStatsCount >= CAN_ID_STATS_MAX) ||
+            (!frame->extended && (frame->id >= CAN_STD_ID_COUNT))) {
+            channel->stats.idStatsDropped++;
+            return;
+        }
+        entry = &channel->idStats[channel->idStatsCount];
+        entry->id = frame->id;
+        entry->extended = frame->extended;
+        entry->cycleMinUs = UINT32_MAX;
+        if (!frame->extended) {
+            channel->stdIdStatsIndex[frame->id] = (uint8_t)channel->idStatsCount;
+        }
+        channel->idStatsCount++;
+    } else if (timestampUs >= entry->lastTimestampUs) {
+        uint32_t cycle = (uint32_t)(timestampUs - entry->lastTimestampUs);
+        uint32_t meanCycle = (entry->cycleSamples > 0U) ?
+            (uint32_t)(entry->cycleTotalUs / entry->cycleSamples) : cycle;
+        uint32_t delta = (cycle > meanCycle) ? (cycle - meanCycle) : (meanCycle - cycle);
+        
+        if (cycle < entry->cycleMinUs) {
+            entry->cycleMinUs = cycle;
+        }
+        if (cycle > entry->cycleMaxUs) {
+            entry->cycleMaxUs = cycle;
+        }
+        entry->cycleTotalUs += cycle;
+        entry->cycleSamples++;
+        entry->jitterUs = (uint32_t)((((uint64_t)entry->jitterUs * 15U) + delta) / 16U);
+    }
+    
+    if (tx) {
+        entry->txCount++;
+    } else {
+        entry->rxCount++;
+    }
+    entry->lastTimestampUs = timestampUs;
+}
+
+/*
+ * Fault confinement after a transmit attempt, after ISO 11898-1: each
+ * error adds CAN_TEC_ERROR_STEP to the transmit error counter and each
+ * frame sent takes one off. The channel turns error passive at
+ * CAN_TEC_PASSIVE and goes bus off at CAN_TEC_BUS_OFF, or at once when
+ * the backend reports either state.
+ */
+static void canManager_recordTxStatus(canChannel_t* channel, canStatus_t status, uint32_t sent)
+{
+    uint32_t counter = (channel->txErrorCounter > sent) ? (channel->txErrorCounter - sent) : 0U;
+    
+    if (sent > 0U) {
+        channel->busOffStreak = 0U;
+    }
+    
+    switch (status) {
+        case CAN_STATUS_BUS_OFF:
+            counter = CAN_TEC_BUS_OFF;
+            channel->stats.errorCount++;
+            break;
+            
+        case CAN_STATUS_PASSIVE:
+            counter = (counter > CAN_TEC_PASSIVE) ? counter : CAN_TEC_PASSIVE;
+            channel->stats.errorCount++;
+            break;
+            
+        case CAN_STATUS_ERROR:
+            counter += CAN_TEC_ERROR_STEP;
+            channel->stats.errorCount++;
+            break;
+            
+        case CAN_STATUS_OK:
+        case CAN_STATUS_TIMEOUT:
+        case CAN_STATUS_OVERRUN:
+        default:
+            break;
+    }
+    
+    channel->txErrorCounter = counter;
+    if (counter >= CAN_TEC_BUS_OFF) {
+        canManager_enterBusOff(channel);
+    } else if (counter >= CAN_TEC_PASSIVE) {
+        if (channel->busState == CAN_BUS_STATE_ACTIVE) {
+            channel->busState = CAN_BUS_STATE_PASSIVE;
+            channel->stats.passiveCount++;
+        }
+    } else {
+        channel->busState = CAN_BUS_STATE_ACTIVE;
+    }
+}
+
+/*
+ * Stop transmitting until the recovery time. The backoff starts at
+ * CAN_BUS_OFF_BACKOFF_MIN_MS and doubles for every bus off that follows a
+ * recovery without a frame getting through, up to the maximum.
  */
-bool canManager_init(const canConfig_t* config)
+static void canManager_enterBusOff(canChannel_t* channel)
 {
-    bool initResult = false;
-
-    if (config == NULL) {
-        canConfig.baudrate = 250000;
+    uint32_t backoffMs = CAN_BUS_OFF_BACKOFF_MIN_MS;
+    uint32_t i;
+    
+    for (i = 0U; (i < channel->busOffStreak) && (backoffMs < CAN_BUS_OFF_BACKOFF_MAX_MS); i++) {
+        backoffMs *= 2U;
+    }
+    if (backoffMs > CAN_BUS_OFF_BACKOFF_MAX_MS) {
+        backoffMs = CAN_BUS_OFF_BACKOFF_MAX_MS;
     } else {
-        canConfig = *config;
+        channel->busOffStreak++;
     }
     
-    memset(&canStats, 0, sizeof(canStats));
+    channel->busState = CAN_BUS_STATE_BUS_OFF;
+    channel->txErrorCounter = CAN_TEC_BUS_OFF;
+    channel->busRecoveryUs = timeBase_nowUs() + ((uint64_t)backoffMs * 1000U);
+    channel->stats.busOffCount++;
+}
+
+/*
+ * Whether the channel may transmit; a bus-off channel whose backoff has
+ * expired recovers to error active with a cleared error counter
+ */
+static bool canManager_busAvailable(canChannel_t* channel)
+{
+    if (channel->busState != CAN_BUS_STATE_BUS_OFF) {
+        return true;
+    }
     
-    rxQueueHead = 0;
-    rxQueueTail = 0;
-    rxQueueCount = 0;
+    if (timeBase_nowUs() < channel->busRecoveryUs) {
+        return false;
+    }
     
-    initResult = true;
+    channel->busState = CAN_BUS_STATE_ACTIVE;
+    channel->txErrorCounter = 0U;
+    channel->stats.recoveryCount++;
     
-    canManager_setRxCallback(can_rx_callback);
+    return true;
+}
+
+/*
+ * Abort queued frames that waited longer than the TX timeout, keeping the
+ * order of the rest
+ */
+static void canManager_expireTx(canChannel_t* channel)
+{
+    uint64_t now = timeBase_nowUs();
+    uint64_t timeoutUs = (uint64_t)channel->config.txTimeoutMs * 1000U;
+    uint32_t kept = 0U;
+    uint32_t i;
     
-    return initResult;
+    for (i = 0U; i < channel->txQueueCount; i++) {
+        if ((now - channel->txQueueTime[i]) > timeoutUs) {
+            channel->stats.txTimeoutCount++;
+            continue;
+        }
+        if (kept != i) {
+            channel->txQueue[kept] = channel->txQueue[i];
+            channel->txQueueTime[kept] = channel->txQueueTime[i];
+        }
+        kept++;
+    }
+    
+    channel->txQueueCount = kept;
 }
 
 /*
- * Send CAN frame
+ * Per-ID statistics entry for a frame: table lookup for standard IDs,
+ * linear scan for extended IDs
  */
-canStatus_t canManager_sendFrame(const canFrame_t* frame)
+static canIdStats_t* canManager_findIdStats(canChannel_t* channel, const canFrame_t* frame)
 {
-    if (frame == NULL) {
-        return CAN_STATUS_ERROR;
+    uint32_t i;
+    
+    if (!frame->extended) {
+        if ((frame->id >= CAN_STD_ID_COUNT) || (channel->stdIdStatsIndex[frame->id] == CAN_ID_STATS_NONE)) {
+            return NULL;
+        }
+        return &channel->idStats[channel->stdIdStatsIndex[frame->id]];
     }
     
-    if (frame->dlc > 8) {
-        return CAN_STATUS_ERROR;
+    for (i = 0U; i < channel->idStatsCount; i++) {
+        if (channel->idStats[i].extended && (channel->idStats[i].id == frame->id)) {
+            return &channel->idStats[i];
+        }
     }
     
-    printf("CAN TX: ID=0x%03X, DLC=%d, Data=", frame->id, frame->dlc);
-    for (int i = 0; i < frame->dlc; i++) {
-        printf("%02X ", frame->data[i]);
+    return NULL;
+}
+
+/*
+ * E2E table entry protecting a frame's ID, CAN_E2E_NONE if unprotected
+ */
+static uint32_t canManager_findE2e(const canChannel_t* channel, const canFrame_t* frame)
+{
+    uint32_t i;
+    
+    for (i = 0U; i < channel->e2eCount; i++) {
+        if ((channel->e2eConfig[i].id == frame->id) && (channel->e2eConfig[i].extended == frame->extended)) {
+            return i;
+        }
     }
-    printf("\n");
     
-    canStats.txCount++;
+    return CAN_E2E_NONE;
+}
+
+/*
+ * Check a received frame against its E2E profile. Returns false (and
+ * counts the error) when the frame must not be dispatched.
+ */
+static bool canManager_checkE2e(canChannel_t* channel, const canFrame_t* frame)
+{
+    uint32_t e2e;
+    
+    if (channel->e2eCount == 0U) {
+        return true;
+    }
     
-    return CAN_STATUS_OK;
+    e2e = canManager_findE2e(channel, frame);
+    if (e2e == CAN_E2E_NONE) {
+        return true;
+    }
+    
+    switch (canE2e_check(&channel->e2eConfig[e2e], &channel->e2eState[e2e], frame)) {
+        case CAN_E2E_OK:
+            return true;
+            
+        case CAN_E2E_OK_LOST:
+            channel->stats.e2eLostCount++;
+            return true;
+            
+        case CAN_E2E_ERROR_LENGTH:
+            channel->stats.e2eLengthErrorCount++;
+            return false;
+            
+        case CAN_E2E_ERROR_CRC:
+            channel->stats.e2eCrcErrorCount++;
+            return false;
+            
+        case CAN_E2E_ERROR_REPEATED:
+        default:
+            channel->stats.e2eRepeatedCount++;
+            return false;
+    }
 }
 
 /*
- * Receive CAN frame (non-blocking)
+ * Position of the last frame of each coalesced ID among the next count
+ * queued frames; UINT32_MAX for IDs that do not occur
  */
-canStatus_t canManager_receiveFrame(canFrame_t* frame)
+static void canManager_findLastCoalesced(canChannel_t* channel, uint32_t count, uint32_t* lastPosition)
 {
-    if (frame == NULL) {
-        return CAN_STATUS_ERROR;
+    const canFrame_t* frame;
+    uint8_t slot;
+    uint32_t i;
+    
+    for (i = 0U; i < CAN_COALESCE_SLOTS; i++) {
+        lastPosition[i] = UINT32_MAX;
     }
     
-    if (canManager_dequeueRxFrame(frame)) {
-        canStats.rxCount++;
-        return CAN_STATUS_OK;
+    if (channel->coalesceCount == 0U) {
+        return;
     }
     
-    return CAN_STATUS_TIMEOUT;
+    for (i = 0U; i < count; i++) {
+        frame = canRing_peekAt(&channel->rxQueue, i);
+        if (frame == NULL) {
+            break;
+        }
+        slot = canManager_coalesceSlot(channel, frame);
+        if (slot != CAN_COALESCE_NONE) {
+            lastPosition[slot] = i;
+        }
+    }
 }
 
 /*
- * Register callback for received messages
+ * Coalescing slot of a frame's ID, or CAN_COALESCE_NONE. Extended IDs
+ * are not coalesced.
  */
-void canManager_setRxCallback(canRxCallback_t callback)
+static uint8_t canManager_coalesceSlot(const canChannel_t* channel, const canFrame_t* frame)
 {
-    rxCallback = callback;
+    if ((channel->coalesceCount == 0U) || frame->extended || (frame->id >= CAN_STD_ID_COUNT)) {
+        return CAN_COALESCE_NONE;
+    }
+    
+    return channel->coalesceIndex[frame->id];
 }
 
 /*
- * Get CAN statistics
+ * Park a received frame in its coalescing slot instead of dispatching it.
+ * A frame already parked there is superseded.
  */
-const canStats_t* canManager_getStats(void)
+static void canManager_coalesceFrame(canChannel_t* channel, uint8_t slot, const canFrame_t* frame)
 {
-    return &canStats;
+    if (channel->coalesceValid[slot]) {
+        canIdStats_t* entry = canManager_findIdStats(channel, frame);
+        
+        channel->stats.rxSupersededCount++;
+        if (entry != NULL) {
+            entry->supersededCount++;
+        }
+    }
+    channel->coalescePending[slot] = *frame;
+    channel->coalesceValid[slot] = true;
 }
 
 /*
- * Send temperature status message
+ * Dispatch the frame parked in one coalescing slot, if any
  */
-canStatus_t canManager_sendTempStatus(float temperature, uint8_t status)
+static void canManager_flushCoalescedSlot(canChannel_t* channel, uint8_t slot)
 {
-    canFrame_t frame;
-    
-    frame.id = CAN_MSG_TEMP_STATUS;
-    frame.dlc = 5;
-    frame.extended = false;
-    frame.remote = false;
-    
-    canManager_floatToBytes(temperature, &frame.data[0]);
-    frame.data[4] = status;
-    
-    return canManager_sendFrame(&frame);
+    if (channel->coalesceValid[slot]) {
+        channel->coalesceValid[slot] = false;
+        canChannel_dispatchFrame(channel, &channel->coalescePending[slot]);
+    }
 }
 
 /*
- * Send pump status message
+ * Dispatch the newest frame parked in each coalescing slot
  */
-canStatus_t canManager_sendPumpStatus(float dutyCycle, uint8_t state, bool enabled)
+static void canManager_flushCoalesced(canChannel_t* channel)
 {
-    canFrame_t frame;
-    
-    frame.id = CAN_MSG_PUMP_STATUS;
-    frame.dlc = 6;
-    frame.extended = false;
-    frame.remote = false;
-    
-    canManager_floatToBytes(dutyCycle, &frame.data[0]);
-    frame.data[4] = state;
-    frame.data[5] = enabled ? 1 : 0;
+    uint32_t i;
     
-    return canManager_sendFrame(&frame);
+    for (i = 0U; i < channel->coalesceCount; i++) {
+        canManager_flushCoalescedSlot(channel, (uint8_t)i);
+    }
 }
 
 /*
- * Send fan status message
+ * Histogram bucket for a latency: bucket 0 is below 1 us, bucket n covers
+ * [2^(n-1), 2^n) us, the last bucket collects everything above
  */
-canStatus_t canManager_sendFanStatus(float dutyCycle, uint8_t state, bool enabled)
+static uint32_t canManager_latencyBucket(uint64_t latencyUs)
 {
-    canFrame_t frame;
+    uint32_t bucket = 0U;
     
-    frame.id = CAN_MSG_FAN_STATUS;
-    frame.dlc = 6;
-    frame.extended = false;
-    frame.remote = false;
-    
-    canManager_floatToBytes(dutyCycle, &frame.data[0]);
-    frame.data[4] = state;
-    frame.data[5] = enabled ? 1 : 0;
+    while ((latencyUs > 0U) && (bucket < (CAN_LATENCY_BUCKETS - 1U))) {
+        latencyUs >>= 1;
+        bucket++;
+    }
     
-    return canManager_sendFrame(&frame);
+    return bucket;
 }
 
 /*
- * Send system status message
+ * Reserve a TX slot on the default channel for a status message and fill
+ * in its header; FD frames get bit rate switching and zeroed DLC padding
  */
-canStatus_t canManager_sendSystemStatus(uint8_t systemState, ignitionState_t ignition, levelState_t coolantLevel, uint8_t faultCode)
+static canFrame_t* canManager_reserveStatus(uint32_t id, uint8_t length, bool extended, bool fd)
 {
-    canFrame_t frame;
-    
-    frame.id = CAN_MSG_SYSTEM_STATUS;
-    frame.dlc = 4;
-    frame.extended = false;
-    frame.remote = false;
+    canFrame_t* frame = canChannel_reserveTx(defaultChannel);
     
-    frame.data[0] = systemState;
-    frame.data[1] = ignition;
-    frame.data[2] = coolantLevel;
-    frame.data[3] = faultCode;
+    frame->id = id;
+    frame->extended = extended;
+    frame->fd = fd;
+    frame->brs = fd;
+    frame->dlc = fd ? canManager_lengthToDlc(length) : length;
+    if (fd) {
+        memset(&frame->data[length], 0, (size_t)(canManager_frameLength(frame) - length));
+    }
     
-    return canManager_sendFrame(&frame);
+    return frame;
 }
 
 /*
- * Send PID parameters message
+ * Commit a reserved status frame and remember it as the last one sent for
+ * its message. In on-change mode a frame identical to the last one is
+ * suppressed (left uncommitted) until the heartbeat expires.
  */
-canStatus_t canManager_sendPidParams(float kp, float ki, float kd, float setpoint)
+static canStatus_t canManager_commitStatus(canTxSlot_t slot, canFrame_t* frame)
 {
-    canFrame_t frame;
+    canTxSlotState_t* state = &txSlots[slot];
+    bool onChange = (defaultChannel->config.txMode == CAN_TX_MODE_ON_CHANGE);
+    canStatus_t status;
     
-    frame.id = CAN_MSG_PID_PARAMS;
-    frame.dlc = 8;
-    frame.extended = false;
-    frame.remote = false;
+    if (onChange && state->valid &&
+        ((timeBase_nowMs() - state->lastTxMs) < defaultChannel->config.heartbeatMs) &&
+        (state->frame.dlc == frame->dlc) &&
+        (memcmp(state->frame.data, frame->data, canManager_frameLength(frame)) == 0)) {
+        defaultChannel->stats.txSuppressedCount++;
+        return CAN_STATUS_OK;
+    }
     
-    uint16_t kp_scaled = (uint16_t)(kp * 1000);
-    uint16_t ki_scaled = (uint16_t)(ki * 1000);
-    uint16_t kd_scaled = (uint16_t)(kd * 1000);
-    uint16_t setpoint_scaled = (uint16_t)(setpoint * 10);
+    /* Only on-change mode compares against the last frame; keep it unprotected */
+    if (onChange) {
+        state->frame = *frame;
+    }
     
-    frame.data[0] = (uint8_t)(kp_scaled & 0xFF);
-    frame.data[1] = (uint8_t)(kp_scaled >> 8);
-    frame.data[2] = (uint8_t)(ki_scaled & 0xFF);
-    frame.data[3] = (uint8_t)(ki_scaled >> 8);
-    frame.data[4] = (uint8_t)(kd_scaled & 0xFF);
-    frame.data[5] = (uint8_t)(kd_scaled >> 8);
-    frame.data[6] = (uint8_t)(setpoint_scaled & 0xFF);
-    frame.data[7] = (uint8_t)(setpoint_scaled >> 8);
+    status = canChannel_commitTx(defaultChannel, frame);
+    if (status == CAN_STATUS_OK) {
+        state->lastTxMs = timeBase_nowMs();
+        state->valid = true;
+    } else {
+        state->valid = false;
+    }
     
-    return canManager_sendFrame(&frame);
+    return status;
 }
 
 /*
- * Send periodic CAN status messages
+ * Whether a schedule entry applies to the current configuration: the
+ * consolidated FD frame and the classic status frames are alternatives
  */
-void canManager_periodicSend(void)
+static bool canManager_scheduleActive(const canScheduleEntry_t* entry)
 {
-    static uint32_t lastCanTxTime = 0;
-    static uint32_t currentTime = 0;
-    float kp, ki ,kd;
+    bool consolidated = defaultChannel->config.fdEnabled && defaultChannel->config.consolidatedStatus;
     
-    currentTime += MAIN_LOOP_DELAY;
-    
-    if (currentTime - lastCanTxTime >= CAN_TX_INTERVAL_MS) {
-        lastCanTxTime = currentTime;
-
-        tempReading_t tempReading = tempSensor_readValue();
-        pumpStatus_t pumpStatus = pump_getStatus();
-        fanStatus_t fanStatus = fan_getStatus();
-
-        pid_getGains(&kp, &ki, &kd);
-
-        canManager_sendTempStatus(tempReading.temperatureCelsius, tempReading.status);
+    return (entry->slot == CAN_TX_SLOT_CONSOLIDATED) == consolidated;
+}
 
-        float setpoint = pid_getSetpoint();
-        canManager_sendPidParams(kp, ki, kd, setpoint);
+/*
+ * Whether a schedule entry fires at the given time
+ */
+static bool canManager_scheduleDue(const canScheduleEntry_t* entry, uint32_t timeMs)
+{
+    return (timeMs >= entry->offsetMs) && (((timeMs - entry->offsetMs) % entry->periodMs) == 0U);
+}
 
-        canManager_sendPumpStatus(pumpStatus.pwmDutyCycle, pumpStatus.pumpState, pumpStatus.isEnabled);
-        canManager_sendFanStatus(fanStatus.pwmDutyCycle, fanStatus.fanState, fanStatus.isEnabled);
+/*
+ * Send the status message behind one schedule slot
+ */
+static void canManager_sendSlot(canTxSlot_t slot, const canStatusSnapshot_t* snapshot)
+{
+    switch (slot) {
+        case CAN_TX_SLOT_TEMP:
+            canManager_sendTempStatus(snapshot->temperature, snapshot->tempStatus);
+            break;
+            
+        case CAN_TX_SLOT_PUMP:
+            canManager_sendPumpStatus(snapshot->pumpDutyCycle, snapshot->pumpState, snapshot->pumpEnabled);
+            break;
+            
+        case CAN_TX_SLOT_FAN:
+            canManager_sendFanStatus(snapshot->fanDutyCycle, snapshot->fanState, snapshot->fanEnabled);
+            break;
+            
+        case CAN_TX_SLOT_PID:
+            canManager_sendPidParams(snapshot->kp, snapshot->ki, snapshot->kd, snapshot->setpoint);
+            break;
+            
+        case CAN_TX_SLOT_CONSOLIDATED:
+            canManager_sendConsolidatedStatus(snapshot);
+            break;
+            
+        case CAN_TX_SLOT_SYSTEM:
+        case CAN_TX_SLOT_COUNT:
+        default:
+            break;
     }
 }
 
 /*
- * Process received CAN messages
+ * Greatest common divisor
  */
-void canManager_processMessages(void)
+static uint32_t canManager_gcd(uint32_t a, uint32_t b)
 {
-    canFrame_t frame;
-    
-    while (canManager_receiveFrame(&frame) == CAN_STATUS_OK) {
-        printf("CAN RX: ID=0x%03X, DLC=%d, Data=", frame.id, frame.dlc);
-        for (int i = 0; i < frame.dlc; i++) {
-            printf("%02X ", frame.data[i]);
-        }
-        printf("\n");
+    while (b != 0U) {
+        uint32_t r = a % b;
         
-        switch (frame.id) {
-            case CAN_MSG_SETPOINT_CMD:
-                canManager_handleSetpointCmd(&frame);
-                break;
-                
-            case CAN_MSG_PID_TUNE_CMD:
-                canManager_handlePidTuneCmd(&frame);
-                break;
-                
-            case CAN_MSG_SYSTEM_CMD:
-                canManager_handleSystemCmd(&frame);
-                break;
-                
-            default:
-                break;
-        }
-        
-        if (rxCallback != NULL) {
-            rxCallback(&frame);
-        }
+        a = b;
+        b = r;
     }
+    
+    return a;
 }
 
 /*
- * Convert float to CAN data bytes (little endian)
+ * Whether a status message has never been sent or its heartbeat expired
  */
-void canManager_floatToBytes(float value, uint8_t* data)
+static bool canManager_slotDue(canTxSlot_t slot)
 {
-    union {
-        float f;
-        uint8_t bytes[4];
-    } converter;
-    
-    converter.f = value;
-    
-    data[0] = converter.bytes[0];
-    data[1] = converter.bytes[1];
-    data[2] = converter.bytes[2];
-    data[3] = converter.bytes[3];
+    return !txSlots[slot].valid || ((timeBase_nowMs() - txSlots[slot].lastTxMs) >= defaultChannel->config.heartbeatMs);
 }
 
 /*
- * Convert CAN data bytes to float (little endian)
+ * Whether a signal moved further than its deadband from the last sent value
  */
-float canManager_bytesToFloat(const uint8_t* data)
+static bool canManager_movedPast(float value, float reference, float deadband)
 {
-    union {
-        float f;
-        uint8_t bytes[4];
-    } converter;
-    
-    converter.bytes[0] = data[0];
-    converter.bytes[1] = data[1];
-    converter.bytes[2] = data[2];
-    converter.bytes[3] = data[3];
+    return ((value - reference) > deadband) || ((reference - value) > deadband);
+}
+
+/*
+ * Collect the current values of all periodic status signals
+ */
+static void canManager_readSnapshot(canStatusSnapshot_t* snapshot)
+{
+    tempReading_t tempReading = tempSensor_readValue();
+    pumpStatus_t pumpStatus = pump_getStatus();
+    fanStatus_t fanStatus = fan_getStatus();
     
-    return converter.f;
+    snapshot->temperature = tempReading.temperatureCelsius;
+    snapshot->tempStatus = tempReading.status;
+    snapshot->pumpDutyCycle = pumpStatus.pwmDutyCycle;
+    snapshot->pumpState = pumpStatus.pumpState;
+    snapshot->pumpEnabled = pumpStatus.isEnabled;
+    snapshot->fanDutyCycle = fanStatus.pwmDutyCycle;
+    snapshot->fanState = fanStatus.fanState;
+    snapshot->fanEnabled = fanStatus.isEnabled;
+    pid_getGains(&snapshot->kp, &snapshot->ki, &snapshot->kd);
+    snapshot->setpoint = pid_getSetpoint();
 }
 
 /*
- * Handle setpoint command message
+ * On-change transmission: send each status message whose signals moved
+ * past their deadband or whose heartbeat expired. The system status is
+ * event driven (sm_update), so only its heartbeat is handled here.
  */
-static void canManager_handleSetpointCmd(const canFrame_t* frame)
+static void canManager_sendOnChange(const canStatusSnapshot_t* snapshot)
 {
-    if (frame->dlc >= 4) {
-        float newSetpoint = canManager_bytesToFloat(&frame->data[0]);
-        
-        if (!pid_setSetpoint(newSetpoint)) {
-            printf("CAN: Failed to update setpoint\n");
+    const canTxDeadband_t* deadband = &defaultChannel->config.deadband;
+    canStatusSnapshot_t* last = &lastSentSignals;
+    bool tempDue = canManager_slotDue(CAN_TX_SLOT_TEMP) ||
+                   canManager_movedPast(snapshot->temperature, last->temperature, deadband->temperature) ||
+                   (snapshot->tempStatus != last->tempStatus);
+    bool pidDue = canManager_slotDue(CAN_TX_SLOT_PID) ||
+                  canManager_movedPast(snapshot->kp, last->kp, deadband->pidGain) ||
+                  canManager_movedPast(snapshot->ki, last->ki, deadband->pidGain) ||
+                  canManager_movedPast(snapshot->kd, last->kd, deadband->pidGain) ||
+                  canManager_movedPast(snapshot->setpoint, last->setpoint, deadband->setpoint);
+    bool pumpDue = canManager_slotDue(CAN_TX_SLOT_PUMP) ||
+                   canManager_movedPast(snapshot->pumpDutyCycle, last->pumpDutyCycle, deadband->dutyCycle) ||
+                   (snapshot->pumpState != last->pumpState) || (snapshot->pumpEnabled != last->pumpEnabled);
+    bool fanDue = canManager_slotDue(CAN_TX_SLOT_FAN) ||
+                  canManager_movedPast(snapshot->fanDutyCycle, last->fanDutyCycle, deadband->dutyCycle) ||
+                  (snapshot->fanState != last->fanState) || (snapshot->fanEnabled != last->fanEnabled);
+    
+    if (defaultChannel->config.fdEnabled && defaultChannel->config.consolidatedStatus) {
+        if ((tempDue || pidDue || pumpDue || fanDue || canManager_slotDue(CAN_TX_SLOT_CONSOLIDATED)) &&
+            (canManager_sendConsolidatedStatus(snapshot) == CAN_STATUS_OK)) {
+            *last = *snapshot;
+        }
+    } else {
+        if (tempDue && (canManager_sendTempStatus(snapshot->temperature, snapshot->tempStatus) == CAN_STATUS_OK)) {
+            last->temperature = snapshot->temperature;
+            last->tempStatus = snapshot->tempStatus;
+        }
+        if (pidDue && (canManager_sendPidParams(snapshot->kp, snapshot->ki, snapshot->kd,
+                                                snapshot->setpoint) == CAN_STATUS_OK)) {
+            last->kp = snapshot->kp;
+            last->ki = snapshot->ki;
+            last->kd = snapshot->kd;
+            last->setpoint = snapshot->setpoint;
+        }
+        if (pumpDue && (canManager_sendPumpStatus(snapshot->pumpDutyCycle, snapshot->pumpState,
+                                                  snapshot->pumpEnabled) == CAN_STATUS_OK)) {
+            last->pumpDutyCycle = snapshot->pumpDutyCycle;
+            last->pumpState = snapshot->pumpState;
+            last->pumpEnabled = snapshot->pumpEnabled;
+        }
+        if (fanDue && (canManager_sendFanStatus(snapshot->fanDutyCycle, snapshot->fanState,
+                                                snapshot->fanEnabled) == CAN_STATUS_OK)) {
+            last->fanDutyCycle = snapshot->fanDutyCycle;
+            last->fanState = snapshot->fanState;
+            last->fanEnabled = snapshot->fanEnabled;
         }
     }
+    
+    if (txSlots[CAN_TX_SLOT_SYSTEM].valid && canManager_slotDue(CAN_TX_SLOT_SYSTEM)) {
+        canFrame_t* frame = canChannel_reserveTx(defaultChannel);
+    
+        *frame = txSlots[CAN_TX_SLOT_SYSTEM].frame;
+        canManager_commitStatus(CAN_TX_SLOT_SYSTEM, frame);
+    }
 }
 
 /*
- * Handle PID tuning command message
+ * Check a frame against the CAN / CAN-FD format rules: classic frames carry
+ * at most 8 bytes, FD frames need FD enabled and have no remote form, and
+ * bit rate switching only exists on FD frames.
  */
-static void canManager_handlePidTuneCmd(const canFrame_t* frame)
+static bool canManager_validateFrame(const canChannel_t* channel, const canFrame_t* frame)
 {
-    if (frame->dlc >= 8) {
-        uint16_t kp_scaled = ((uint16_t)frame->data[1] << 8) | frame->data[0];
-        uint16_t ki_scaled = ((uint16_t)frame->data[3] << 8) | frame->data[2];
-        uint16_t kd_scaled = ((uint16_t)frame->data[5] << 8) | frame->data[4];
-        
-        float kp = (float)kp_scaled / 1000.0f;
-        float ki = (float)ki_scaled / 1000.0f;
-        float kd = (float)kd_scaled / 1000.0f;
-        
-        if (!pid_setGains(kp, ki, kd)) {
-            printf("CAN: Failed to update PID gains\n");
-        }
+    if (!frame->fd) {
+        return (frame->dlc <= CAN_MAX_DATA_LENGTH) && !frame->brs;
     }
+    
+    return channel->config.fdEnabled && (frame->dlc <= CAN_FD_MAX_DLC) && !frame->remote;
 }
 
 /*
- * Handle system command message
+ * Bus arbitration key: lower value wins. Compares the 11-bit base ID first,
+ * then IDE (standard beats extended), then the 18-bit extension, then RTR
+ * (data beats remote).
  */
-static void canManager_handleSystemCmd(const canFrame_t* frame)
+uint32_t canManager_arbitrationKey(const canFrame_t* frame)
 {
-    if (frame->dlc >= 1) {
-        uint8_t command = frame->data[0];
-        
-        switch (command) {
-            case 0x01:
-                printf("CAN: System reset command received\n");
-                pid_reset();
-                break;
-                
-            case 0x02:
-                printf("CAN: Emergency stop command received\n");
-                pump_enable(false);
-                fan_enable(false);
-                break;
-                
-            case 0x03:
-                printf("CAN: System enable command received\n");
-                pump_enable(true);
-                fan_enable(true);
-                break;
-                
-            default:
-                printf("CAN: Unknown system command: 0x%02X\n", command);
-                break;
-        }
+    uint32_t key;
+    
+    if (frame->extended) {
+        key = (((frame->id >> 18) & 0x7FFU) << 20) | (1U << 19) | ((frame->id & 0x3FFFFU) << 1);
+    } else {
+        key = (frame->id & 0x7FFU) << 20;
     }
+    
+    return key | (frame->remote ? 1U : 0U);
 }
 
 /*
- * CAN receive callback function
+ * Hash an extended ID into the handler table (32-bit integer finalizer,
+ * so J1939-style IDs that differ only in PGN or source address spread out)
  */
-void can_rx_callback(const canFrame_t* frame)
+static uint32_t canManager_extHash(uint32_t id)
 {
-    printf("CAN RX Callback: ID=0x%03X, DLC=%d\n", frame->id, frame->dlc);
+    uint32_t x = id;
+    
+    x ^= x >> 16;
+    x *= 0x7FEB352DU;
+    x ^= x >> 15;
+    x *= 0x846CA68BU;
+    x ^= x >> 16;
+    
+    return x & (CAN_EXT_HANDLER_SLOTS - 1U);
 }
 
 /*
- * Queue received frame for processing
+ * Find handler for a received frame
  */
-static bool canManager_queueRxFrame(const canFrame_t* frame)
+static canRxHandler_t canManager_lookupHandler(const canChannel_t* channel, const canFrame_t* frame)
 {
-    if (rxQueueCount >= CAN_RX_QUEUE_SIZE) {
-        return false;
+    uint32_t slot;
+    uint32_t probe;
+    
+    if (!frame->extended) {
+        return (frame->id < CAN_STD_ID_COUNT) ? channel->stdHandlers[frame->id] : NULL;
     }
     
-    rxQueue[rxQueueHead] = *frame;
-    rxQueueHead = (rxQueueHead + 1) % CAN_RX_QUEUE_SIZE;
-    rxQueueCount++;
+    slot = canManager_extHash(frame->id);
+    for (probe = 0U; probe < CAN_EXT_HANDLER_SLOTS; probe++) {
+        const canExtHandlerSlot_t* entry = &channel->extHandlers[slot];
+        
+        if (!entry->used) {
+            break;
+        }
+        if (!entry->deleted && (entry->id == frame->id)) {
+            return entry->handler;
+        }
+        slot = (slot + 1U) & (CAN_EXT_HANDLER_SLOTS - 1U);
+    }
     
-    return true;
+    return NULL;
+}
+
+/*
+ * Precompute the first matching filter for every standard ID so the RX
+ * fast path is a single table load; extended filters are kept as a list.
+ * Backends that filter in hardware get the active filters as well.
+ */
+static void canManager_rebuildFilters(canChannel_t* channel)
+{
+    uint32_t id;
+    uint32_t i;
+    
+    channel->filtersEnabled = false;
+    channel->extFilterCount = 0U;
+    
+    for (i = 0U; i < CAN_FILTER_BANK_SIZE; i++) {
+        if (channel->filterActive[i]) {
+            channel->filtersEnabled = true;
+            if (channel->filterBank[i].extended) {
+                channel->extFilterList[channel->extFilterCount] = (uint8_t)i;
+                channel->extFilterCount++;
+            }
+        }
+    }
+    
+    for (id = 0U; id < CAN_STD_ID_COUNT; id++) {
+        channel->stdFilterMatch[id] = CAN_FILTER_REJECT;
+        for (i = 0U; i < CAN_FILTER_BANK_SIZE; i++) {
+            if (channel->filterActive[i] && !channel->filterBank[i].extended &&
+                (((id ^ channel->filterBank[i].id) & channel->filterBank[i].mask) == 0U)) {
+                channel->stdFilterMatch[id] = (uint8_t)i;
+                break;
+            }
+        }
+    }
+    
+    if ((channel->transport != NULL) && (channel->transport->setFilters != NULL)) {
+        canFilter_t active[CAN_FILTER_BANK_SIZE];
+        uint32_t count = 0U;
+    
+        for (i = 0U; i < CAN_FILTER_BANK_SIZE; i++) {
+            if (channel->filterActive[i]) {
+                active[count] = channel->filterBank[i];
+                count++;
+            }
+        }
+        channel->transport->setFilters(channel->config.transportContext, active, count);
+    }
 }
 
 /*
- * Dequeue received frame for processing
+ * Run a frame through the acceptance filter bank
  */
-static bool canManager_dequeueRxFrame(canFrame_t* frame)
+static bool canManager_acceptFrame(canChannel_t* channel, const canFrame_t* frame)
 {
-    if (rxQueueCount == 0) {
+    uint8_t match = CAN_FILTER_REJECT;
+    uint32_t i;
+    
+    if (!channel->filtersEnabled) {
+        return true;
+    }
+    
+    if (!frame->extended) {
+        if (frame->id < CAN_STD_ID_COUNT) {
+            match = channel->stdFilterMatch[frame->id];
+        }
+    } else {
+        for (i = 0U; i < channel->extFilterCount; i++) {
+            const canFilter_t* filter = &channel->filterBank[channel->extFilterList[i]];
+            
+            if (((frame->id ^ filter->id) & filter->mask) == 0U) {
+                match = channel->extFilterList[i];
+                break;
+            }
+        }
+    }
+    
+    if (match == CAN_FILTER_REJECT) {
         return false;
     }
     
-    *frame = rxQueue[rxQueueTail];
-    rxQueueTail = (rxQueueTail + 1) % CAN_RX_QUEUE_SIZE;
-    rxQueueCount--;
+    atomic_fetch_add_explicit(&channel->filterHits[match], 1U, memory_order_relaxed);
     
     return true;
 }
\ No newline at end of file
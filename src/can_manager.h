@@ -12,51 +12,292 @@
 #define CAN_MSG_PID_PARAMS          0x104
 #define CAN_MSG_IGNITION_STATUS     0x105
 #define CAN_MSG_COOLANT_LEVEL       0x106
+#define CAN_MSG_CONSOLIDATED_STATUS 0x110
 #define CAN_MSG_SETPOINT_CMD        0x200
 #define CAN_MSG_PID_TUNE_CMD        0x201
 #define CAN_MSG_SYSTEM_CMD          0x202
+#define CAN_MSG_DIAG_REQUEST        0x7E0
+#define CAN_MSG_DIAG_RESPONSE       0x7E8
+#define CAN_MSG_XCP_CRO             0x7F0
+#define CAN_MSG_XCP_DTO             0x7F1
+
+#define CAN_MAX_DATA_LENGTH         (8U)
+#define CAN_FD_MAX_DATA_LENGTH      (64U)
+#define CAN_FD_MAX_DLC              (15U)
+
+#define CAN_STD_ID_COUNT            (2048U)
+#define CAN_EXT_ID_MASK             (0x1FFFFFFFU)
+#ifndef CAN_EXT_HANDLER_BITS
+#define CAN_EXT_HANDLER_BITS        (6U)
+#endif
+#define CAN_EXT_HANDLER_SLOTS       (1U << CAN_EXT_HANDLER_BITS)
+
+#ifndef CAN_FILTER_BANK_SIZE
+#define CAN_FILTER_BANK_SIZE        (16U)
+#endif
+
+#define CAN_RX_QUEUE_DEPTH_DEFAULT  (32U)
+#ifndef CAN_TX_QUEUE_DEPTH
+#define CAN_TX_QUEUE_DEPTH          (32U)
+#endif
+#ifndef CAN_RX_QUEUE_DEPTH_MAX
+#define CAN_RX_QUEUE_DEPTH_MAX      (256U)
+#endif
+
+#ifndef CAN_CHANNELS_MAX
+#define CAN_CHANNELS_MAX            (3U)
+#endif
+#define CAN_CHANNEL_DEFAULT         (0U)
+
+#ifndef CAN_COALESCE_SLOTS
+#define CAN_COALESCE_SLOTS          (8U)
+#endif
+
+#ifndef CAN_ID_STATS_MAX
+#define CAN_ID_STATS_MAX            (64U)
+#endif
+#define CAN_LATENCY_BUCKETS         (16U)
+#define CAN_BUS_LOAD_WINDOW_US      (1000000U)
+
+#define CAN_SCHEDULE_TICK_MS        (100U)
+#define CAN_SCHEDULE_HYPERPERIOD_MAX_MS (3600000U)
+#define CAN_TX_HEARTBEAT_MS_DEFAULT (10000U)
+#define CAN_TX_TIMEOUT_MS_DEFAULT   (1000U)
+
+/* Fault confinement (ISO 11898-1 transmit error counter thresholds) */
+#define CAN_TEC_ERROR_STEP          (8U)
+#define CAN_TEC_PASSIVE             (128U)
+#define CAN_TEC_BUS_OFF             (256U)
+#define CAN_BUS_OFF_BACKOFF_MIN_MS  (10U)
+#define CAN_BUS_OFF_BACKOFF_MAX_MS  (1000U)
+#define CAN_TX_DEADBAND_TEMP        (0.5f)
+#define CAN_TX_DEADBAND_DUTY        (1.0f)
+#define CAN_TX_DEADBAND_GAIN        (0.001f)
+#define CAN_TX_DEADBAND_SETPOINT    (0.1f)
 
 typedef struct {
     uint32_t id;
     uint8_t dlc;
-    uint8_t data[8];
+    uint8_t data[CAN_FD_MAX_DATA_LENGTH];
     bool extended;
     bool remote;
+    bool fd;
+    bool brs;
+    uint64_t timestampUs;
 } canFrame_t;
 
+typedef struct {
+    uint32_t id;
+    uint32_t mask;
+    bool extended;
+} canFilter_t;
+
+typedef struct canTransport canTransport_t;
+typedef struct canChannel canChannel_t;
+typedef struct canE2eConfig canE2eConfig_t;
+
+typedef void (*canFrameTap_t)(const canFrame_t* frame, bool tx);
+
+typedef enum {
+    CAN_TX_MODE_PERIODIC = 0,
+    CAN_TX_MODE_ON_CHANGE
+} canTxMode_t;
+
+typedef struct {
+    float temperature;
+    float dutyCycle;
+    float pidGain;
+    float setpoint;
+} canTxDeadband_t;
+
+typedef enum {
+    CAN_BUS_STATE_ACTIVE = 0,
+    CAN_BUS_STATE_PASSIVE,
+    CAN_BUS_STATE_BUS_OFF
+} canBusState_t;
+
 typedef struct {
     uint32_t baudrate;
+    uint32_t rxQueueDepth;
+    const canTransport_t* transport;
+    void* transportContext;
+    canFrameTap_t tap;
+    bool fdEnabled;
+    uint32_t dataBaudrate;
+    bool consolidatedStatus;
+    canTxMode_t txMode;
+    uint32_t heartbeatMs;
+    canTxDeadband_t deadband;
+    uint32_t txTimeoutMs;
 } canConfig_t;
 
+typedef struct {
+    uint32_t id;
+    bool extended;
+    uint32_t txCount;
+    uint32_t rxCount;
+    uint32_t cycleMinUs;
+    uint32_t cycleAvgUs;
+    uint32_t cycleMaxUs;
+    uint32_t jitterUs;
+    uint64_t lastTimestampUs;
+    uint64_t cycleTotalUs;
+    uint32_t cycleSamples;
+    uint32_t supersededCount;
+} canIdStats_t;
+
 typedef struct {
     uint32_t txCount;
     uint32_t rxCount;
     uint32_t errorCount;
     uint32_t busOffCount;
+    uint32_t rxOverrunCount;
+    uint32_t rxQueueHighWater;
+    uint32_t rxFilteredCount;
+    uint32_t rxSupersededCount;
+    uint32_t e2eCrcErrorCount;
+    uint32_t e2eLengthErrorCount;
+    uint32_t e2eRepeatedCount;
+    uint32_t e2eLostCount;
+    uint32_t txQueueDepth;
+    uint32_t txQueueHighWater;
+    uint32_t txOverrunCount;
+    uint32_t txFlushCount;
+    uint32_t txQueueTimeAvgUs;
+    uint32_t txQueueTimeMaxUs;
+    uint32_t txSuppressedCount;
+    uint32_t txReplacedCount;
+    uint32_t txTimeoutCount;
+    uint32_t txAbortCount;
+    canBusState_t busState;
+    uint32_t txErrorCounter;
+    uint32_t passiveCount;
+    uint32_t recoveryCount;
+    uint64_t busTimeUs;
+    uint32_t busLoadPermille;
+    uint32_t rxLatencyMaxUs;
+    uint32_t rxLatencyHistogram[CAN_LATENCY_BUCKETS];
+    uint32_t txLatencyHistogram[CAN_LATENCY_BUCKETS];
+    uint32_t idStatsCount;
+    uint32_t idStatsDropped;
+    const canIdStats_t* idStats;
 } canStats_t;
 
+typedef struct {
+    float temperature;
+    uint8_t tempStatus;
+    float pumpDutyCycle;
+    uint8_t pumpState;
+    bool pumpEnabled;
+    float fanDutyCycle;
+    uint8_t fanState;
+    bool fanEnabled;
+    float kp;
+    float ki;
+    float kd;
+    float setpoint;
+} canStatusSnapshot_t;
+
+typedef struct {
+    uint32_t tickMs;
+    uint32_t hyperperiodMs;
+    uint32_t framesPerTickMax;
+    uint32_t busTimePerTickMaxUs;
+    uint32_t busLoadPermilleMax;
+} canScheduleReport_t;
+
+typedef struct {
+    uint32_t id;
+    uint8_t length;
+    bool fd;
+    uint32_t periodMs;
+    uint32_t offsetMs;
+} canScheduleInfo_t;
+
 typedef enum {
     CAN_STATUS_OK = 0,
     CAN_STATUS_ERROR,
     CAN_STATUS_BUS_OFF,
     CAN_STATUS_PASSIVE,
-    CAN_STATUS_TIMEOUT
+    CAN_STATUS_TIMEOUT,
+    CAN_STATUS_OVERRUN
 } canStatus_t;
 
 typedef void (*canRxCallback_t)(const canFrame_t* frame);
+typedef void (*canRxHandler_t)(const canFrame_t* frame);
+typedef void (*canRxRouter_t)(canChannel_t* channel, const canFrame_t* frame);
+
+canChannel_t* canChannel_get(uint8_t index);
+uint8_t canChannel_getIndex(const canChannel_t* channel);
+bool canChannel_init(canChannel_t* channel, const canConfig_t* config);
+canStatus_t canChannel_sendFrame(canChannel_t* channel, const canFrame_t* frame);
+canStatus_t canChannel_queueFrame(canChannel_t* channel, const canFrame_t* frame);
+canFrame_t* canChannel_reserveTx(canChannel_t* channel);
+canStatus_t canChannel_commitTx(canChannel_t* channel, canFrame_t* frame);
+canStatus_t canChannel_flushTx(canChannel_t* channel);
+canStatus_t canChannel_receiveFrame(canChannel_t* channel, canFrame_t* frame);
+const canFrame_t* canChannel_peekFrame(canChannel_t* channel);
+uint32_t canChannel_peekFrames(canChannel_t* channel, const canFrame_t** frames, uint32_t maxCount);
+void canChannel_consumeFrames(canChannel_t* channel, uint32_t count);
+canStatus_t canChannel_enqueueRxFrame(canChannel_t* channel, const canFrame_t* frame);
+void canChannel_setRxCallback(canChannel_t* channel, canRxCallback_t callback);
+void canChannel_setRouter(canChannel_t* channel, canRxRouter_t router);
+bool canChannel_setFilter(canChannel_t* channel, uint8_t index, const canFilter_t* filter);
+void canChannel_clearFilters(canChannel_t* channel);
+uint32_t canChannel_getFilterHits(canChannel_t* channel, uint8_t index);
+bool canChannel_setE2e(canChannel_t* channel, const canE2eConfig_t* config);
+bool canChannel_setCoalescing(canChannel_t* channel, uint32_t id, bool enabled);
+bool canChannel_setTxMailbox(canChannel_t* channel, uint32_t id, bool enabled);
+uint32_t canChannel_abortTx(canChannel_t* channel);
+canBusState_t canChannel_getBusState(canChannel_t* channel);
+bool canChannel_registerHandler(canChannel_t* channel, uint32_t id, bool extended, canRxHandler_t handler);
+bool canChannel_unregisterHandler(canChannel_t* channel, uint32_t id, bool extended);
+void canChannel_dispatchFrame(canChannel_t* channel, const canFrame_t* frame);
+const canStats_t* canChannel_getStats(canChannel_t* channel);
+const canIdStats_t* canChannel_getIdStats(canChannel_t* channel, uint32_t id, bool extended);
+void canChannel_processMessages(canChannel_t* channel);
 
 bool canManager_init(const canConfig_t* config);
 canStatus_t canManager_sendFrame(const canFrame_t* frame);
+canStatus_t canManager_queueFrame(const canFrame_t* frame);
+canFrame_t* canManager_reserveTx(void);
+canStatus_t canManager_commitTx(canFrame_t* frame);
+canStatus_t canManager_flushTx(void);
 canStatus_t canManager_receiveFrame(canFrame_t* frame);
+const canFrame_t* canManager_peekFrame(void);
+uint32_t canManager_peekFrames(const canFrame_t** frames, uint32_t maxCount);
+void canManager_consumeFrames(uint32_t count);
+canStatus_t canManager_enqueueRxFrame(const canFrame_t* frame);
 void canManager_setRxCallback(canRxCallback_t callback);
+bool canManager_setFilter(uint8_t index, const canFilter_t* filter);
+void canManager_clearFilters(void);
+uint32_t canManager_getFilterHits(uint8_t index);
+bool canManager_setE2e(const canE2eConfig_t* config);
+bool canManager_setCoalescing(uint32_t id, bool enabled);
+bool canManager_setTxMailbox(uint32_t id, bool enabled);
+uint32_t canManager_abortTx(void);
+canBusState_t canManager_getBusState(void);
+bool canManager_registerHandler(uint32_t id, bool extended, canRxHandler_t handler);
+bool canManager_unregisterHandler(uint32_t id, bool extended);
+void canManager_dispatchFrame(const canFrame_t* frame);
 const canStats_t* canManager_getStats(void);
+const canIdStats_t* canManager_getIdStats(uint32_t id, bool extended);
 void canManager_processMessages(void);
 void canManager_periodicSend(void);
+bool canManager_setSchedule(uint32_t id, uint32_t periodMs, uint32_t offsetMs);
+void canManager_getScheduleReport(canScheduleReport_t* report);
+uint32_t canManager_getSchedule(canScheduleInfo_t* entries, uint32_t maxEntries);
 canStatus_t canManager_sendSystemStatus(uint8_t systemState, ignitionState_t ignition, levelState_t coolantLevel, uint8_t faultCode);
 canStatus_t canManager_sendTempStatus(float temperature, uint8_t status);
 canStatus_t canManager_sendPumpStatus(float dutyCycle, uint8_t state, bool enabled);
 canStatus_t canManager_sendFanStatus(float dutyCycle, uint8_t state, bool enabled);
 canStatus_t canManager_sendPidParams(float kp, float ki, float kd, float setpoint);
+canStatus_t canManager_sendConsolidatedStatus(const canStatusSnapshot_t* snapshot);
+uint8_t canManager_dlcToLength(uint8_t dlc);
+uint8_t canManager_lengthToDlc(uint8_t length);
+uint8_t canManager_frameLength(const canFrame_t* frame);
+uint32_t canManager_arbitrationKey(const canFrame_t* frame);
+void canManager_printTap(const canFrame_t* frame, bool tx);
 void canManager_floatToBytes(float value, uint8_t* data);
 float canManager_bytesToFloat(const uint8_t* data);
 
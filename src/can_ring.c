@@ -0,0 +1,155 @@
+#include "can_ring.h"
+#include <stddef.h>
+
+/*
+ * Initialize ring over caller-provided storage (depth must be a power of two)
+ */
+bool canRing_init(canRing_t* ring, canFrame_t* storage, uint32_t depth)
+{
+    if ((ring == NULL) || (storage == NULL)) {
+        return false;
+    }
+
+    if ((depth == 0U) || ((depth & (depth - 1U)) != 0U)) {
+        return false;
+    }
+
+    ring->slots = storage;
+    ring->mask = depth - 1U;
+    ring->tailCache = 0U;
+    ring->headCache = 0U;
+    atomic_store_explicit(&ring->head, 0U, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, 0U, memory_order_relaxed);
+
+    return true;
+}
+
+/*
+ * Producer side: copy frame into the next free slot and publish it
+ */
+bool canRing_push(canRing_t* ring, const canFrame_t* frame)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    if ((head - ring->tailCache) > ring->mask) {
+        ring->tailCache = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if ((head - ring->tailCache) > ring->mask) {
+            return false;
+        }
+    }
+
+    ring->slots[head & ring->mask] = *frame;
+    atomic_store_explicit(&ring->head, head + 1U, memory_order_release);
+
+    return true;
+}
+
+/*
+ * Consumer side: copy out the oldest frame and release its slot
+ */
+bool canRing_pop(canRing_t* ring, canFrame_t* frame)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail == ring->headCache) {
+        ring->headCache = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail == ring->headCache) {
+            return false;
+        }
+    }
+
+    *frame = ring->slots[tail & ring->mask];
+    atomic_store_explicit(&ring->tail, tail + 1U, memory_order_release);
+
+    return true;
+}
+
+/*
+ * Consumer side: oldest frame in place, or NULL when empty. The slot stays
+ * owned by the consumer until canRing_consume releases it.
+ */
+const canFrame_t* canRing_peek(canRing_t* ring)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if (tail == ring->headCache) {
+        ring->headCache = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (tail == ring->headCache) {
+            return NULL;
+        }
+    }
+
+    return &ring->slots[tail & ring->mask];
+}
+
+/*
+ * Consumer side: longest run of queued frames that is contiguous in
+ * storage (it stops at the wrap point), capped at maxCount
+ */
+uint32_t canRing_peekSpan(canRing_t* ring, const canFrame_t** frames, uint32_t maxCount)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t toWrap = (ring->mask + 1U) - (tail & ring->mask);
+    uint32_t count;
+
+    ring->headCache = atomic_load_explicit(&ring->head, memory_order_acquire);
+    count = ring->headCache - tail;
+
+    if (count > toWrap) {
+        count = toWrap;
+    }
+    if (count > maxCount) {
+        count = maxCount;
+    }
+
+    *frames = &ring->slots[tail & ring->mask];
+
+    return count;
+}
+
+/*
+ * Consumer side: the frame offset places behind the oldest one, or NULL
+ * when fewer frames are queued
+ */
+const canFrame_t* canRing_peekAt(canRing_t* ring, uint32_t offset)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    if ((ring->headCache - tail) <= offset) {
+        ring->headCache = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if ((ring->headCache - tail) <= offset) {
+            return NULL;
+        }
+    }
+
+    return &ring->slots[(tail + offset) & ring->mask];
+}
+
+/*
+ * Consumer side: release frames obtained with canRing_peek/peekSpan
+ */
+void canRing_consume(canRing_t* ring, uint32_t count)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+}
+
+/*
+ * Number of frames currently queued (approximate while both sides run)
+ */
+uint32_t canRing_count(canRing_t* ring)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    return head - tail;
+}
+
+/*
+ * Configured ring depth
+ */
+uint32_t canRing_depth(const canRing_t* ring)
+{
+    return ring->mask + 1U;
+}
\ No newline at end of file
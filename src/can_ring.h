@@ -0,0 +1,36 @@
+#ifndef CAN_RING_H
+#define CAN_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "can_manager.h"
+
+#define CAN_RING_CACHE_LINE (64U)
+
+/*
+ * Single-producer/single-consumer frame ring. head is only written by the
+ * producer and tail only by the consumer; each side keeps a cached copy of
+ * the other index so the shared line is touched only when the cache says
+ * the ring looks full (producer) or empty (consumer).
+ */
+typedef struct {
+    _Alignas(CAN_RING_CACHE_LINE) atomic_uint head;
+    uint32_t tailCache;
+    _Alignas(CAN_RING_CACHE_LINE) atomic_uint tail;
+    uint32_t headCache;
+    _Alignas(CAN_RING_CACHE_LINE) canFrame_t* slots;
+    uint32_t mask;
+} canRing_t;
+
+bool canRing_init(canRing_t* ring, canFrame_t* storage, uint32_t depth);
+bool canRing_push(canRing_t* ring, const canFrame_t* frame);
+bool canRing_pop(canRing_t* ring, canFrame_t* frame);
+const canFrame_t* canRing_peek(canRing_t* ring);
+uint32_t canRing_peekSpan(canRing_t* ring, const canFrame_t** frames, uint32_t maxCount);
+const canFrame_t* canRing_peekAt(canRing_t* ring, uint32_t offset);
+void canRing_consume(canRing_t* ring, uint32_t count);
+uint32_t canRing_count(canRing_t* ring);
+uint32_t canRing_depth(const canRing_t* ring);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "can_rta.h"
+#include "can_timing.h"
+#include <stddef.h>
+#include <string.h>
+
+static uint64_t canRta_ceilDiv(uint64_t value, uint64_t divisor);
+static uint32_t canRta_key(const canRtaMessage_t* message);
+static uint64_t canRta_deadlineNs(const canRtaMessage_t* message);
+static uint64_t canRta_interference(const canRtaMessage_t* messages, const canRtaResult_t* results,
+                                    const uint32_t* keys, uint32_t count, uint32_t m, uint64_t window,
+                                    uint64_t extraNs, bool includeSelf);
+static bool canRta_analyzeOne(const canRtaMessage_t* messages, canRtaResult_t* results, const uint32_t* keys,
+                              uint32_t count, uint32_t m, uint64_t bitNs);
+
+/*
+ * Fixed-priority schedulability analysis of a CAN message set (Davis,
+ * Burns, Bril and Lukkien, "Controller Area Network (CAN) schedulability
+ * analysis: Refuted, revisited and revised", 2007). Frame times use
+ * worst-case bit stuffing. Every instance of a message in its level-m busy
+ * period is checked, so a message is not assumed to be done before its
+ * next release. Messages sharing an arbitration key each count the other
+ * as higher priority. Returns true when every message meets its deadline;
+ * results (one per message) and report may be NULL.
+ */
+bool canRta_analyze(const canRtaMessage_t* messages, uint32_t count, uint32_t baudrate, uint32_t dataBaudrate,
+                    canRtaResult_t* results, canRtaReport_t* report)
+{
+    canRtaResult_t local[CAN_RTA_MESSAGES_MAX];
+    uint32_t keys[CAN_RTA_MESSAGES_MAX];
+    canRtaReport_t summary = {0U, 0U, UINT64_MAX, true};
+    uint64_t utilizationPpb = 0U;
+    uint64_t bitNs;
+    uint64_t deadlineNs;
+    uint32_t i;
+
+    if (((messages == NULL) && (count > 0U)) || (count > CAN_RTA_MESSAGES_MAX) || (baudrate == 0U)) {
+        return false;
+    }
+
+    if (results == NULL) {
+        results = local;
+    }
+
+    bitNs = canRta_ceilDiv(1000000000U, baudrate);
+
+    for (i = 0U; i < count; i++) {
+        const canRtaMessage_t* message = &messages[i];
+        canFrameBits_t bits = canTiming_worstCaseBits(message->length, message->extended, message->fd,
+                                                      message->fd && message->brs);
+
+        memset(&results[i], 0, sizeof(results[i]));
+        if (message->periodUs == 0U) {
+            return false;
+        }
+        results[i].frameTimeNs = canTiming_frameTimeNs(bits, baudrate, dataBaudrate);
+        keys[i] = canRta_key(message);
+        utilizationPpb += ((uint64_t)results[i].frameTimeNs * 1000000U) / message->periodUs;
+    }
+
+    for (i = 0U; i < count; i++) {
+        deadlineNs = canRta_deadlineNs(&messages[i]);
+
+        if (canRta_analyzeOne(messages, results, keys, count, i, bitNs)) {
+            if ((deadlineNs - results[i].responseNs) < summary.worstSlackNs) {
+                summary.worstSlackNs = deadlineNs - results[i].responseNs;
+            }
+        } else {
+            summary.unschedulableCount++;
+            summary.schedulable = false;
+        }
+    }
+
+    if (!summary.schedulable || (count == 0U)) {
+        summary.worstSlackNs = 0U;
+    }
+    summary.utilizationPermille = (uint32_t)(utilizationPpb / 1000000U);
+
+    if (report != NULL) {
+        *report = summary;
+    }
+
+    return summary.schedulable;
+}
+
+/*
+ * Integer ceiling of value / divisor
+ */
+static uint64_t canRta_ceilDiv(uint64_t value, uint64_t divisor)
+{
+    return (value + divisor - 1U) / divisor;
+}
+
+/*
+ * Arbitration key of a message's frame; lower wins
+ */
+static uint32_t canRta_key(const canRtaMessage_t* message)
+{
+    canFrame_t frame;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.id = message->id;
+    frame.extended = message->extended;
+    frame.fd = message->fd;
+
+    return canManager_arbitrationKey(&frame);
+}
+
+/*
+ * Deadline in nanoseconds; an unset deadline is the period
+ */
+static uint64_t canRta_deadlineNs(const canRtaMessage_t* message)
+{
+    uint32_t deadlineUs = (message->deadlineUs != 0U) ? message->deadlineUs : message->periodUs;
+
+    return (uint64_t)deadlineUs * 1000U;
+}
+
+/*
+ * Bus time taken within a window by messages of higher priority than m
+ * (and by m itself with includeSelf), each released as often as its
+ * period and jitter allow: sum of ceil((window + J_k + extra) / T_k) * C_k
+ */
+static uint64_t canRta_interference(const canRtaMessage_t* messages, const canRtaResult_t* results,
+                                    const uint32_t* keys, uint32_t count, uint32_t m, uint64_t window,
+                                    uint64_t extraNs, bool includeSelf)
+{
+    uint64_t total = 0U;
+    uint64_t periodNs;
+    uint32_t k;
+
+    for (k = 0U; k < count; k++) {
+        if ((k == m) ? includeSelf : (keys[k] <= keys[m])) {
+            periodNs = (uint64_t)messages[k].periodUs * 1000U;
+            total += canRta_ceilDiv(window + ((uint64_t)messages[k].jitterUs * 1000U) + extraNs, periodNs) *
+                     results[k].frameTimeNs;
+        }
+    }
+
+    return total;
+}
+
+/*
+ * Worst-case response time of message m: blocking by the longest lower
+ * priority frame, then the level-m busy period, then the queuing delay of
+ * each instance q in it, w = B + q*C + sum over hp of ceil((w + J + tau) / T) * C
+ * with tau one bit time. Gives up as soon as an instance misses the
+ * deadline, or at once when level-m utilisation reaches 100 %.
+ */
+static bool canRta_analyzeOne(const canRtaMessage_t* messages, canRtaResult_t* results, const uint32_t* keys,
+                              uint32_t count, uint32_t m, uint64_t bitNs)
+{
+    canRtaResult_t* result = &results[m];
+    uint64_t periodNs = (uint64_t)messages[m].periodUs * 1000U;
+    uint64_t jitterNs = (uint64_t)messages[m].jitterUs * 1000U;
+    uint64_t deadlineNs = canRta_deadlineNs(&messages[m]);
+    uint64_t levelPpb = 0U;
+    uint64_t busy;
+    uint64_t next;
+    uint64_t queuing;
+    uint64_t end;
+    uint64_t response;
+    uint32_t instances;
+    uint32_t q;
+    uint32_t k;
+
+    for (k = 0U; k < count; k++) {
+        if ((k != m) && (keys[k] > keys[m]) && (results[k].frameTimeNs > result->blockingNs)) {
+            result->blockingNs = results[k].frameTimeNs;
+        }
+        if ((k == m) || (keys[k] <= keys[m])) {
+            levelPpb += ((uint64_t)results[k].frameTimeNs * 1000000000U) / ((uint64_t)messages[k].periodUs * 1000U);
+        }
+    }
+
+    result->responseNs = UINT64_MAX;
+    result->schedulable = false;
+    if (levelPpb >= 1000000000U) {
+        return false;
+    }
+
+    /* Level-m busy period */
+    busy = result->frameTimeNs;
+    for (;;) {
+        next = result->blockingNs + canRta_interference(messages, results, keys, count, m, busy, 0U, true);
+        if (next == busy) {
+            break;
+        }
+        busy = next;
+    }
+    instances = (uint32_t)canRta_ceilDiv(busy + jitterNs, periodNs);
+    result->instances = instances;
+    result->responseNs = 0U;
+
+    for (q = 0U; q < instances; q++) {
+        queuing = result->blockingNs + ((uint64_t)q * result->frameTimeNs);
+        for (;;) {
+            next = result->blockingNs + ((uint64_t)q * result->frameTimeNs) +
+                   canRta_interference(messages, results, keys, count, m, queuing, bitNs, false);
+            end = jitterNs + next + result->frameTimeNs;
+            response = (end > ((uint64_t)q * periodNs)) ? (end - ((uint64_t)q * periodNs)) : result->frameTimeNs;
+            if ((next == queuing) || (response > deadlineNs)) {
+                break;
+            }
+            queuing = next;
+        }
+
+        if (response > result->responseNs) {
+            result->responseNs = response;
+        }
+        if (response > deadlineNs) {
+            return false;
+        }
+    }
+
+    result->schedulable = true;
+
+    return true;
+}
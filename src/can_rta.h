@@ -0,0 +1,52 @@
+#ifndef CAN_RTA_H
+#define CAN_RTA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_manager.h"
+
+#ifndef CAN_RTA_MESSAGES_MAX
+#define CAN_RTA_MESSAGES_MAX        (64U)
+#endif
+
+/*
+ * One message of the analysed set. Priority follows from the identifier
+ * by bus arbitration. jitterUs is the queuing jitter (latest minus earliest
+ * release relative to the period); deadlineUs of 0 means the period.
+ */
+typedef struct {
+    uint32_t id;
+    bool extended;
+    uint8_t length;
+    bool fd;
+    bool brs;
+    uint32_t periodUs;
+    uint32_t jitterUs;
+    uint32_t deadlineUs;
+} canRtaMessage_t;
+
+/*
+ * Per-message result. responseNs is the worst-case time from the
+ * message's nominal release to the end of its transmission; it is only
+ * an upper bound when schedulable is set, otherwise the analysis stopped
+ * at the first value past the deadline.
+ */
+typedef struct {
+    uint32_t frameTimeNs;
+    uint32_t blockingNs;
+    uint64_t responseNs;
+    uint32_t instances;
+    bool schedulable;
+} canRtaResult_t;
+
+typedef struct {
+    uint32_t utilizationPermille;
+    uint32_t unschedulableCount;
+    uint64_t worstSlackNs;
+    bool schedulable;
+} canRtaReport_t;
+
+bool canRta_analyze(const canRtaMessage_t* messages, uint32_t count, uint32_t baudrate, uint32_t dataBaudrate,
+                    canRtaResult_t* results, canRtaReport_t* report);
+
+#endif
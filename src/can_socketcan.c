@@ -0,0 +1,438 @@
+#define _GNU_SOURCE
+
+#include "can_socketcan.h"
+#include "can_transport.h"
+#include "time_base.h"
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+
+/* Software stamps only: raw hardware stamps count in the controller's own
+   clock, not CLOCK_REALTIME, and cannot be compared with it */
+#define CAN_SOCKETCAN_TIMESTAMPING  (SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE)
+#define CAN_SOCKETCAN_CONTROL_SIZE  (CMSG_SPACE(3U * sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t)))
+
+static bool canSocketcan_open(void* context, const canConfig_t* config);
+static canStatus_t canSocketcan_send(void* context, const canFrame_t* frame);
+static canStatus_t canSocketcan_sendBatch(void* context, const canFrame_t* const* frames, uint32_t count, uint32_t* sent);
+static canStatus_t canSocketcan_recv(void* context, canFrame_t* frame);
+static void canSocketcan_close(void* context);
+static void canSocketcan_setFilters(void* context, const canFilter_t* filters, uint32_t count);
+static size_t canSocketcan_encode(const canFrame_t* frame, struct canfd_frame* out);
+static bool canSocketcan_decode(const struct canfd_frame* in, size_t length, canFrame_t* frame);
+static bool canSocketcan_accept(const canSocketcan_t* socketcan, uint32_t canId);
+static uint64_t canSocketcan_toTimeBase(struct msghdr* message, uint64_t realtimeUs, uint64_t nowUs,
+                                        canSocketcan_t* socketcan);
+static uint32_t canSocketcan_fill(canSocketcan_t* socketcan);
+static canStatus_t canSocketcan_status(int error);
+
+const canTransport_t canTransport_socketcan = {
+    .name = "socketcan",
+    .open = canSocketcan_open,
+    .send = canSocketcan_send,
+    .sendBatch = canSocketcan_sendBatch,
+    .recv = canSocketcan_recv,
+    .close = canSocketcan_close,
+    .setFilters = canSocketcan_setFilters
+};
+
+/*
+ * Create and bind the raw socket, or adopt the caller's socket when no
+ * interface is named. Timestamping and drop reporting are best effort.
+ */
+static bool canSocketcan_open(void* context, const canConfig_t* config)
+{
+    canSocketcan_t* socketcan = (canSocketcan_t*)context;
+    struct sockaddr_can address;
+    int enable = 1;
+    int timestamping = CAN_SOCKETCAN_TIMESTAMPING;
+
+    if (socketcan == NULL) {
+        return false;
+    }
+
+    socketcan->rxCount = 0U;
+    socketcan->rxIndex = 0U;
+    socketcan->filterCount = 0U;
+    socketcan->fdFrames = (config != NULL) && config->fdEnabled;
+    memset(&socketcan->stats, 0, sizeof(socketcan->stats));
+
+    if (socketcan->interfaceName == NULL) {
+        socketcan->ownsSocket = false;
+        if (socketcan->fd < 0) {
+            return false;
+        }
+    } else {
+        memset(&address, 0, sizeof(address));
+        address.can_family = AF_CAN;
+        address.can_ifindex = (int)if_nametoindex(socketcan->interfaceName);
+        if (address.can_ifindex == 0) {
+            return false;
+        }
+
+        socketcan->fd = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+        if (socketcan->fd < 0) {
+            return false;
+        }
+        socketcan->ownsSocket = true;
+
+        if ((socketcan->fdFrames &&
+             (setsockopt(socketcan->fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable)) != 0)) ||
+            (bind(socketcan->fd, (const struct sockaddr*)&address, sizeof(address)) != 0)) {
+            canSocketcan_close(socketcan);
+            return false;
+        }
+    }
+
+    /* Stand-in sockets only stamp with the plain nanosecond option */
+    if (socketcan->ownsSocket) {
+        (void)setsockopt(socketcan->fd, SOL_SOCKET, SO_TIMESTAMPING, &timestamping, sizeof(timestamping));
+    } else {
+        (void)setsockopt(socketcan->fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+    }
+    (void)setsockopt(socketcan->fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+
+    return true;
+}
+
+/*
+ * Send one frame, one syscall
+ */
+static canStatus_t canSocketcan_send(void* context, const canFrame_t* frame)
+{
+    canSocketcan_t* socketcan = (canSocketcan_t*)context;
+    struct canfd_frame out;
+    size_t length = canSocketcan_encode(frame, &out);
+
+    socketcan->stats.txSyscallCount++;
+    if (send(socketcan->fd, &out, length, MSG_DONTWAIT) != (ssize_t)length) {
+        socketcan->stats.errorCount++;
+        return canSocketcan_status(errno);
+    }
+
+    socketcan->stats.txFrameCount++;
+    return CAN_STATUS_OK;
+}
+
+/*
+ * Send up to CAN_SOCKETCAN_BATCH frames per sendmmsg call. A short count
+ * means the socket send buffer filled; the rest stays with the caller.
+ */
+static canStatus_t canSocketcan_sendBatch(void* context, const canFrame_t* const* frames, uint32_t count, uint32_t* sent)
+{
+    canSocketcan_t* socketcan = (canSocketcan_t*)context;
+    struct canfd_frame out[CAN_SOCKETCAN_BATCH];
+    struct iovec vectors[CAN_SOCKETCAN_BATCH];
+    struct mmsghdr messages[CAN_SOCKETCAN_BATCH];
+    uint32_t done = 0U;
+    uint32_t chunk;
+    uint32_t i;
+    int result;
+
+    while (done < count) {
+        chunk = ((count - done) < CAN_SOCKETCAN_BATCH) ? (count - done) : CAN_SOCKETCAN_BATCH;
+        memset(messages, 0, chunk * sizeof(messages[0]));
+        for (i = 0U; i < chunk; i++) {
+            vectors[i].iov_base = &out[i];
+            vectors[i].iov_len = canSocketcan_encode(frames[done + i], &out[i]);
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1U;
+        }
+
+        socketcan->stats.txSyscallCount++;
+        result = sendmmsg(socketcan->fd, messages, chunk, MSG_DONTWAIT);
+        if (result < 0) {
+            socketcan->stats.errorCount++;
+            *sent = done;
+            return canSocketcan_status(errno);
+        }
+
+        done += (uint32_t)result;
+        socketcan->stats.txFrameCount += (uint32_t)result;
+        if ((uint32_t)result < chunk) {
+            *sent = done;
+            return CAN_STATUS_OVERRUN;
+        }
+    }
+
+    *sent = done;
+    return CAN_STATUS_OK;
+}
+
+/*
+ * Hand out the next frame of the current batch, refilling it with one
+ * recvmmsg call when it runs dry
+ */
+static canStatus_t canSocketcan_recv(void* context, canFrame_t* frame)
+{
+    canSocketcan_t* socketcan = (canSocketcan_t*)context;
+
+    if ((socketcan->rxIndex == socketcan->rxCount) && (canSocketcan_fill(socketcan) == 0U)) {
+        return CAN_STATUS_TIMEOUT;
+    }
+
+    *frame = socketcan->rxFrames[socketcan->rxIndex];
+    socketcan->rxIndex++;
+
+    return CAN_STATUS_OK;
+}
+
+/*
+ * Close the socket if this backend created it; adopted sockets stay open
+ */
+static void canSocketcan_close(void* context)
+{
+    canSocketcan_t* socketcan = (canSocketcan_t*)context;
+
+    if ((socketcan != NULL) && socketcan->ownsSocket && (socketcan->fd >= 0)) {
+        (void)close(socketcan->fd);
+        socketcan->fd = -1;
+        socketcan->ownsSocket = false;
+    }
+}
+
+/*
+ * Translate acceptance filters to CAN_RAW_FILTER entries. The EFF flag is
+ * part of every mask so standard and extended filters never cross-match;
+ * no filters means one match-all entry, as an empty list receives nothing.
+ */
+static void canSocketcan_setFilters(void* context, const canFilter_t* filters, uint32_t count)
+{
+    canSocketcan_t* socketcan = (canSocketcan_t*)context;
+    struct can_filter kernel[CAN_FILTER_BANK_SIZE];
+    uint32_t i;
+
+    if (count > CAN_FILTER_BANK_SIZE) {
+        count = CAN_FILTER_BANK_SIZE;
+    }
+
+    for (i = 0U; i < count; i++) {
+        kernel[i].can_id = filters[i].extended ? (filters[i].id | CAN_EFF_FLAG) : filters[i].id;
+        kernel[i].can_mask = filters[i].mask | CAN_EFF_FLAG;
+        socketcan->filterId[i] = kernel[i].can_id;
+        socketcan->filterMask[i] = kernel[i].can_mask;
+    }
+    socketcan->filterCount = count;
+
+    if (socketcan->ownsSocket) {
+        if (count == 0U) {
+            kernel[0].can_id = 0U;
+            kernel[0].can_mask = 0U;
+            count = 1U;
+        }
+        if (setsockopt(socketcan->fd, SOL_CAN_RAW, CAN_RAW_FILTER, kernel,
+                       (socklen_t)(count * sizeof(kernel[0]))) != 0) {
+            socketcan->stats.errorCount++;
+        }
+    }
+}
+
+/*
+ * Frame to kernel layout; returns CAN_MTU or CANFD_MTU. The classic
+ * can_frame is a prefix of canfd_frame, so one buffer serves both.
+ */
+static size_t canSocketcan_encode(const canFrame_t* frame, struct canfd_frame* out)
+{
+    uint8_t length = canManager_frameLength(frame);
+
+    memset(out, 0, sizeof(*out));
+    out->can_id = frame->extended ? ((frame->id & CAN_EFF_MASK) | CAN_EFF_FLAG) : (frame->id & CAN_SFF_MASK);
+    if (frame->remote) {
+        out->can_id |= CAN_RTR_FLAG;
+    }
+    out->len = length;
+
+    if (!frame->fd) {
+        if (!frame->remote) {
+            memcpy(out->data, frame->data, length);
+        }
+        return CAN_MTU;
+    }
+
+    out->flags = frame->brs ? CANFD_BRS : 0U;
+    memcpy(out->data, frame->data, length);
+
+    return CANFD_MTU;
+}
+
+/*
+ * Kernel layout to frame; error frames and malformed records are rejected
+ */
+static bool canSocketcan_decode(const struct canfd_frame* in, size_t length, canFrame_t* frame)
+{
+    bool fd = (length == CANFD_MTU);
+
+    if ((!fd && (length != CAN_MTU)) || ((in->can_id & CAN_ERR_FLAG) != 0U) ||
+        (in->len > (fd ? CAN_FD_MAX_DATA_LENGTH : CAN_MAX_DATA_LENGTH))) {
+        return false;
+    }
+
+    frame->extended = ((in->can_id & CAN_EFF_FLAG) != 0U);
+    frame->id = frame->extended ? (in->can_id & CAN_EFF_MASK) : (in->can_id & CAN_SFF_MASK);
+    frame->remote = ((in->can_id & CAN_RTR_FLAG) != 0U);
+    frame->fd = fd;
+    frame->brs = fd && ((in->flags & CANFD_BRS) != 0U);
+    frame->dlc = fd ? canManager_lengthToDlc(in->len) : in->len;
+    memcpy(frame->data, in->data, in->len);
+    if (fd && (canManager_frameLength(frame) > in->len)) {
+        memset(&frame->data[in->len], 0, (size_t)(canManager_frameLength(frame) - in->len));
+    }
+
+    return true;
+}
+
+/*
+ * CAN_RAW_FILTER match rule, for the stand-in socket that has no kernel
+ * filtering: (rx_id & mask) == (can_id & mask) for any entry
+ */
+static bool canSocketcan_accept(const canSocketcan_t* socketcan, uint32_t canId)
+{
+    uint32_t i;
+
+    if (socketcan->ownsSocket || (socketcan->filterCount == 0U)) {
+        return true;
+    }
+
+    for (i = 0U; i < socketcan->filterCount; i++) {
+        if (((canId ^ socketcan->filterId[i]) & socketcan->filterMask[i]) == 0U) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Kernel RX timestamp of one message in the time base. The kernel stamps
+ * with CLOCK_REALTIME, so the frame's age is measured against the current
+ * real time and subtracted from the current time base. Also picks up the
+ * socket's cumulative drop counter. Returns 0 when no timestamp came.
+ */
+static uint64_t canSocketcan_toTimeBase(struct msghdr* message, uint64_t realtimeUs, uint64_t nowUs,
+                                        canSocketcan_t* socketcan)
+{
+    struct cmsghdr* control;
+    struct timespec stamps[3];
+    uint32_t drops;
+    uint64_t stampUs = 0U;
+    uint64_t ageUs;
+
+    for (control = CMSG_FIRSTHDR(message); control != NULL;
+         control = CMSG_NXTHDR(message, control)) {
+        if (control->cmsg_level != SOL_SOCKET) {
+            continue;
+        }
+        if (control->cmsg_type == SCM_TIMESTAMPING) {
+            memcpy(stamps, CMSG_DATA(control), sizeof(stamps));
+            stampUs = ((uint64_t)stamps[0].tv_sec * 1000000U) + ((uint64_t)stamps[0].tv_nsec / 1000U);
+        } else if (control->cmsg_type == SCM_TIMESTAMPNS) {
+            memcpy(stamps, CMSG_DATA(control), sizeof(stamps[0]));
+            stampUs = ((uint64_t)stamps[0].tv_sec * 1000000U) + ((uint64_t)stamps[0].tv_nsec / 1000U);
+        } else if (control->cmsg_type == SO_RXQ_OVFL) {
+            memcpy(&drops, CMSG_DATA(control), sizeof(drops));
+            socketcan->stats.rxDropCount = drops;
+        }
+    }
+
+    if (stampUs == 0U) {
+        return 0U;
+    }
+
+    socketcan->stats.rxTimestampCount++;
+    ageUs = (realtimeUs > stampUs) ? (realtimeUs - stampUs) : 0U;
+
+    return (ageUs < nowUs) ? (nowUs - ageUs) : nowUs;
+}
+
+/*
+ * Pull one batch from the socket with a single recvmmsg call and decode it
+ * into rxFrames. Returns the number of frames now available.
+ */
+static uint32_t canSocketcan_fill(canSocketcan_t* socketcan)
+{
+    struct canfd_frame in[CAN_SOCKETCAN_BATCH];
+    struct iovec vectors[CAN_SOCKETCAN_BATCH];
+    struct mmsghdr messages[CAN_SOCKETCAN_BATCH];
+    union {
+        uint8_t bytes[CAN_SOCKETCAN_CONTROL_SIZE];
+        size_t align;
+    } control[CAN_SOCKETCAN_BATCH];
+    struct timespec realtime;
+    uint64_t realtimeUs;
+    uint64_t nowUs;
+    uint32_t count = 0U;
+    uint32_t i;
+    int result;
+
+    socketcan->rxCount = 0U;
+    socketcan->rxIndex = 0U;
+
+    memset(messages, 0, sizeof(messages));
+    for (i = 0U; i < CAN_SOCKETCAN_BATCH; i++) {
+        vectors[i].iov_base = &in[i];
+        vectors[i].iov_len = sizeof(in[i]);
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1U;
+        messages[i].msg_hdr.msg_control = control[i].bytes;
+        messages[i].msg_hdr.msg_controllen = sizeof(control[i].bytes);
+    }
+
+    socketcan->stats.rxSyscallCount++;
+    result = recvmmsg(socketcan->fd, messages, CAN_SOCKETCAN_BATCH, MSG_DONTWAIT, NULL);
+    if (result <= 0) {
+        if ((result < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+            socketcan->stats.errorCount++;
+        }
+        return 0U;
+    }
+
+    /* One clock pair per batch converts every stamp in it */
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    realtimeUs = ((uint64_t)realtime.tv_sec * 1000000U) + ((uint64_t)realtime.tv_nsec / 1000U);
+    nowUs = timeBase_nowUs();
+
+    for (i = 0U; i < (uint32_t)result; i++) {
+        canFrame_t* frame = &socketcan->rxFrames[count];
+
+        if (!canSocketcan_accept(socketcan, in[i].can_id)) {
+            socketcan->stats.rxFilteredCount++;
+            continue;
+        }
+        if (!canSocketcan_decode(&in[i], messages[i].msg_len, frame)) {
+            socketcan->stats.errorCount++;
+            continue;
+        }
+        frame->timestampUs = canSocketcan_toTimeBase(&messages[i].msg_hdr, realtimeUs, nowUs, socketcan);
+        count++;
+    }
+
+    socketcan->stats.rxFrameCount += count;
+    socketcan->rxCount = count;
+
+    return count;
+}
+
+/*
+ * Map a socket errno to a transport status
+ */
+static canStatus_t canSocketcan_status(int error)
+{
+    switch (error) {
+        case EAGAIN:
+        case ENOBUFS:
+            return CAN_STATUS_OVERRUN;
+
+        case ENETDOWN:
+            return CAN_STATUS_BUS_OFF;
+
+        default:
+            return CAN_STATUS_ERROR;
+    }
+}
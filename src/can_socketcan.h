@@ -0,0 +1,51 @@
+#ifndef CAN_SOCKETCAN_H
+#define CAN_SOCKETCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_manager.h"
+
+#ifndef CAN_SOCKETCAN_BATCH
+#define CAN_SOCKETCAN_BATCH         (32U)
+#endif
+
+typedef struct {
+    uint32_t rxFrameCount;
+    uint32_t rxSyscallCount;
+    uint32_t rxTimestampCount;
+    uint32_t rxDropCount;
+    uint32_t rxFilteredCount;
+    uint32_t txFrameCount;
+    uint32_t txSyscallCount;
+    uint32_t errorCount;
+} canSocketcanStats_t;
+
+/*
+ * Linux SocketCAN backend. With interfaceName set (e.g. "can0", "vcan0")
+ * open creates a CAN_RAW socket bound to that interface; with it NULL the
+ * backend adopts fd as-is, which lets one end of a SOCK_SEQPACKET
+ * socketpair stand in for a bus when no CAN interface exists. Frames move
+ * in batches of up to CAN_SOCKETCAN_BATCH per recvmmsg/sendmmsg call, and
+ * kernel RX timestamps are converted to the time base.
+ *
+ * Acceptance filters set on the channel are also programmed as
+ * CAN_RAW_FILTER, so rejected frames never leave the kernel; the stand-in
+ * applies the same kernel match rule in user space.
+ */
+typedef struct {
+    const char* interfaceName;
+    int fd;
+    bool ownsSocket;
+    bool fdFrames;
+    canFrame_t rxFrames[CAN_SOCKETCAN_BATCH];
+    uint32_t rxCount;
+    uint32_t rxIndex;
+    uint32_t filterId[CAN_FILTER_BANK_SIZE];
+    uint32_t filterMask[CAN_FILTER_BANK_SIZE];
+    uint32_t filterCount;
+    canSocketcanStats_t stats;
+} canSocketcan_t;
+
+extern const canTransport_t canTransport_socketcan;
+
+#endif
@@ -0,0 +1,216 @@
+#include "can_timing.h"
+#include <stddef.h>
+
+#define CAN_CRC15_POLY          (0x4599U)
+#define CAN_STUFF_WIDTH         (5U)
+#define CAN_FD_CRC17_LENGTH     (16U)
+
+/* CRC delimiter, ACK slot, ACK delimiter, EOF and interframe space */
+#define CAN_TAIL_BITS           (13U)
+/* Stuff count field (3-bit gray code + parity) in CAN-FD frames */
+#define CAN_FD_STUFF_COUNT_BITS (4U)
+
+typedef enum {
+    CAN_PHASE_NOMINAL = 0,
+    CAN_PHASE_DATA
+} canBitPhase_t;
+
+typedef struct {
+    uint32_t bits[2];
+    canBitPhase_t phase;
+    uint8_t lastBit;
+    uint8_t run;
+    uint16_t crc;
+} canBitStream_t;
+
+static void canTiming_putBits(canBitStream_t* stream, uint32_t value, uint32_t width);
+static void canTiming_putHeader(canBitStream_t* stream, const canFrame_t* frame);
+static uint32_t canTiming_fdCrcBits(uint8_t length);
+
+/*
+ * Exact bus bits of one frame: the stuffed region is rebuilt bit by bit
+ * (including the classic CRC-15, whose value changes the stuffing)
+ */
+canFrameBits_t canTiming_frameBits(const canFrame_t* frame)
+{
+    canBitStream_t stream = {{0U, 0U}, CAN_PHASE_NOMINAL, 2U, 0U, 0U};
+    canFrameBits_t result;
+    uint8_t length;
+    uint32_t i;
+
+    if (frame == NULL) {
+        result.nominalBits = 0U;
+        result.dataBits = 0U;
+        return result;
+    }
+
+    length = frame->remote ? 0U : canManager_frameLength(frame);
+
+    canTiming_putHeader(&stream, frame);
+    for (i = 0U; i < length; i++) {
+        canTiming_putBits(&stream, frame->data[i], 8U);
+    }
+
+    if (!frame->fd) {
+        canTiming_putBits(&stream, stream.crc, 15U);
+    } else {
+        /* Fixed stuff bits: one before the stuff count and one every 4 bits after */
+        uint32_t crcBits = canTiming_fdCrcBits(length);
+
+        stream.bits[stream.phase] += CAN_FD_STUFF_COUNT_BITS + crcBits +
+                                     ((CAN_FD_STUFF_COUNT_BITS + crcBits + 3U) / 4U);
+    }
+
+    result.nominalBits = stream.bits[CAN_PHASE_NOMINAL] + CAN_TAIL_BITS;
+    result.dataBits = stream.bits[CAN_PHASE_DATA];
+
+    return result;
+}
+
+/*
+ * Upper bound on bus bits for a frame with the given payload length,
+ * assuming a stuff bit after every four bits of the dynamically stuffed region
+ */
+canFrameBits_t canTiming_worstCaseBits(uint8_t length, bool extended, bool fd, bool brs)
+{
+    canFrameBits_t result;
+    uint32_t arbitration;
+    uint32_t control;
+    uint32_t trailer;
+    uint32_t stuffed;
+    uint32_t stuffBits;
+
+    if (!fd) {
+        if (length > CAN_MAX_DATA_LENGTH) {
+            length = CAN_MAX_DATA_LENGTH;
+        }
+        /* SOF + ID (+ SRR, IDE, ext ID) + RTR + IDE/r1 + r0 + DLC, then CRC-15 */
+        stuffed = (extended ? 39U : 19U) + (8U * length) + 15U;
+        result.nominalBits = stuffed + ((stuffed - 1U) / 4U) + CAN_TAIL_BITS;
+        result.dataBits = 0U;
+        return result;
+    }
+
+    length = canManager_dlcToLength(canManager_lengthToDlc(length));
+
+    /* SOF + ID (+ SRR, IDE, ext ID) + RRS + IDE + FDF + res + BRS */
+    arbitration = extended ? 36U : 17U;
+    /* ESI + DLC + data */
+    control = 5U + (8U * length);
+    trailer = CAN_FD_STUFF_COUNT_BITS + canTiming_fdCrcBits(length);
+    trailer += (trailer + 3U) / 4U;
+    stuffed = arbitration + control;
+    stuffBits = (stuffed - 1U) / 4U;
+
+    if (brs) {
+        uint32_t arbitrationStuff = (arbitration - 1U) / 4U;
+
+        result.nominalBits = arbitration + arbitrationStuff + CAN_TAIL_BITS;
+        result.dataBits = control + (stuffBits - arbitrationStuff) + trailer;
+    } else {
+        result.nominalBits = stuffed + stuffBits + trailer + CAN_TAIL_BITS;
+        result.dataBits = 0U;
+    }
+
+    return result;
+}
+
+/*
+ * Time on the bus in nanoseconds. A zero data bit rate means the data
+ * phase runs at the nominal bit rate.
+ */
+uint32_t canTiming_frameTimeNs(canFrameBits_t bits, uint32_t baudrate, uint32_t dataBaudrate)
+{
+    uint64_t timeNs;
+
+    if (baudrate == 0U) {
+        return 0U;
+    }
+
+    if (dataBaudrate == 0U) {
+        dataBaudrate = baudrate;
+    }
+
+    timeNs = ((uint64_t)bits.nominalBits * 1000000000U) / baudrate;
+    timeNs += ((uint64_t)bits.dataBits * 1000000000U) / dataBaudrate;
+
+    return (uint32_t)timeNs;
+}
+
+/*
+ * Append bits MSB first, inserting a complementary stuff bit after five
+ * equal bits and updating the classic CRC-15 over the unstuffed bits
+ */
+static void canTiming_putBits(canBitStream_t* stream, uint32_t value, uint32_t width)
+{
+    uint32_t i;
+
+    for (i = width; i > 0U; i--) {
+        uint8_t bit = (uint8_t)((value >> (i - 1U)) & 1U);
+        uint16_t feedback = (uint16_t)(((stream->crc >> 14) & 1U) ^ bit);
+
+        stream->crc = (uint16_t)((stream->crc << 1) & 0x7FFFU);
+        if (feedback != 0U) {
+            stream->crc ^= CAN_CRC15_POLY;
+        }
+
+        stream->bits[stream->phase]++;
+        if (bit == stream->lastBit) {
+            stream->run++;
+        } else {
+            stream->lastBit = bit;
+            stream->run = 1U;
+        }
+
+        if (stream->run == CAN_STUFF_WIDTH) {
+            stream->bits[stream->phase]++;
+            stream->lastBit = (uint8_t)(bit ^ 1U);
+            stream->run = 1U;
+        }
+    }
+}
+
+/*
+ * Start of frame through DLC. For FD frames with BRS the stream switches
+ * to the data phase after the BRS bit.
+ */
+static void canTiming_putHeader(canBitStream_t* stream, const canFrame_t* frame)
+{
+    uint32_t remote = frame->remote ? 1U : 0U;
+
+    canTiming_putBits(stream, 0U, 1U);
+
+    if (frame->extended) {
+        canTiming_putBits(stream, (frame->id >> 18) & 0x7FFU, 11U);
+        canTiming_putBits(stream, 0x3U, 2U);
+        canTiming_putBits(stream, frame->id & 0x3FFFFU, 18U);
+    } else {
+        canTiming_putBits(stream, frame->id & 0x7FFU, 11U);
+    }
+
+    if (!frame->fd) {
+        /* RTR, IDE (standard) or r1 (extended), r0 */
+        canTiming_putBits(stream, remote << 2, 3U);
+        canTiming_putBits(stream, frame->dlc, 4U);
+        return;
+    }
+
+    /* RRS, IDE (standard only), FDF, res, BRS */
+    canTiming_putBits(stream, 0x2U, frame->extended ? 3U : 4U);
+    canTiming_putBits(stream, frame->brs ? 1U : 0U, 1U);
+    if (frame->brs) {
+        stream->phase = CAN_PHASE_DATA;
+    }
+
+    /* ESI, DLC */
+    canTiming_putBits(stream, 0U, 1U);
+    canTiming_putBits(stream, frame->dlc, 4U);
+}
+
+/*
+ * CAN-FD CRC length: CRC-17 up to 16 data bytes, CRC-21 above
+ */
+static uint32_t canTiming_fdCrcBits(uint8_t length)
+{
+    return (length <= CAN_FD_CRC17_LENGTH) ? 17U : 21U;
+}
@@ -0,0 +1,22 @@
+#ifndef CAN_TIMING_H
+#define CAN_TIMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_manager.h"
+
+/*
+ * Bits a frame occupies on the bus, including stuff bits and the
+ * interframe space. dataBits are the bits sent at the data bit rate
+ * (CAN-FD frames with BRS); everything else is at the nominal bit rate.
+ */
+typedef struct {
+    uint32_t nominalBits;
+    uint32_t dataBits;
+} canFrameBits_t;
+
+canFrameBits_t canTiming_frameBits(const canFrame_t* frame);
+canFrameBits_t canTiming_worstCaseBits(uint8_t length, bool extended, bool fd, bool brs);
+uint32_t canTiming_frameTimeNs(canFrameBits_t bits, uint32_t baudrate, uint32_t dataBaudrate);
+
+#endif
@@ -0,0 +1,138 @@
+#include "can_transport.h"
+#include <stddef.h>
+#include <string.h>
+
+static bool canNull_open(void* context, const canConfig_t* config);
+static canStatus_t canNull_send(void* context, const canFrame_t* frame);
+static canStatus_t canNull_sendBatch(void* context, const canFrame_t* const* frames, uint32_t count, uint32_t* sent);
+static canStatus_t canNull_recv(void* context, canFrame_t* frame);
+static void canNull_close(void* context);
+
+static bool canLoopback_open(void* context, const canConfig_t* config);
+static canStatus_t canLoopback_send(void* context, const canFrame_t* frame);
+static canStatus_t canLoopback_sendBatch(void* context, const canFrame_t* const* frames, uint32_t count, uint32_t* sent);
+static canStatus_t canLoopback_recv(void* context, canFrame_t* frame);
+static void canLoopback_close(void* context);
+
+static canLoopback_t defaultLoopback;
+
+const canTransport_t canTransport_null = {
+    .name = "null",
+    .open = canNull_open,
+    .send = canNull_send,
+    .sendBatch = canNull_sendBatch,
+    .recv = canNull_recv,
+    .close = canNull_close
+};
+
+const canTransport_t canTransport_loopback = {
+    .name = "loopback",
+    .open = canLoopback_open,
+    .send = canLoopback_send,
+    .sendBatch = canLoopback_sendBatch,
+    .recv = canLoopback_recv,
+    .close = canLoopback_close
+};
+
+/*
+ * Null backend: accepts and discards every frame
+ */
+static bool canNull_open(void* context, const canConfig_t* config)
+{
+    (void)context;
+    (void)config;
+    return true;
+}
+
+static canStatus_t canNull_send(void* context, const canFrame_t* frame)
+{
+    (void)context;
+    (void)frame;
+    return CAN_STATUS_OK;
+}
+
+static canStatus_t canNull_sendBatch(void* context, const canFrame_t* const* frames, uint32_t count, uint32_t* sent)
+{
+    (void)context;
+    (void)frames;
+    *sent = count;
+    return CAN_STATUS_OK;
+}
+
+static canStatus_t canNull_recv(void* context, canFrame_t* frame)
+{
+    (void)context;
+    (void)frame;
+    return CAN_STATUS_TIMEOUT;
+}
+
+static void canNull_close(void* context)
+{
+    (void)context;
+}
+
+/*
+ * Loopback backend: every transmitted frame is received back in order.
+ * A NULL context selects the module's default instance.
+ */
+static canLoopback_t* canLoopback_resolve(void* context)
+{
+    return (context != NULL) ? (canLoopback_t*)context : &defaultLoopback;
+}
+
+static bool canLoopback_open(void* context, const canConfig_t* config)
+{
+    (void)config;
+    memset(canLoopback_resolve(context), 0, sizeof(canLoopback_t));
+    return true;
+}
+
+static canStatus_t canLoopback_send(void* context, const canFrame_t* frame)
+{
+    canLoopback_t* loopback = canLoopback_resolve(context);
+
+    if ((loopback->head - loopback->tail) >= CAN_LOOPBACK_DEPTH) {
+        loopback->dropCount++;
+        return CAN_STATUS_OVERRUN;
+    }
+
+    loopback->frames[loopback->head % CAN_LOOPBACK_DEPTH] = *frame;
+    loopback->head++;
+
+    return CAN_STATUS_OK;
+}
+
+static canStatus_t canLoopback_sendBatch(void* context, const canFrame_t* const* frames, uint32_t count, uint32_t* sent)
+{
+    canStatus_t status = CAN_STATUS_OK;
+    uint32_t i;
+
+    for (i = 0U; i < count; i++) {
+        status = canLoopback_send(context, frames[i]);
+        if (status != CAN_STATUS_OK) {
+            break;
+        }
+    }
+
+    *sent = i;
+    return status;
+}
+
+static canStatus_t canLoopback_recv(void* context, canFrame_t* frame)
+{
+    canLoopback_t* loopback = canLoopback_resolve(context);
+
+    if (loopback->head == loopback->tail) {
+        return CAN_STATUS_TIMEOUT;
+    }
+
+    *frame = loopback->frames[loopback->tail % CAN_LOOPBACK_DEPTH];
+    loopback->tail++;
+
+    return CAN_STATUS_OK;
+}
+
+static void canLoopback_close(void* context)
+{
+    (void)context;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#ifndef CAN_TRANSPORT_H
+#define CAN_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_manager.h"
+
+#define CAN_LOOPBACK_DEPTH (64U)
+
+struct canTransport {
+    const char* name;
+    bool (*open)(void* context, const canConfig_t* config);
+    canStatus_t (*send)(void* context, const canFrame_t* frame);
+    canStatus_t (*sendBatch)(void* context, const canFrame_t* const* frames, uint32_t count, uint32_t* sent);
+    canStatus_t (*recv)(void* context, canFrame_t* frame);
+    void (*close)(void* context);
+    /* Optional: mirror the channel's active acceptance filters in hardware */
+    void (*setFilters)(void* context, const canFilter_t* filters, uint32_t count);
+};
+
+typedef struct {
+    canFrame_t frames[CAN_LOOPBACK_DEPTH];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t dropCount;
+} canLoopback_t;
+
+extern const canTransport_t canTransport_null;
+extern const canTransport_t canTransport_loopback;
+
+#endif
\ No newline at end of file
@@ -0,0 +1,530 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "can_vbus.h"
+#include "can_transport.h"
+#include "can_timing.h"
+#include "time_base.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+_Static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the shared ring needs lock-free 64-bit atomics");
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2, "the shared ring needs lock-free 32-bit atomics");
+
+/*
+ * One ring entry. seq is a per-slot sequence lock: 2 * position + 1 while
+ * the producer of that position writes it, 2 * position + 2 once it is
+ * published. A reader at position p accepts the slot only if seq reads
+ * 2 * p + 2 both before and after copying it out.
+ */
+typedef struct {
+    _Atomic uint64_t seq;
+    uint64_t readyNs;
+    uint32_t sender;
+    canFrame_t frame;
+} canVbusSlot_t;
+
+/*
+ * The shared segment. head counts every frame ever claimed; producers take
+ * positions from it with fetch_add and never wait for readers. busFreeNs is
+ * the CLOCK_MONOTONIC time at which the modelled bus goes idle.
+ */
+struct canVbusShared {
+    _Atomic uint32_t magic;
+    uint32_t version;
+    uint32_t depth;
+    uint32_t slotSize;
+    _Atomic uint32_t nodeCount;
+    _Atomic uint32_t lastNodeId;
+    _Atomic uint64_t head;
+    _Atomic uint64_t busFreeNs;
+    canVbusSlot_t slots[CAN_VBUS_DEPTH];
+};
+
+static bool canVbus_open(void* context, const canConfig_t* config);
+static canStatus_t canVbus_send(void* context, const canFrame_t* frame);
+static canStatus_t canVbus_sendBatch(void* context, const canFrame_t* const* frames, uint32_t count, uint32_t* sent);
+static canStatus_t canVbus_recv(void* context, canFrame_t* frame);
+static void canVbus_close(void* context);
+static canVbusShared_t* canVbus_attach(const char* name);
+static bool canVbus_waitFor(int fd, canVbusShared_t** shared);
+static void canVbus_sleepMs(uint32_t ms);
+static uint64_t canVbus_nowNs(void);
+static bool canVbus_reserveBus(canVbus_t* vbus, const canFrame_t* const* frames, uint32_t count, uint64_t* readyNs);
+static void canVbus_publish(canVbus_t* vbus, uint64_t position, const canFrame_t* frame, uint64_t readyNs);
+static bool canVbus_skipUnpublished(canVbus_t* vbus, uint64_t nowNs);
+static uint32_t canVbus_fill(canVbus_t* vbus);
+static void canVbus_sortBatch(canVbus_t* vbus);
+
+const canTransport_t canTransport_vbus = {
+    .name = "vbus",
+    .open = canVbus_open,
+    .send = canVbus_send,
+    .sendBatch = canVbus_sendBatch,
+    .recv = canVbus_recv,
+    .close = canVbus_close,
+    .setFilters = NULL
+};
+
+/*
+ * Remove the named segment. Nodes still attached keep their mapping; the
+ * next node to open the name creates a fresh, empty bus.
+ */
+bool canVbus_unlink(const char* name)
+{
+    return (name != NULL) && (shm_unlink(name) == 0);
+}
+
+/*
+ * Nodes currently attached to the bus, this one included
+ */
+uint32_t canVbus_nodeCount(const canVbus_t* vbus)
+{
+    if ((vbus == NULL) || (vbus->shared == NULL)) {
+        return 0U;
+    }
+
+    return atomic_load_explicit(&vbus->shared->nodeCount, memory_order_relaxed);
+}
+
+/*
+ * Claim the next ring position without ever publishing it, as a producer
+ * does that dies in the middle of a send. For tests only.
+ */
+bool canVbus_claimForTest(canVbus_t* vbus)
+{
+    if ((vbus == NULL) || (vbus->shared == NULL)) {
+        return false;
+    }
+
+    (void)atomic_fetch_add_explicit(&vbus->shared->head, 1U, memory_order_relaxed);
+
+    return true;
+}
+
+/*
+ * Attach to (or create) the named bus and join it as a new node. The node
+ * sees only frames sent after it joined.
+ */
+static bool canVbus_open(void* context, const canConfig_t* config)
+{
+    canVbus_t* vbus = (canVbus_t*)context;
+
+    if ((vbus == NULL) || (vbus->name == NULL)) {
+        return false;
+    }
+
+    vbus->rxCount = 0U;
+    vbus->rxIndex = 0U;
+    vbus->stallNs = 0U;
+    vbus->baudrate = (config != NULL) ? config->baudrate : 0U;
+    vbus->dataBaudrate = ((config != NULL) && config->fdEnabled) ? config->dataBaudrate : 0U;
+    memset(&vbus->stats, 0, sizeof(vbus->stats));
+
+    vbus->shared = canVbus_attach(vbus->name);
+    if (vbus->shared == NULL) {
+        return false;
+    }
+
+    vbus->nodeId = atomic_fetch_add_explicit(&vbus->shared->lastNodeId, 1U, memory_order_relaxed) + 1U;
+    (void)atomic_fetch_add_explicit(&vbus->shared->nodeCount, 1U, memory_order_relaxed);
+    vbus->cursor = atomic_load_explicit(&vbus->shared->head, memory_order_acquire);
+
+    return true;
+}
+
+/*
+ * Broadcast one frame
+ */
+static canStatus_t canVbus_send(void* context, const canFrame_t* frame)
+{
+    uint32_t sent;
+
+    return canVbus_sendBatch(context, &frame, 1U, &sent);
+}
+
+/*
+ * Broadcast a batch: one fetch_add claims all ring positions and one
+ * compare-exchange books the bus time for all frames back to back
+ */
+static canStatus_t canVbus_sendBatch(void* context, const canFrame_t* const* frames, uint32_t count, uint32_t* sent)
+{
+    canVbus_t* vbus = (canVbus_t*)context;
+    uint64_t readyNs[CAN_VBUS_BATCH];
+    uint64_t position;
+    uint32_t done = 0U;
+    uint32_t chunk;
+    uint32_t i;
+
+    if (vbus->shared == NULL) {
+        *sent = 0U;
+        return CAN_STATUS_BUS_OFF;
+    }
+
+    while (done < count) {
+        chunk = ((count - done) < CAN_VBUS_BATCH) ? (count - done) : CAN_VBUS_BATCH;
+        if (!canVbus_reserveBus(vbus, &frames[done], chunk, readyNs)) {
+            vbus->stats.txFrameCount += done;
+            *sent = done;
+            return CAN_STATUS_OVERRUN;
+        }
+        position = atomic_fetch_add_explicit(&vbus->shared->head, chunk, memory_order_relaxed);
+        for (i = 0U; i < chunk; i++) {
+            canVbus_publish(vbus, position + i, frames[done + i], readyNs[i]);
+        }
+        done += chunk;
+    }
+
+    vbus->stats.txFrameCount += done;
+    *sent = done;
+
+    return CAN_STATUS_OK;
+}
+
+/*
+ * Hand out the next frame of the current batch, refilling it from the
+ * ring when it runs dry
+ */
+static canStatus_t canVbus_recv(void* context, canFrame_t* frame)
+{
+    canVbus_t* vbus = (canVbus_t*)context;
+
+    if (vbus->shared == NULL) {
+        return CAN_STATUS_TIMEOUT;
+    }
+
+    if ((vbus->rxIndex == vbus->rxCount) && (canVbus_fill(vbus) == 0U)) {
+        return CAN_STATUS_TIMEOUT;
+    }
+
+    *frame = vbus->rxFrames[vbus->rxIndex];
+    vbus->rxIndex++;
+
+    return CAN_STATUS_OK;
+}
+
+/*
+ * Leave the bus and unmap the segment; the segment itself stays until
+ * canVbus_unlink
+ */
+static void canVbus_close(void* context)
+{
+    canVbus_t* vbus = (canVbus_t*)context;
+
+    if ((vbus == NULL) || (vbus->shared == NULL)) {
+        return;
+    }
+
+    (void)atomic_fetch_sub_explicit(&vbus->shared->nodeCount, 1U, memory_order_relaxed);
+    (void)munmap(vbus->shared, sizeof(*vbus->shared));
+    vbus->shared = NULL;
+    vbus->rxCount = 0U;
+    vbus->rxIndex = 0U;
+}
+
+/*
+ * Map the named segment. Whoever creates it initialises it and publishes
+ * the magic last; everyone else waits, bounded, until it is sized and
+ * published and then checks the layout matches this build.
+ */
+static canVbusShared_t* canVbus_attach(const char* name)
+{
+    canVbusShared_t* shared = NULL;
+    int fd;
+    bool ready;
+
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        if (ftruncate(fd, (off_t)sizeof(*shared)) == 0) {
+            shared = (canVbusShared_t*)mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        (void)close(fd);
+        if ((shared == NULL) || (shared == MAP_FAILED)) {
+            (void)shm_unlink(name);
+            return NULL;
+        }
+
+        /* ftruncate zero-fills: head, bus time and every seq start at 0 */
+        shared->version = CAN_VBUS_VERSION;
+        shared->depth = CAN_VBUS_DEPTH;
+        shared->slotSize = (uint32_t)sizeof(canVbusSlot_t);
+        atomic_store_explicit(&shared->magic, CAN_VBUS_MAGIC, memory_order_release);
+
+        return shared;
+    }
+
+    if (errno != EEXIST) {
+        return NULL;
+    }
+
+    fd = shm_open(name, O_RDWR, 0600);
+    if (fd < 0) {
+        return NULL;
+    }
+    ready = canVbus_waitFor(fd, &shared);
+    (void)close(fd);
+
+    if (!ready) {
+        return NULL;
+    }
+
+    if ((shared->version != CAN_VBUS_VERSION) || (shared->depth != CAN_VBUS_DEPTH) ||
+        (shared->slotSize != (uint32_t)sizeof(canVbusSlot_t))) {
+        (void)munmap(shared, sizeof(*shared));
+        return NULL;
+    }
+
+    return shared;
+}
+
+/*
+ * Wait for the creator to size the segment, then to publish the magic.
+ * Touching the mapping before ftruncate would fault, so the size is
+ * checked first.
+ */
+static bool canVbus_waitFor(int fd, canVbusShared_t** shared)
+{
+    struct stat info;
+    void* mapping;
+    uint32_t waitedMs = 0U;
+
+    while ((fstat(fd, &info) != 0) || ((size_t)info.st_size < sizeof(**shared))) {
+        if (waitedMs >= CAN_VBUS_ATTACH_TIMEOUT_MS) {
+            return false;
+        }
+        canVbus_sleepMs(1U);
+        waitedMs++;
+    }
+
+    mapping = mmap(NULL, sizeof(**shared), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    *shared = (canVbusShared_t*)mapping;
+
+    while (atomic_load_explicit(&(*shared)->magic, memory_order_acquire) != CAN_VBUS_MAGIC) {
+        if (waitedMs >= CAN_VBUS_ATTACH_TIMEOUT_MS) {
+            (void)munmap(mapping, sizeof(**shared));
+            *shared = NULL;
+            return false;
+        }
+        canVbus_sleepMs(1U);
+        waitedMs++;
+    }
+
+    return true;
+}
+
+/*
+ * Real sleep; attach waits on another process, not on the time base
+ */
+static void canVbus_sleepMs(uint32_t ms)
+{
+    struct timespec delay;
+
+    delay.tv_sec = (time_t)(ms / 1000U);
+    delay.tv_nsec = (long)(ms % 1000U) * 1000000L;
+    (void)nanosleep(&delay, NULL);
+}
+
+/*
+ * CLOCK_MONOTONIC in nanoseconds; the one clock all nodes share
+ */
+static uint64_t canVbus_nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * Book the bus for count frames back to back, starting when it next goes
+ * idle, and fill in the time each transmission ends. Without the bit-time
+ * model every frame is ready at once. Returns false, booking nothing, when
+ * the bus is already booked beyond the TX backlog.
+ */
+static bool canVbus_reserveBus(canVbus_t* vbus, const canFrame_t* const* frames, uint32_t count, uint64_t* readyNs)
+{
+    uint64_t nowNs = canVbus_nowNs();
+    uint64_t busyNs = 0U;
+    uint64_t freeNs;
+    uint64_t startNs;
+    uint32_t i;
+
+    if (!vbus->bitTiming) {
+        for (i = 0U; i < count; i++) {
+            readyNs[i] = nowNs;
+        }
+        return true;
+    }
+
+    for (i = 0U; i < count; i++) {
+        busyNs += canTiming_frameTimeNs(canTiming_frameBits(frames[i]), vbus->baudrate, vbus->dataBaudrate);
+        readyNs[i] = busyNs;
+    }
+
+    freeNs = atomic_load_explicit(&vbus->shared->busFreeNs, memory_order_relaxed);
+    do {
+        if (freeNs > (nowNs + (CAN_VBUS_TX_BACKLOG_US * 1000U))) {
+            return false;
+        }
+        startNs = (freeNs > nowNs) ? freeNs : nowNs;
+    } while (!atomic_compare_exchange_weak_explicit(&vbus->shared->busFreeNs, &freeNs, startNs + busyNs,
+                                                    memory_order_relaxed, memory_order_relaxed));
+
+    for (i = 0U; i < count; i++) {
+        readyNs[i] += startNs;
+    }
+
+    return true;
+}
+
+/*
+ * Write one claimed position under its sequence lock
+ */
+static void canVbus_publish(canVbus_t* vbus, uint64_t position, const canFrame_t* frame, uint64_t readyNs)
+{
+    canVbusSlot_t* slot = &vbus->shared->slots[position % CAN_VBUS_DEPTH];
+
+    atomic_store_explicit(&slot->seq, (2U * position) + 1U, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->frame = *frame;
+    slot->sender = vbus->nodeId;
+    slot->readyNs = readyNs;
+
+    atomic_store_explicit(&slot->seq, (2U * position) + 2U, memory_order_release);
+}
+
+/*
+ * Whether the claimed but unpublished position at the cursor has been
+ * waited for long enough that its producer is presumed dead. The wait
+ * starts the first time this reader finds the position unpublished.
+ */
+static bool canVbus_skipUnpublished(canVbus_t* vbus, uint64_t nowNs)
+{
+    if (vbus->stallNs == 0U) {
+        vbus->stallNs = nowNs;
+        return false;
+    }
+
+    return (nowNs - vbus->stallNs) >= ((uint64_t)CAN_VBUS_UNPUBLISHED_TIMEOUT_MS * 1000000U);
+}
+
+/*
+ * Copy up to CAN_VBUS_BATCH deliverable frames from the ring into
+ * rxFrames, skipping this node's own. Stops at the first position that is
+ * not yet published or, under the bit-time model, still on the wire; a
+ * position that stays unpublished past the timeout is dropped instead. A
+ * reader that was lapped resynchronises at the head and counts every frame
+ * it missed as dropped. Returns the number of frames now available.
+ */
+static uint32_t canVbus_fill(canVbus_t* vbus)
+{
+    canVbusShared_t* shared = vbus->shared;
+    uint64_t nowNs = canVbus_nowNs();
+    uint64_t nowUs = timeBase_nowUs();
+    uint64_t head = atomic_load_explicit(&shared->head, memory_order_acquire);
+    uint64_t expected;
+    uint64_t seq;
+    uint64_t ageUs;
+    canVbusSlot_t* slot;
+    canFrame_t* frame;
+    uint64_t readyNs;
+    uint32_t sender;
+    uint32_t count = 0U;
+
+    vbus->rxCount = 0U;
+    vbus->rxIndex = 0U;
+
+    while ((count < CAN_VBUS_BATCH) && (vbus->cursor < head)) {
+        if ((head - vbus->cursor) > CAN_VBUS_DEPTH) {
+            vbus->stats.rxDropCount += (uint32_t)(head - vbus->cursor);
+            vbus->cursor = head;
+            vbus->stallNs = 0U;
+            break;
+        }
+
+        slot = &shared->slots[vbus->cursor % CAN_VBUS_DEPTH];
+        frame = &vbus->rxFrames[count];
+        expected = (2U * vbus->cursor) + 2U;
+
+        seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq < expected) {
+            if (!canVbus_skipUnpublished(vbus, nowNs)) {
+                break;
+            }
+            vbus->stats.rxDropCount++;
+            vbus->stallNs = 0U;
+            vbus->cursor++;
+            continue;
+        }
+        vbus->stallNs = 0U;
+        if (seq == expected) {
+            *frame = slot->frame;
+            sender = slot->sender;
+            readyNs = slot->readyNs;
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&slot->seq, memory_order_relaxed) == expected) {
+                if (readyNs > nowNs) {
+                    break;
+                }
+                vbus->cursor++;
+                if (sender != vbus->nodeId) {
+                    ageUs = (nowNs - readyNs) / 1000U;
+                    frame->timestampUs = (ageUs < nowUs) ? (nowUs - ageUs) : nowUs;
+                    count++;
+                }
+                continue;
+            }
+        }
+
+        /* Overwritten before or while it was read: this reader was lapped */
+        head = atomic_load_explicit(&shared->head, memory_order_acquire);
+        vbus->stats.rxDropCount += (uint32_t)(head - vbus->cursor);
+        vbus->cursor = head;
+    }
+
+    vbus->stats.rxFrameCount += count;
+    vbus->rxCount = count;
+    if (vbus->arbitrationOrder) {
+        canVbus_sortBatch(vbus);
+    }
+
+    return count;
+}
+
+/*
+ * Stable insertion sort of the batch by arbitration key: frames that
+ * became visible together are delivered in the order the bus would have
+ * arbitrated them
+ */
+static void canVbus_sortBatch(canVbus_t* vbus)
+{
+    canFrame_t moving;
+    uint32_t key;
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 1U; i < vbus->rxCount; i++) {
+        key = canManager_arbitrationKey(&vbus->rxFrames[i]);
+        if (canManager_arbitrationKey(&vbus->rxFrames[i - 1U]) <= key) {
+            continue;
+        }
+
+        moving = vbus->rxFrames[i];
+        for (j = i; (j > 0U) && (canManager_arbitrationKey(&vbus->rxFrames[j - 1U]) > key); j--) {
+            vbus->rxFrames[j] = vbus->rxFrames[j - 1U];
+        }
+        vbus->rxFrames[j] = moving;
+        vbus->stats.rxReorderCount++;
+    }
+}
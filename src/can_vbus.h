@@ -0,0 +1,75 @@
+#ifndef CAN_VBUS_H
+#define CAN_VBUS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_manager.h"
+
+#ifndef CAN_VBUS_DEPTH
+#define CAN_VBUS_DEPTH              (1024U)
+#endif
+#ifndef CAN_VBUS_BATCH
+#define CAN_VBUS_BATCH              (32U)
+#endif
+#define CAN_VBUS_MAGIC              (0x43564255U)
+#define CAN_VBUS_VERSION            (1U)
+#define CAN_VBUS_ATTACH_TIMEOUT_MS  (1000U)
+#define CAN_VBUS_TX_BACKLOG_US      (2000U)
+#ifndef CAN_VBUS_UNPUBLISHED_TIMEOUT_MS
+#define CAN_VBUS_UNPUBLISHED_TIMEOUT_MS (100U)
+#endif
+
+typedef struct canVbusShared canVbusShared_t;
+
+typedef struct {
+    uint32_t txFrameCount;
+    uint32_t rxFrameCount;
+    uint32_t rxDropCount;
+    uint32_t rxReorderCount;
+} canVbusStats_t;
+
+/*
+ * Virtual CAN bus in POSIX shared memory, for running several processes
+ * (or several channels of one process) as nodes of one bus. Every node
+ * that opens the same name attaches to a broadcast ring: any node may
+ * transmit, every other node receives each frame through its own read
+ * cursor, and a node never receives its own frames. The ring does not
+ * wait for slow readers; a reader that falls a full ring behind skips
+ * ahead and counts the lost frames as drops. Nor do readers wait forever
+ * for a producer that died between claiming a position and publishing
+ * it: a position still unpublished CAN_VBUS_UNPUBLISHED_TIMEOUT_MS after
+ * the reader first reached it is skipped and counted as a drop.
+ *
+ * With bitTiming set, each frame occupies the bus for its real bit time
+ * at the configured bit rates and is delivered only once its
+ * transmission has ended, one frame after another as on a real bus. A
+ * node cannot book the bus more than CAN_VBUS_TX_BACKLOG_US ahead; past
+ * that, sends report CAN_STATUS_OVERRUN and the frames stay in the
+ * channel's TX queue, as with a full controller mailbox. With
+ * arbitrationOrder set, frames that become visible in the same receive
+ * batch are delivered lowest arbitration key first, as if they had
+ * contended for the bus together.
+ */
+typedef struct {
+    const char* name;
+    bool bitTiming;
+    bool arbitrationOrder;
+    canVbusShared_t* shared;
+    uint32_t nodeId;
+    uint64_t cursor;
+    uint64_t stallNs;
+    uint32_t baudrate;
+    uint32_t dataBaudrate;
+    canFrame_t rxFrames[CAN_VBUS_BATCH];
+    uint32_t rxCount;
+    uint32_t rxIndex;
+    canVbusStats_t stats;
+} canVbus_t;
+
+extern const canTransport_t canTransport_vbus;
+
+bool canVbus_unlink(const char* name);
+uint32_t canVbus_nodeCount(const canVbus_t* vbus);
+bool canVbus_claimForTest(canVbus_t* vbus);
+
+#endif
@@ -0,0 +1,625 @@
+#include "can_xcp.h"
+#include <stddef.h>
+#include <string.h>
+
+typedef struct {
+    uint32_t address;
+    uint8_t* data;
+    uint32_t size;
+    bool writable;
+} canXcpRegion_t;
+
+typedef struct {
+    const uint8_t* source;
+    uint8_t size;
+} canXcpOdtEntry_t;
+
+typedef struct {
+    uint16_t firstEntry;
+    uint8_t entryCount;
+} canXcpOdt_t;
+
+typedef struct {
+    uint16_t firstOdt;
+    uint8_t odtCount;
+    uint8_t mode;
+    uint16_t event;
+    uint8_t prescaler;
+    uint8_t prescalerCount;
+} canXcpDaqList_t;
+
+static canXcpConfig_t xcpConfig;
+static canXcpStats_t xcpStats;
+static bool connected;
+static bool daqRunning;
+static uint32_t mta;
+
+static canXcpRegion_t regions[CAN_XCP_REGIONS];
+static uint8_t regionCount;
+
+static canXcpDaqList_t daqLists[CAN_XCP_DAQ_LISTS];
+static canXcpOdt_t odts[CAN_XCP_ODTS];
+static canXcpOdtEntry_t odtEntries[CAN_XCP_ODT_ENTRIES];
+static uint16_t daqListCount;
+static uint16_t odtCount;
+static uint16_t odtEntryCount;
+
+static bool daqPtrValid;
+static uint16_t daqPtrList;
+static uint8_t daqPtrOdt;
+static uint8_t daqPtrEntry;
+
+static void canXcp_rxHandler(const canFrame_t* frame);
+static uint8_t canXcp_command(const uint8_t* cmd, uint8_t length, uint8_t* res, uint8_t* resLength);
+static uint8_t canXcp_daqCommand(const uint8_t* cmd, uint8_t length, uint8_t* res, uint8_t* resLength);
+static uint8_t canXcp_writeDaq(const uint8_t* cmd);
+static uint8_t canXcp_startStopDaqList(const uint8_t* cmd, uint8_t* res, uint8_t* resLength);
+static void canXcp_startStopSynch(uint8_t mode);
+static void canXcp_freeDaq(void);
+static void canXcp_updateRunning(void);
+static uint8_t* canXcp_resolve(uint32_t address, uint32_t length, bool write, uint8_t* error);
+static void canXcp_send(const uint8_t* data, uint8_t length);
+static uint16_t canXcp_getU16(const uint8_t* data);
+static uint32_t canXcp_getU32(const uint8_t* data);
+
+/*
+ * Initialize the XCP slave on a CRO/DTO identifier pair. Must run after
+ * canManager_init; regions registered before this call are dropped.
+ */
+bool canXcp_init(const canXcpConfig_t* config)
+{
+    if (config == NULL) {
+        return false;
+    }
+
+    xcpConfig = *config;
+    memset(&xcpStats, 0, sizeof(xcpStats));
+    memset(regions, 0, sizeof(regions));
+    regionCount = 0U;
+    connected = false;
+    mta = 0U;
+    canXcp_freeDaq();
+
+    return canManager_registerHandler(config->croId, config->extended, canXcp_rxHandler);
+}
+
+/*
+ * Expose a block of memory to the master at a fixed XCP address. Regions
+ * must not overlap; only writable regions accept DOWNLOAD.
+ */
+bool canXcp_addRegion(uint32_t address, void* data, uint32_t size, bool writable)
+{
+    uint8_t i;
+
+    if ((data == NULL) || (size == 0U) || (regionCount >= CAN_XCP_REGIONS) ||
+        ((address + size) < address)) {
+        return false;
+    }
+
+    for (i = 0U; i < regionCount; i++) {
+        if ((address < (regions[i].address + regions[i].size)) &&
+            (regions[i].address < (address + size))) {
+            return false;
+        }
+    }
+
+    regions[regionCount].address = address;
+    regions[regionCount].data = data;
+    regions[regionCount].size = size;
+    regions[regionCount].writable = writable;
+    regionCount++;
+
+    return true;
+}
+
+/*
+ * Sample every running DAQ list bound to this event channel and queue one
+ * DTO per ODT. Returns immediately when no list is running.
+ */
+void canXcp_event(uint16_t channel)
+{
+    canFrame_t frame = {0};
+    uint16_t list;
+    uint16_t odt;
+    uint16_t entry;
+
+    if (!daqRunning) {
+        return;
+    }
+
+    xcpStats.eventCount++;
+    frame.id = xcpConfig.dtoId;
+    frame.extended = xcpConfig.extended;
+
+    for (list = 0U; list < daqListCount; list++) {
+        canXcpDaqList_t* daq = &daqLists[list];
+
+        if (((daq->mode & CAN_XCP_DAQ_MODE_RUNNING) == 0U) || (daq->event != channel)) {
+            continue;
+        }
+
+        daq->prescalerCount++;
+        if (daq->prescalerCount < daq->prescaler) {
+            continue;
+        }
+        daq->prescalerCount = 0U;
+
+        for (odt = 0U; odt < daq->odtCount; odt++) {
+            const canXcpOdt_t* table = &odts[daq->firstOdt + odt];
+            uint8_t offset = 1U;
+
+            frame.data[0] = (uint8_t)(daq->firstOdt + odt);
+            for (entry = 0U; entry < table->entryCount; entry++) {
+                const canXcpOdtEntry_t* sample = &odtEntries[table->firstEntry + entry];
+
+                if (sample->source != NULL) {
+                    memcpy(&frame.data[offset], sample->source, sample->size);
+                    offset = (uint8_t)(offset + sample->size);
+                }
+            }
+            frame.dlc = offset;
+
+            if (canManager_queueFrame(&frame) == CAN_STATUS_OK) {
+                xcpStats.dtoCount++;
+            } else {
+                xcpStats.dtoOverrunCount++;
+            }
+        }
+    }
+}
+
+/*
+ * Whether a master is connected
+ */
+bool canXcp_isConnected(void)
+{
+    return connected;
+}
+
+/*
+ * Whether at least one DAQ list is running
+ */
+bool canXcp_isDaqRunning(void)
+{
+    return daqRunning;
+}
+
+/*
+ * Get XCP statistics
+ */
+const canXcpStats_t* canXcp_getStats(void)
+{
+    return &xcpStats;
+}
+
+/*
+ * CAN manager handler for the CRO identifier: execute the command and
+ * answer with a response or error packet. Commands other than CONNECT are
+ * ignored while disconnected.
+ */
+static void canXcp_rxHandler(const canFrame_t* frame)
+{
+    uint8_t length = canManager_frameLength(frame);
+    uint8_t res[CAN_XCP_MAX_CTO] = {CAN_XCP_PID_RES};
+    uint8_t resLength = 1U;
+    uint8_t error;
+
+    if ((length == 0U) || frame->remote) {
+        return;
+    }
+
+    if (!connected && (frame->data[0] != CAN_XCP_CMD_CONNECT)) {
+        return;
+    }
+
+    xcpStats.commandCount++;
+    error = canXcp_command(frame->data, length, res, &resLength);
+    if (error != 0U) {
+        xcpStats.errorCount++;
+        res[0] = CAN_XCP_PID_ERR;
+        res[1] = error;
+        resLength = 2U;
+    }
+
+    canXcp_send(res, resLength);
+}
+
+/*
+ * Session and memory access commands. Returns 0 or an XCP error code.
+ */
+static uint8_t canXcp_command(const uint8_t* cmd, uint8_t length, uint8_t* res, uint8_t* resLength)
+{
+    uint8_t error = 0U;
+    uint8_t* data;
+    uint8_t count;
+
+    switch (cmd[0]) {
+        case CAN_XCP_CMD_CONNECT:
+            connected = true;
+            res[1] = CAN_XCP_RESOURCE_DAQ;
+            res[2] = 0U;
+            res[3] = CAN_XCP_MAX_CTO;
+            res[4] = CAN_XCP_MAX_DTO;
+            res[5] = 0U;
+            res[6] = 1U;
+            res[7] = 1U;
+            *resLength = 8U;
+            break;
+        case CAN_XCP_CMD_DISCONNECT:
+            canXcp_startStopSynch(0U);
+            connected = false;
+            break;
+        case CAN_XCP_CMD_GET_STATUS:
+            res[1] = daqRunning ? CAN_XCP_SESSION_DAQ_RUNNING : 0U;
+            res[2] = 0U;
+            res[3] = 0U;
+            res[4] = 0U;
+            res[5] = 0U;
+            *resLength = 6U;
+            break;
+        case CAN_XCP_CMD_SET_MTA:
+            if (length < 8U) {
+                return CAN_XCP_ERR_CMD_SYNTAX;
+            }
+            mta = canXcp_getU32(&cmd[4]);
+            break;
+        case CAN_XCP_CMD_UPLOAD:
+        case CAN_XCP_CMD_SHORT_UPLOAD:
+            count = (length >= 2U) ? cmd[1] : 0U;
+            if ((count == 0U) || (count > (CAN_XCP_MAX_CTO - 1U))) {
+                return CAN_XCP_ERR_OUT_OF_RANGE;
+            }
+            if (cmd[0] == CAN_XCP_CMD_SHORT_UPLOAD) {
+                if (length < 8U) {
+                    return CAN_XCP_ERR_CMD_SYNTAX;
+                }
+                mta = canXcp_getU32(&cmd[4]);
+            }
+            data = canXcp_resolve(mta, count, false, &error);
+            if (data == NULL) {
+                return error;
+            }
+            memcpy(&res[1], data, count);
+            mta += count;
+            *resLength = (uint8_t)(count + 1U);
+            break;
+        case CAN_XCP_CMD_DOWNLOAD:
+            count = (length >= 2U) ? cmd[1] : 0U;
+            if ((count == 0U) || (count > (CAN_XCP_MAX_CTO - 2U)) || (length < (count + 2U))) {
+                return CAN_XCP_ERR_CMD_SYNTAX;
+            }
+            data = canXcp_resolve(mta, count, true, &error);
+            if (data == NULL) {
+                return error;
+            }
+            memcpy(data, &cmd[2], count);
+            mta += count;
+            break;
+        default:
+            error = canXcp_daqCommand(cmd, length, res, resLength);
+            break;
+    }
+
+    return error;
+}
+
+/*
+ * Dynamic DAQ configuration: FREE_DAQ, then ALLOC_DAQ, ALLOC_ODT and
+ * ALLOC_ODT_ENTRY in that order, then SET_DAQ_PTR / WRITE_DAQ per entry.
+ */
+static uint8_t canXcp_daqCommand(const uint8_t* cmd, uint8_t length, uint8_t* res, uint8_t* resLength)
+{
+    static const uint8_t minLength[] = {
+        [CAN_XCP_CMD_SET_DAQ_PTR - CAN_XCP_CMD_ALLOC_ODT_ENTRY] = 6U,
+        [CAN_XCP_CMD_WRITE_DAQ - CAN_XCP_CMD_ALLOC_ODT_ENTRY] = 8U,
+        [CAN_XCP_CMD_SET_DAQ_LIST_MODE - CAN_XCP_CMD_ALLOC_ODT_ENTRY] = 8U,
+        [CAN_XCP_CMD_START_STOP_DAQ_LIST - CAN_XCP_CMD_ALLOC_ODT_ENTRY] = 4U,
+        [CAN_XCP_CMD_START_STOP_SYNCH - CAN_XCP_CMD_ALLOC_ODT_ENTRY] = 2U,
+        [CAN_XCP_CMD_FREE_DAQ - CAN_XCP_CMD_ALLOC_ODT_ENTRY] = 1U,
+        [CAN_XCP_CMD_ALLOC_DAQ - CAN_XCP_CMD_ALLOC_ODT_ENTRY] = 4U,
+        [CAN_XCP_CMD_ALLOC_ODT - CAN_XCP_CMD_ALLOC_ODT_ENTRY] = 5U,
+        [CAN_XCP_CMD_ALLOC_ODT_ENTRY - CAN_XCP_CMD_ALLOC_ODT_ENTRY] = 6U
+    };
+    canXcpDaqList_t* daq;
+    uint16_t list;
+    uint16_t count;
+    uint8_t odt;
+
+    if ((cmd[0] < CAN_XCP_CMD_ALLOC_ODT_ENTRY) || (cmd[0] > CAN_XCP_CMD_SET_DAQ_PTR) ||
+        (minLength[cmd[0] - CAN_XCP_CMD_ALLOC_ODT_ENTRY] == 0U)) {
+        return CAN_XCP_ERR_CMD_UNKNOWN;
+    }
+
+    if (length < minLength[cmd[0] - CAN_XCP_CMD_ALLOC_ODT_ENTRY]) {
+        return CAN_XCP_ERR_CMD_SYNTAX;
+    }
+
+    list = (length >= 4U) ? canXcp_getU16(&cmd[2]) : 0U;
+    daq = (list < daqListCount) ? &daqLists[list] : NULL;
+
+    switch (cmd[0]) {
+        case CAN_XCP_CMD_FREE_DAQ:
+            canXcp_freeDaq();
+            break;
+        case CAN_XCP_CMD_ALLOC_DAQ:
+            if (daqRunning) {
+                return CAN_XCP_ERR_DAQ_ACTIVE;
+            }
+            if ((daqListCount != 0U) || (odtCount != 0U)) {
+                return CAN_XCP_ERR_SEQUENCE;
+            }
+            count = list;
+            if (count > CAN_XCP_DAQ_LISTS) {
+                return CAN_XCP_ERR_MEMORY_OVERFLOW;
+            }
+            memset(daqLists, 0, sizeof(daqLists));
+            daqListCount = count;
+            break;
+        case CAN_XCP_CMD_ALLOC_ODT:
+            if (daqRunning) {
+                return CAN_XCP_ERR_DAQ_ACTIVE;
+            }
+            if (daq == NULL) {
+                return CAN_XCP_ERR_OUT_OF_RANGE;
+            }
+            if ((daq->odtCount != 0U) || (odtEntryCount != 0U)) {
+                return CAN_XCP_ERR_SEQUENCE;
+            }
+            if ((odtCount + cmd[4]) > CAN_XCP_ODTS) {
+                return CAN_XCP_ERR_MEMORY_OVERFLOW;
+            }
+            daq->firstOdt = odtCount;
+            daq->odtCount = cmd[4];
+            odtCount = (uint16_t)(odtCount + cmd[4]);
+            break;
+        case CAN_XCP_CMD_ALLOC_ODT_ENTRY:
+            if (daqRunning) {
+                return CAN_XCP_ERR_DAQ_ACTIVE;
+            }
+            odt = cmd[4];
+            if ((daq == NULL) || (odt >= daq->odtCount) || (cmd[5] > CAN_XCP_ODT_DATA)) {
+                return CAN_XCP_ERR_OUT_OF_RANGE;
+            }
+            if (odts[daq->firstOdt + odt].entryCount != 0U) {
+                return CAN_XCP_ERR_SEQUENCE;
+            }
+            if ((odtEntryCount + cmd[5]) > CAN_XCP_ODT_ENTRIES) {
+                return CAN_XCP_ERR_MEMORY_OVERFLOW;
+            }
+            odts[daq->firstOdt + odt].firstEntry = odtEntryCount;
+            odts[daq->firstOdt + odt].entryCount = cmd[5];
+            memset(&odtEntries[odtEntryCount], 0, cmd[5] * sizeof(canXcpOdtEntry_t));
+            odtEntryCount = (uint16_t)(odtEntryCount + cmd[5]);
+            break;
+        case CAN_XCP_CMD_SET_DAQ_PTR:
+            if ((daq == NULL) || (cmd[4] >= daq->odtCount) ||
+                (cmd[5] >= odts[daq->firstOdt + cmd[4]].entryCount)) {
+                return CAN_XCP_ERR_OUT_OF_RANGE;
+            }
+            daqPtrList = list;
+            daqPtrOdt = cmd[4];
+            daqPtrEntry = cmd[5];
+            daqPtrValid = true;
+            break;
+        case CAN_XCP_CMD_WRITE_DAQ:
+            return canXcp_writeDaq(cmd);
+        case CAN_XCP_CMD_SET_DAQ_LIST_MODE:
+            if ((daq == NULL) || (cmd[1] != 0U) || (canXcp_getU16(&cmd[4]) != CAN_XCP_EVENT_LOOP) ||
+                (cmd[6] == 0U)) {
+                return CAN_XCP_ERR_OUT_OF_RANGE;
+            }
+            if ((daq->mode & CAN_XCP_DAQ_MODE_RUNNING) != 0U) {
+                return CAN_XCP_ERR_DAQ_ACTIVE;
+            }
+            daq->event = canXcp_getU16(&cmd[4]);
+            daq->prescaler = cmd[6];
+            break;
+        case CAN_XCP_CMD_START_STOP_DAQ_LIST:
+            return canXcp_startStopDaqList(cmd, res, resLength);
+        case CAN_XCP_CMD_START_STOP_SYNCH:
+            if (cmd[1] > 2U) {
+                return CAN_XCP_ERR_OUT_OF_RANGE;
+            }
+            canXcp_startStopSynch(cmd[1]);
+            break;
+        default:
+            return CAN_XCP_ERR_CMD_UNKNOWN;
+    }
+
+    return 0U;
+}
+
+/*
+ * WRITE_DAQ: bind the entry at the DAQ pointer to a memory address and
+ * advance the pointer. The whole ODT must fit into one DTO.
+ */
+static uint8_t canXcp_writeDaq(const uint8_t* cmd)
+{
+    canXcpDaqList_t* daq;
+    canXcpOdt_t* odt;
+    const uint8_t* source;
+    uint32_t total = 0U;
+    uint8_t error = 0U;
+    uint8_t i;
+
+    if (!daqPtrValid) {
+        return CAN_XCP_ERR_SEQUENCE;
+    }
+
+    daq = &daqLists[daqPtrList];
+    odt = &odts[daq->firstOdt + daqPtrOdt];
+    if ((daq->mode & CAN_XCP_DAQ_MODE_RUNNING) != 0U) {
+        return CAN_XCP_ERR_DAQ_ACTIVE;
+    }
+    if (daqPtrEntry >= odt->entryCount) {
+        return CAN_XCP_ERR_OUT_OF_RANGE;
+    }
+    if ((cmd[1] != 0xFFU) || (cmd[2] == 0U) || (cmd[2] > CAN_XCP_ODT_DATA)) {
+        return CAN_XCP_ERR_OUT_OF_RANGE;
+    }
+
+    for (i = 0U; i < odt->entryCount; i++) {
+        if (i != daqPtrEntry) {
+            total += odtEntries[odt->firstEntry + i].size;
+        }
+    }
+    if ((total + cmd[2]) > CAN_XCP_ODT_DATA) {
+        return CAN_XCP_ERR_DAQ_CONFIG;
+    }
+
+    source = canXcp_resolve(canXcp_getU32(&cmd[4]), cmd[2], false, &error);
+    if (source == NULL) {
+        return error;
+    }
+
+    odtEntries[odt->firstEntry + daqPtrEntry].source = source;
+    odtEntries[odt->firstEntry + daqPtrEntry].size = cmd[2];
+    daqPtrEntry++;
+
+    return 0U;
+}
+
+/*
+ * START_STOP_DAQ_LIST: stop, start or select one list. The response
+ * carries the list's first packet identifier (absolute ODT number).
+ */
+static uint8_t canXcp_startStopDaqList(const uint8_t* cmd, uint8_t* res, uint8_t* resLength)
+{
+    uint16_t list = canXcp_getU16(&cmd[2]);
+    canXcpDaqList_t* daq;
+
+    if ((list >= daqListCount) || (cmd[1] > 2U)) {
+        return CAN_XCP_ERR_OUT_OF_RANGE;
+    }
+
+    daq = &daqLists[list];
+    if ((cmd[1] != 0U) && ((daq->odtCount == 0U) || (daq->prescaler == 0U))) {
+        return CAN_XCP_ERR_DAQ_CONFIG;
+    }
+
+    switch (cmd[1]) {
+        case 0U:
+            daq->mode &= (uint8_t)~CAN_XCP_DAQ_MODE_RUNNING;
+            break;
+        case 1U:
+            daq->prescalerCount = 0U;
+            daq->mode |= CAN_XCP_DAQ_MODE_RUNNING;
+            break;
+        default:
+            daq->mode |= CAN_XCP_DAQ_MODE_SELECTED;
+            break;
+    }
+    canXcp_updateRunning();
+
+    res[1] = (uint8_t)daq->firstOdt;
+    *resLength = 2U;
+
+    return 0U;
+}
+
+/*
+ * START_STOP_SYNCH: 0 stops all lists, 1 starts and 2 stops the selected ones
+ */
+static void canXcp_startStopSynch(uint8_t mode)
+{
+    uint16_t i;
+
+    for (i = 0U; i < daqListCount; i++) {
+        canXcpDaqList_t* daq = &daqLists[i];
+
+        if (mode == 0U) {
+            daq->mode &= (uint8_t)~CAN_XCP_DAQ_MODE_RUNNING;
+        } else if ((daq->mode & CAN_XCP_DAQ_MODE_SELECTED) != 0U) {
+            if (mode == 1U) {
+                daq->prescalerCount = 0U;
+                daq->mode |= CAN_XCP_DAQ_MODE_RUNNING;
+            } else {
+                daq->mode &= (uint8_t)~CAN_XCP_DAQ_MODE_RUNNING;
+            }
+        }
+        daq->mode &= (uint8_t)~CAN_XCP_DAQ_MODE_SELECTED;
+    }
+    canXcp_updateRunning();
+}
+
+/*
+ * Stop measurement and release every DAQ list, ODT and entry
+ */
+static void canXcp_freeDaq(void)
+{
+    memset(daqLists, 0, sizeof(daqLists));
+    memset(odts, 0, sizeof(odts));
+    memset(odtEntries, 0, sizeof(odtEntries));
+    daqListCount = 0U;
+    odtCount = 0U;
+    odtEntryCount = 0U;
+    daqPtrValid = false;
+    daqRunning = false;
+}
+
+/*
+ * Recompute the fast-path flag checked by canXcp_event
+ */
+static void canXcp_updateRunning(void)
+{
+    uint16_t i;
+
+    daqRunning = false;
+    for (i = 0U; i < daqListCount; i++) {
+        if ((daqLists[i].mode & CAN_XCP_DAQ_MODE_RUNNING) != 0U) {
+            daqRunning = true;
+        }
+    }
+}
+
+/*
+ * Translate an XCP address range into memory inside one registered region
+ */
+static uint8_t* canXcp_resolve(uint32_t address, uint32_t length, bool write, uint8_t* error)
+{
+    uint8_t i;
+
+    for (i = 0U; i < regionCount; i++) {
+        const canXcpRegion_t* region = &regions[i];
+
+        if ((address >= region->address) && ((address - region->address) < region->size) &&
+            (length <= (region->size - (address - region->address)))) {
+            if (write && !region->writable) {
+                *error = CAN_XCP_ERR_WRITE_PROTECTED;
+                return NULL;
+            }
+            return &region->data[address - region->address];
+        }
+    }
+
+    *error = CAN_XCP_ERR_ACCESS_DENIED;
+    return NULL;
+}
+
+/*
+ * Send a response or error packet on the DTO identifier
+ */
+static void canXcp_send(const uint8_t* data, uint8_t length)
+{
+    canFrame_t frame = {0};
+
+    frame.id = xcpConfig.dtoId;
+    frame.extended = xcpConfig.extended;
+    frame.dlc = length;
+    memcpy(frame.data, data, length);
+
+    (void)canManager_sendFrame(&frame);
+}
+
+/*
+ * Little-endian field accessors (XCP on this slave uses Intel byte order)
+ */
+static uint16_t canXcp_getU16(const uint8_t* data)
+{
+    return (uint16_t)(data[0] | ((uint16_t)data[1] << 8));
+}
+
+static uint32_t canXcp_getU32(const uint8_t* data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
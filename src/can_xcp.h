@@ -0,0 +1,83 @@
+#ifndef CAN_XCP_H
+#define CAN_XCP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "can_manager.h"
+
+#ifndef CAN_XCP_REGIONS
+#define CAN_XCP_REGIONS             (8U)
+#endif
+#ifndef CAN_XCP_DAQ_LISTS
+#define CAN_XCP_DAQ_LISTS           (4U)
+#endif
+#ifndef CAN_XCP_ODTS
+#define CAN_XCP_ODTS                (16U)
+#endif
+#ifndef CAN_XCP_ODT_ENTRIES
+#define CAN_XCP_ODT_ENTRIES         (64U)
+#endif
+#define CAN_XCP_MAX_CTO             (8U)
+#define CAN_XCP_MAX_DTO             (8U)
+#define CAN_XCP_ODT_DATA            (CAN_XCP_MAX_DTO - 1U)
+
+#define CAN_XCP_EVENT_LOOP          (0U)
+
+/* Commands */
+#define CAN_XCP_CMD_CONNECT             (0xFFU)
+#define CAN_XCP_CMD_DISCONNECT          (0xFEU)
+#define CAN_XCP_CMD_GET_STATUS          (0xFDU)
+#define CAN_XCP_CMD_SET_MTA             (0xF6U)
+#define CAN_XCP_CMD_UPLOAD              (0xF5U)
+#define CAN_XCP_CMD_SHORT_UPLOAD        (0xF4U)
+#define CAN_XCP_CMD_DOWNLOAD            (0xF0U)
+#define CAN_XCP_CMD_SET_DAQ_PTR         (0xE2U)
+#define CAN_XCP_CMD_WRITE_DAQ           (0xE1U)
+#define CAN_XCP_CMD_SET_DAQ_LIST_MODE   (0xE0U)
+#define CAN_XCP_CMD_START_STOP_DAQ_LIST (0xDEU)
+#define CAN_XCP_CMD_START_STOP_SYNCH    (0xDDU)
+#define CAN_XCP_CMD_FREE_DAQ            (0xD6U)
+#define CAN_XCP_CMD_ALLOC_DAQ           (0xD5U)
+#define CAN_XCP_CMD_ALLOC_ODT           (0xD4U)
+#define CAN_XCP_CMD_ALLOC_ODT_ENTRY     (0xD3U)
+
+/* Packet identifiers and error codes */
+#define CAN_XCP_PID_RES                 (0xFFU)
+#define CAN_XCP_PID_ERR                 (0xFEU)
+#define CAN_XCP_ERR_DAQ_ACTIVE          (0x11U)
+#define CAN_XCP_ERR_CMD_UNKNOWN         (0x20U)
+#define CAN_XCP_ERR_CMD_SYNTAX          (0x21U)
+#define CAN_XCP_ERR_OUT_OF_RANGE        (0x22U)
+#define CAN_XCP_ERR_WRITE_PROTECTED     (0x23U)
+#define CAN_XCP_ERR_ACCESS_DENIED       (0x24U)
+#define CAN_XCP_ERR_SEQUENCE            (0x29U)
+#define CAN_XCP_ERR_DAQ_CONFIG          (0x2AU)
+#define CAN_XCP_ERR_MEMORY_OVERFLOW     (0x30U)
+
+#define CAN_XCP_RESOURCE_DAQ            (0x04U)
+#define CAN_XCP_SESSION_DAQ_RUNNING     (0x40U)
+#define CAN_XCP_DAQ_MODE_SELECTED       (0x01U)
+#define CAN_XCP_DAQ_MODE_RUNNING        (0x40U)
+
+typedef struct {
+    uint32_t croId;
+    uint32_t dtoId;
+    bool extended;
+} canXcpConfig_t;
+
+typedef struct {
+    uint32_t commandCount;
+    uint32_t errorCount;
+    uint32_t eventCount;
+    uint32_t dtoCount;
+    uint32_t dtoOverrunCount;
+} canXcpStats_t;
+
+bool canXcp_init(const canXcpConfig_t* config);
+bool canXcp_addRegion(uint32_t address, void* data, uint32_t size, bool writable);
+void canXcp_event(uint16_t channel);
+bool canXcp_isConnected(void);
+bool canXcp_isDaqRunning(void);
+const canXcpStats_t* canXcp_getStats(void);
+
+#endif
@@ -5,7 +5,6 @@
 #include <unistd.h>
 #include <getopt.h>
 #include <signal.h>
-#include <time.h>
 
 #include "pid_controller.h"
 #include "temp_sensor.h"
@@ -13,8 +12,11 @@
 #include "fan_control.h"
 #include "dio_manager.h"
 #include "state_machine.h"
+#include "can_capture.h"
+#include "can_isotp.h"
+#include "time_base.h"
 
-#define LOOP_DELAY_NS (100000000)
+#define LOOP_PERIOD_US (100000U)
 #define MIN_SET_POINT (25.0f)
 #define MAX_SET_POINT (40.0f)
 
@@ -141,7 +143,8 @@ int parse_arguments(int argc, char* argv[])
  */
 int main(int argc, char* argv[])
 {
-    struct timespec timer = {0, LOOP_DELAY_NS};
+    uint64_t deadlineUs;
+    const char* capturePath = getenv("CAN_CAPTURE_FILE");
     
     printf("Cooling System\n");
     printf("================================\n");
@@ -159,14 +162,29 @@ int main(int argc, char* argv[])
     printf("  PID Gains: Kp=%.3f, Ki=%.3f, Kd=%.3f\n", 
            options->kp, options->ki, options->kd);
     printf("\n");
-        
+    
+    if ((capturePath != NULL) && !canCapture_start(capturePath)) {
+        printf("Warning: Failed to start CAN capture to '%s'\n", capturePath);
+    }
+
+    deadlineUs = timeBase_nowUs();
     while (running) {
         sm_update();
         canManager_processMessages();
+        canIsotp_poll();
         canManager_periodicSend();
-        nanosleep(&timer, NULL);
+        canManager_flushTx();
+
+        /* Absolute deadlines keep the period; after an overrun, resync */
+        deadlineUs += LOOP_PERIOD_US;
+        if (timeBase_nowUs() > deadlineUs) {
+            deadlineUs = timeBase_nowUs();
+        }
+        timeBase_sleepUntilUs(deadlineUs);
     }
     
+    canCapture_stop();
+    
     printf("\nShutdown complete.\n");
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "pid_controller.h"
+#include "time_base.h"
 #include <string.h>
 #include <math.h>
 
@@ -14,7 +15,9 @@ static pidController_t pidInstance =
     },
     0.0f,
     0.0f,
-    0.0f
+    0.0f,
+    0U,
+    false
 };
 static pidController_t* pid = &pidInstance;
 
@@ -30,6 +33,7 @@ bool pid_init(void)
     pid->prevError = 0.0f;
     pid->integral = 0.0f;
     pid->output = 0.0f;
+    pid->timeValid = false;
 
     return true;
 }
@@ -97,16 +101,33 @@ bool pid_setOutputLimits(float outputMin, float outputMax)
 }
 
 /*
- * Compute PID controller output
+ * Compute PID controller output. Gains are per PID_NOMINAL_PERIOD_US; the
+ * integral and derivative terms are scaled by the time since the previous
+ * call measured on the time base.
  */
 float pid_compute(float sampledValue)
 {
     float error, proportional, derivative;
+    float dtScale = 1.0f;
+    uint64_t now = timeBase_nowUs();
+
+    /* A repeated call within the same microsecond is the shortest interval,
+       not a nominal one */
+    if (pid->timeValid) {
+        dtScale = (now > pid->lastComputeUs) ?
+                  ((float)(now - pid->lastComputeUs) / (float)PID_NOMINAL_PERIOD_US) : 0.0f;
+        if (dtScale < PID_DT_SCALE_MIN) {
+            dtScale = PID_DT_SCALE_MIN;
+        } else if (dtScale > PID_DT_SCALE_MAX) {
+            dtScale = PID_DT_SCALE_MAX;
+        }
+    }
+    pid->lastComputeUs = now;
+    pid->timeValid = true;
 
     error = pid->config.setpoint - sampledValue;
     proportional = pid->config.kp * error;
-    derivative = pid->config.kd * (error - pid->prevError);
-    pid->integral += error;
+    pid->integral += error * dtScale;
     float max_integral = fabs(pid->config.outputMax - pid->config.outputMin) / (2.0f * fabs(pid->config.ki));
     if (pid->integral > max_integral) {
         pid->integral = max_integral;
@@ -116,7 +137,7 @@ float pid_compute(float sampledValue)
 
     float integral = pid->config.ki * pid->integral;
 
-    derivative = pid->config.kd * (error - pid->prevError);
+    derivative = pid->config.kd * (error - pid->prevError) / dtScale;
 
     float output = proportional + integral + derivative;
 
@@ -141,6 +162,7 @@ void pid_reset(void)
     pid->prevError = 0.0f;
     pid->integral = 0.0f;
     pid->output = 0.0f;
+    pid->timeValid = false;
 }
 
 /*
@@ -149,4 +171,12 @@ void pid_reset(void)
 float pid_getOutput(void)
 {
     return pid->output;
+}
+
+/*
+ * Controller instance, for measurement and calibration access
+ */
+pidController_t* pid_getController(void)
+{
+    return pid;
 }
\ No newline at end of file
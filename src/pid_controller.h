@@ -10,6 +10,9 @@
 #define PID_DEFAULT_SETPOINT    (25.0F)
 #define PID_DEFAULT_OUTPUT_MIN  (-100.0F)
 #define PID_DEFAULT_OUTPUT_MAX  (100.0F)
+#define PID_NOMINAL_PERIOD_US   (100000U)
+#define PID_DT_SCALE_MIN        (0.1F)
+#define PID_DT_SCALE_MAX        (10.0F)
 
 typedef struct {
     float kp;
@@ -25,6 +28,8 @@ typedef struct {
     float prevError;
     float integral;
     float output;
+    uint64_t lastComputeUs;
+    bool timeValid;
 } pidController_t;
 
 bool pid_init(void);
@@ -36,5 +41,6 @@ bool pid_setOutputLimits(float outputMin, float outputMax);
 float pid_compute(float process_value);
 void pid_reset(void);
 float pid_getOutput(void);
+pidController_t* pid_getController(void);
 
 #endif
\ No newline at end of file
@@ -5,9 +5,31 @@
 #include <stdbool.h>
 
 #include "state_machine.h"
+#include "time_base.h"
+#include "can_isotp.h"
+#include "can_xcp.h"
+#ifdef CAN_VBUS_ENABLED
+#include "can_vbus.h"
+#endif
 
 #define PID_LEVEL_PUMP (40.0f)
 
+#define SM_DIAG_CHANNEL         (0U)
+#define SM_DIAG_BLOCK_SIZE      (8U)
+#define SM_DIAG_PID_CALIBRATION (0x01U)
+#define SM_DIAG_READ_STATS      (0x02U)
+#define SM_DIAG_POSITIVE        (0x40U)
+#define SM_DIAG_NEGATIVE        (0x7FU)
+
+#define SM_XCP_ADDR_PID         (0x00010000U)
+#define SM_XCP_ADDR_INPUTS      (0x00020000U)
+#define SM_XCP_ADDR_PID_OUTPUT  (0x00030000U)
+
+#ifdef CAN_VBUS_ENABLED
+/* Joined when CAN_VBUS names a shared-memory bus, e.g. CAN_VBUS=/rig0 */
+static canVbus_t smVbus;
+#endif
+
 /* Forward declarations for state functions */
 void sm_init_entry(void);
 void sm_init_handler(void);
@@ -92,7 +114,9 @@ static smInputs_t* smInputs = &smInstance;
 static smState_t nextState;
 static smState_t previousState = SM_INIT;
 static smState_t currentState = SM_INIT;
+static uint32_t stateEntryMs;
 static float pidOutput;
+static uint8_t diagResponse[CAN_ISOTP_MAX_PAYLOAD];
 
 /*
  * Update system inputs from sensors and switches
@@ -131,6 +155,65 @@ static void sm_updateInputs(void)
     }
 }
 
+/*
+ * Little-endian 32-bit store for diagnostic responses
+ */
+static uint32_t sm_putU32(uint8_t* data, uint32_t offset, uint32_t value)
+{
+    data[offset] = (uint8_t)value;
+    data[offset + 1U] = (uint8_t)(value >> 8);
+    data[offset + 2U] = (uint8_t)(value >> 16);
+    data[offset + 3U] = (uint8_t)(value >> 24);
+
+    return offset + 4U;
+}
+
+/*
+ * ISO-TP diagnostic requests. PID calibration carries the gains and
+ * setpoint as full-precision floats; the stats read uploads the CAN
+ * counters and the per-ID table.
+ */
+static void sm_handleDiagRequest(uint8_t channel, const uint8_t* data, uint32_t length)
+{
+    const canStats_t* stats;
+    uint32_t offset = 0U;
+    uint32_t i;
+
+    if ((data[0] == SM_DIAG_PID_CALIBRATION) && (length == 17U)) {
+        float kp = canManager_bytesToFloat(&data[1]);
+        float ki = canManager_bytesToFloat(&data[5]);
+        float kd = canManager_bytesToFloat(&data[9]);
+        float setpoint = canManager_bytesToFloat(&data[13]);
+
+        if ((kp >= 0.0f) && (ki >= 0.0f) && (kd >= 0.0f) &&
+            pid_setGains(kp, ki, kd) && pid_setSetpoint(setpoint)) {
+            diagResponse[offset++] = SM_DIAG_PID_CALIBRATION | SM_DIAG_POSITIVE;
+            (void)canIsotp_send(channel, diagResponse, offset);
+            return;
+        }
+    } else if ((data[0] == SM_DIAG_READ_STATS) && (length == 1U)) {
+        stats = canManager_getStats();
+        diagResponse[offset++] = SM_DIAG_READ_STATS | SM_DIAG_POSITIVE;
+        offset = sm_putU32(diagResponse, offset, stats->txCount);
+        offset = sm_putU32(diagResponse, offset, stats->rxCount);
+        offset = sm_putU32(diagResponse, offset, stats->errorCount);
+        offset = sm_putU32(diagResponse, offset, stats->busOffCount);
+        offset = sm_putU32(diagResponse, offset, stats->busLoadPermille);
+        offset = sm_putU32(diagResponse, offset, stats->idStatsCount);
+        for (i = 0U; i < stats->idStatsCount; i++) {
+            offset = sm_putU32(diagResponse, offset, stats->idStats[i].id);
+            offset = sm_putU32(diagResponse, offset, stats->idStats[i].txCount);
+            offset = sm_putU32(diagResponse, offset, stats->idStats[i].rxCount);
+        }
+        (void)canIsotp_send(channel, diagResponse, offset);
+        return;
+    }
+
+    diagResponse[offset++] = SM_DIAG_NEGATIVE;
+    diagResponse[offset++] = data[0];
+    (void)canIsotp_send(channel, diagResponse, offset);
+}
+
 /*
  * Initialize all system components
  */
@@ -173,14 +256,59 @@ static bool sm_systemInitialization(void)
         printf("Fan control initialized\n");
     }
 
-    canConfig_t canConfig;
+    canConfig_t canConfig = {0};
     canConfig.baudrate = 250000;
+    canConfig.txMode = CAN_TX_MODE_ON_CHANGE;
+    canConfig.heartbeatMs = CAN_TX_HEARTBEAT_MS_DEFAULT;
+    canConfig.deadband.temperature = CAN_TX_DEADBAND_TEMP;
+    canConfig.deadband.dutyCycle = CAN_TX_DEADBAND_DUTY;
+    canConfig.deadband.pidGain = CAN_TX_DEADBAND_GAIN;
+    canConfig.deadband.setpoint = CAN_TX_DEADBAND_SETPOINT;
+#ifdef DEBUG
+    canConfig.tap = canManager_printTap;
+#endif
+#ifdef CAN_VBUS_ENABLED
+    smVbus.name = getenv("CAN_VBUS");
+    if (smVbus.name != NULL) {
+        smVbus.bitTiming = true;
+        smVbus.arbitrationOrder = true;
+        canConfig.transport = &canTransport_vbus;
+        canConfig.transportContext = &smVbus;
+        printf("CAN on virtual bus %s\n", smVbus.name);
+    }
+#endif
     
     if (!canManager_init(&canConfig)) {
         printf("ERROR: Failed to initialize CAN manager\n");
         initResult = false;
     } else {
-        printf("CAN initialized\n");
+        canScheduleReport_t schedule;
+        canIsotpConfig_t diagConfig = {0};
+        canXcpConfig_t xcpConfig = {0};
+        
+        diagConfig.txId = CAN_MSG_DIAG_RESPONSE;
+        diagConfig.rxId = CAN_MSG_DIAG_REQUEST;
+        diagConfig.blockSize = SM_DIAG_BLOCK_SIZE;
+        diagConfig.padding = true;
+        diagConfig.rxCallback = sm_handleDiagRequest;
+        if (!canIsotp_open(SM_DIAG_CHANNEL, &diagConfig)) {
+            printf("ERROR: Failed to open diagnostic ISO-TP channel\n");
+            initResult = false;
+        }
+        
+        xcpConfig.croId = CAN_MSG_XCP_CRO;
+        xcpConfig.dtoId = CAN_MSG_XCP_DTO;
+        if (!canXcp_init(&xcpConfig) ||
+            !canXcp_addRegion(SM_XCP_ADDR_PID, pid_getController(), sizeof(pidController_t), true) ||
+            !canXcp_addRegion(SM_XCP_ADDR_INPUTS, smInputs, sizeof(smInputs_t), false) ||
+            !canXcp_addRegion(SM_XCP_ADDR_PID_OUTPUT, &pidOutput, sizeof(pidOutput), false)) {
+            printf("ERROR: Failed to initialize XCP slave\n");
+            initResult = false;
+        }
+        
+        canManager_getScheduleReport(&schedule);
+        printf("CAN initialized (schedule worst case: %u frames/tick, %u.%u%% bus load)\n",
+               schedule.framesPerTickMax, schedule.busLoadPermilleMax / 10U, schedule.busLoadPermilleMax % 10U);
     }
     
     if (initResult) {
@@ -220,7 +348,10 @@ void sm_update(void)
     if (nextState != currentState) {
         previousState = currentState;
         currentState = nextState;
+        stateEntryMs = timeBase_nowMs();
     }
+    
+    canXcp_event(CAN_XCP_EVENT_LOOP);
 }
 
 /*
@@ -231,6 +362,14 @@ smState_t sm_getCurrentState(void)
     return currentState;
 }
 
+/*
+ * Time spent in the current state in milliseconds
+ */
+uint32_t sm_getStateTimeMs(void)
+{
+    return timeBase_nowMs() - stateEntryMs;
+}
+
 /*
  * SM_INIT State Functions
  */
@@ -428,7 +567,6 @@ void sm_fault_entry(void)
 {
     pump_setMaxSpeed();
     fan_setMaxSpeed();
-    canManager_sendSystemStatus(SM_FAULT, smInputs->ignitionSwitch, smInputs->coolantLevel, smInputs->smFault.faultInfo);
 }
 
 void sm_fault_handler(void)
@@ -46,5 +46,6 @@ typedef struct {
 
 void sm_update(void);
 smState_t sm_getCurrentState(void);
+uint32_t sm_getStateTimeMs(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "time_base.h"
+#include <errno.h>
+#include <stdatomic.h>
+#include <time.h>
+
+static atomic_bool virtualClock;
+static _Atomic uint64_t virtualNowUs;
+
+/*
+ * Current time in microseconds: CLOCK_MONOTONIC, or the virtual clock
+ */
+uint64_t timeBase_nowUs(void)
+{
+    struct timespec ts;
+
+    if (atomic_load_explicit(&virtualClock, memory_order_relaxed)) {
+        return atomic_load_explicit(&virtualNowUs, memory_order_relaxed);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U);
+}
+
+/*
+ * Current time in milliseconds (wraps after ~49 days; compare by subtraction)
+ */
+uint32_t timeBase_nowMs(void)
+{
+    return (uint32_t)(timeBase_nowUs() / 1000U);
+}
+
+/*
+ * Sleep until an absolute deadline. The virtual clock jumps straight to
+ * the deadline instead of sleeping.
+ */
+void timeBase_sleepUntilUs(uint64_t deadlineUs)
+{
+    struct timespec ts;
+
+    if (atomic_load_explicit(&virtualClock, memory_order_relaxed)) {
+        if (deadlineUs > atomic_load_explicit(&virtualNowUs, memory_order_relaxed)) {
+            atomic_store_explicit(&virtualNowUs, deadlineUs, memory_order_relaxed);
+        }
+        return;
+    }
+
+    ts.tv_sec = (time_t)(deadlineUs / 1000000U);
+    ts.tv_nsec = (long)((deadlineUs % 1000000U) * 1000U);
+
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+/*
+ * Use the system monotonic clock (default)
+ */
+void timeBase_useMonotonic(void)
+{
+    atomic_store_explicit(&virtualClock, false, memory_order_relaxed);
+}
+
+/*
+ * Use a virtual clock starting at startUs that only moves through
+ * timeBase_advanceUs and timeBase_sleepUntilUs (advance it from one thread)
+ */
+void timeBase_useVirtual(uint64_t startUs)
+{
+    atomic_store_explicit(&virtualNowUs, startUs, memory_order_relaxed);
+    atomic_store_explicit(&virtualClock, true, memory_order_relaxed);
+}
+
+/*
+ * Whether the virtual clock is active
+ */
+bool timeBase_isVirtual(void)
+{
+    return atomic_load_explicit(&virtualClock, memory_order_relaxed);
+}
+
+/*
+ * Move the virtual clock forward (ignored on the monotonic clock)
+ */
+void timeBase_advanceUs(uint64_t us)
+{
+    if (atomic_load_explicit(&virtualClock, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&virtualNowUs, us, memory_order_relaxed);
+    }
+}
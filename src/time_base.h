@@ -0,0 +1,15 @@
+#ifndef TIME_BASE_H
+#define TIME_BASE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+uint64_t timeBase_nowUs(void);
+uint32_t timeBase_nowMs(void);
+void timeBase_sleepUntilUs(uint64_t deadlineUs);
+void timeBase_useMonotonic(void);
+void timeBase_useVirtual(uint64_t startUs);
+bool timeBase_isVirtual(void);
+void timeBase_advanceUs(uint64_t us);
+
+#endif
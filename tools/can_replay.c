@@ -0,0 +1,94 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "can_manager.h"
+#include "can_capture.h"
+
+static void print_usage(const char* program_name);
+
+/*
+ * Print usage information
+ */
+static void print_usage(const char* program_name)
+{
+    printf("Usage: %s [-m] [-t] [-q] [-c <file.log>] [-i <ifname>] <capture.bin>\n", program_name);
+    printf("  -m  Replay at maximum speed instead of the recorded timing\n");
+    printf("  -t  Replay transmitted frames as well as received ones\n");
+    printf("  -q  Do not print replayed frames\n");
+    printf("  -c  Export the capture in candump log format instead of replaying\n");
+    printf("  -i  Interface name for the candump export (default: can0)\n");
+}
+
+/*
+ * Replay a binary CAN capture into the CAN manager RX path, or export it
+ */
+int main(int argc, char* argv[])
+{
+    canReplaySpeed_t speed = CAN_REPLAY_ORIGINAL_SPEED;
+    const char* exportPath = NULL;
+    const char* interfaceName = "can0";
+    bool includeTx = false;
+    bool quiet = false;
+    canConfig_t config = {0};
+    uint32_t replayed = 0U;
+    int option;
+
+    while ((option = getopt(argc, argv, "mtqc:i:")) != -1) {
+        switch (option) {
+            case 'm':
+                speed = CAN_REPLAY_MAX_SPEED;
+                break;
+            case 't':
+                includeTx = true;
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            case 'c':
+                exportPath = optarg;
+                break;
+            case 'i':
+                interfaceName = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind != (argc - 1)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (exportPath != NULL) {
+        if (!canCapture_exportCandump(argv[optind], exportPath, interfaceName)) {
+            printf("Error: Failed to export '%s'\n", argv[optind]);
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+    config.baudrate = 250000;
+    config.fdEnabled = true;
+    config.tap = quiet ? NULL : canManager_printTap;
+    if (!canManager_init(&config)) {
+        printf("Error: CAN manager initialization failed\n");
+        return EXIT_FAILURE;
+    }
+    canManager_setRxCallback(NULL);
+
+    if (!canCapture_replay(argv[optind], speed, includeTx, &replayed)) {
+        printf("Error: Failed to read capture '%s'\n", argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    printf("Replayed %u frames (%u filtered, %u overruns)\n", replayed,
+           canManager_getStats()->rxFilteredCount, canManager_getStats()->rxOverrunCount);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,289 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "can_manager.h"
+#include "can_rta.h"
+
+#define CAN_RTA_BAUDRATE_DEFAULT    (250000U)
+#define CAN_RTA_LINE_MAX            (256U)
+
+static void print_usage(const char* program_name);
+static uint32_t can_rta_builtin(const canConfig_t* config, uint32_t jitterUs, canRtaMessage_t* messages);
+static bool can_rta_parseLine(char* line, canRtaMessage_t* message);
+static bool can_rta_load(const char* path, canRtaMessage_t* messages, uint32_t* count);
+static void can_rta_print(const canRtaMessage_t* messages, const canRtaResult_t* results, uint32_t count);
+
+/*
+ * Print usage information
+ */
+static void print_usage(const char* program_name)
+{
+    printf("Usage: %s [-b baudrate] [-d data_baudrate] [-c] [-j jitter_us] [-f catalog] [-n] [-q]\n", program_name);
+    printf("  -b  Nominal bit rate (default: %u)\n", CAN_RTA_BAUDRATE_DEFAULT);
+    printf("  -d  CAN-FD data bit rate; enables FD\n");
+    printf("  -c  Consolidated FD status frame instead of the classic status frames (needs -d)\n");
+    printf("  -j  Queuing jitter of the controller's own messages in us (default: 0)\n");
+    printf("  -f  Additional messages, one per line:\n");
+    printf("      <id> <length> <period_ms> [jitter_ms [deadline_ms]] [ext] [fd] [brs]\n");
+    printf("  -n  Leave out the controller's own schedule\n");
+    printf("  -q  Print the summary only\n");
+    printf("Exits with failure when any message can miss its deadline.\n");
+}
+
+/*
+ * The controller's periodic message set as the CAN manager schedules it
+ * for this configuration
+ */
+static uint32_t can_rta_builtin(const canConfig_t* config, uint32_t jitterUs, canRtaMessage_t* messages)
+{
+    canScheduleInfo_t schedule[CAN_RTA_MESSAGES_MAX];
+    uint32_t count;
+    uint32_t i;
+
+    if (!canManager_init(config)) {
+        return 0U;
+    }
+
+    count = canManager_getSchedule(schedule, CAN_RTA_MESSAGES_MAX);
+    for (i = 0U; i < count; i++) {
+        memset(&messages[i], 0, sizeof(messages[i]));
+        messages[i].id = schedule[i].id;
+        messages[i].length = schedule[i].length;
+        messages[i].fd = schedule[i].fd;
+        messages[i].brs = schedule[i].fd;
+        messages[i].periodUs = schedule[i].periodMs * 1000U;
+        messages[i].jitterUs = jitterUs;
+    }
+
+    return count;
+}
+
+/*
+ * Parse one catalog line. Blank lines and '#' comments yield false with
+ * message->periodUs left 0; malformed lines yield false with it set to 1.
+ */
+static bool can_rta_parseLine(char* line, canRtaMessage_t* message)
+{
+    double values[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+    uint32_t fields = 0U;
+    char* context = NULL;
+    char* token;
+    char* end;
+
+    memset(message, 0, sizeof(*message));
+
+    for (token = strtok_r(line, " \t\r\n", &context); token != NULL; token = strtok_r(NULL, " \t\r\n", &context)) {
+        if (token[0] == '#') {
+            break;
+        }
+        if (strcmp(token, "ext") == 0) {
+            message->extended = true;
+        } else if (strcmp(token, "fd") == 0) {
+            message->fd = true;
+        } else if (strcmp(token, "brs") == 0) {
+            message->brs = true;
+        } else if (fields < 5U) {
+            values[fields] = (fields == 0U) ? (double)strtoul(token, &end, 0) : strtod(token, &end);
+            if ((*end != '\0') || (values[fields] < 0.0)) {
+                message->periodUs = 1U;
+                return false;
+            }
+            fields++;
+        } else {
+            message->periodUs = 1U;
+            return false;
+        }
+    }
+
+    if (fields == 0U) {
+        return false;
+    }
+    if ((fields < 3U) || (values[2] <= 0.0)) {
+        message->periodUs = 1U;
+        return false;
+    }
+
+    message->id = (uint32_t)values[0];
+    message->length = (uint8_t)values[1];
+    message->periodUs = (uint32_t)(values[2] * 1000.0);
+    message->jitterUs = (uint32_t)(values[3] * 1000.0);
+    message->deadlineUs = (uint32_t)(values[4] * 1000.0);
+
+    return true;
+}
+
+/*
+ * Append the messages of a catalog file
+ */
+static bool can_rta_load(const char* path, canRtaMessage_t* messages, uint32_t* count)
+{
+    char line[CAN_RTA_LINE_MAX];
+    canRtaMessage_t message;
+    uint32_t lineNumber = 0U;
+    FILE* file = fopen(path, "r");
+
+    if (file == NULL) {
+        printf("Error: Cannot open '%s'\n", path);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lineNumber++;
+        if (can_rta_parseLine(line, &message)) {
+            if (*count >= CAN_RTA_MESSAGES_MAX) {
+                printf("Error: More than %u messages\n", CAN_RTA_MESSAGES_MAX);
+                (void)fclose(file);
+                return false;
+            }
+            messages[*count] = message;
+            (*count)++;
+        } else if (message.periodUs != 0U) {
+            printf("Error: %s:%u: Malformed message\n", path, lineNumber);
+            (void)fclose(file);
+            return false;
+        }
+    }
+
+    (void)fclose(file);
+
+    return true;
+}
+
+/*
+ * Per-message table, highest priority first
+ */
+static void can_rta_print(const canRtaMessage_t* messages, const canRtaResult_t* results, uint32_t count)
+{
+    uint32_t order[CAN_RTA_MESSAGES_MAX];
+    uint32_t keys[CAN_RTA_MESSAGES_MAX];
+    canFrame_t frame;
+    char idText[16];
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0U; i < count; i++) {
+        memset(&frame, 0, sizeof(frame));
+        frame.id = messages[i].id;
+        frame.extended = messages[i].extended;
+        keys[i] = canManager_arbitrationKey(&frame);
+        for (j = i; (j > 0U) && (keys[order[j - 1U]] > keys[i]); j--) {
+            order[j] = order[j - 1U];
+        }
+        order[j] = i;
+    }
+
+    printf("  %-10s %3s %10s %10s %10s %9s %9s %10s\n",
+           "ID", "Len", "Period", "Jitter", "Deadline", "C", "B", "R");
+    for (i = 0U; i < count; i++) {
+        const canRtaMessage_t* message = &messages[order[i]];
+        const canRtaResult_t* result = &results[order[i]];
+        uint32_t deadlineUs = (message->deadlineUs != 0U) ? message->deadlineUs : message->periodUs;
+
+        (void)snprintf(idText, sizeof(idText), message->extended ? "0x%08X" : "0x%03X", message->id);
+        printf("  %-10s %3u %8.3fms %8.3fms %8.3fms %7.1fus %7.1fus ", idText, message->length,
+               (double)message->periodUs / 1000.0, (double)message->jitterUs / 1000.0, (double)deadlineUs / 1000.0, (double)result->frameTimeNs / 1000.0,
+               (double)result->blockingNs / 1000.0);
+        if (result->responseNs == UINT64_MAX) {
+            printf("%10s MISS (overload)\n", "-");
+        } else {
+            printf("%8.3fms %s\n", (double)result->responseNs / 1000000.0, result->schedulable ? "ok" : "MISS");
+        }
+    }
+}
+
+/*
+ * Worst-case response-time analysis of the controller's CAN message set,
+ * optionally with the rest of the bus from a catalog file
+ */
+int main(int argc, char* argv[])
+{
+    canRtaMessage_t messages[CAN_RTA_MESSAGES_MAX];
+    canRtaResult_t results[CAN_RTA_MESSAGES_MAX];
+    canRtaReport_t report = {0};
+    canConfig_t config = {0};
+    const char* catalogPath = NULL;
+    uint32_t jitterUs = 0U;
+    uint32_t count = 0U;
+    bool builtin = true;
+    bool quiet = false;
+    int option;
+
+    config.baudrate = CAN_RTA_BAUDRATE_DEFAULT;
+
+    while ((option = getopt(argc, argv, "b:d:cj:f:nq")) != -1) {
+        switch (option) {
+            case 'b':
+                config.baudrate = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                config.dataBaudrate = (uint32_t)strtoul(optarg, NULL, 0);
+                config.fdEnabled = true;
+                break;
+            case 'c':
+                config.consolidatedStatus = true;
+                break;
+            case 'j':
+                jitterUs = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                catalogPath = optarg;
+                break;
+            case 'n':
+                builtin = false;
+                break;
+            case 'q':
+                quiet = true;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if ((optind != argc) || (config.baudrate == 0U) || (config.consolidatedStatus && !config.fdEnabled)) {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (builtin) {
+        count = can_rta_builtin(&config, jitterUs, messages);
+        if (count == 0U) {
+            printf("Error: CAN manager initialization failed\n");
+            return EXIT_FAILURE;
+        }
+    }
+
+    if ((catalogPath != NULL) && !can_rta_load(catalogPath, messages, &count)) {
+        return EXIT_FAILURE;
+    }
+
+    if (!canRta_analyze(messages, count, config.baudrate, config.dataBaudrate, results, &report) &&
+        (report.unschedulableCount == 0U)) {
+        printf("Error: Invalid message set\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("CAN response-time analysis: %u messages at %u bit/s", count, config.baudrate);
+    if (config.fdEnabled) {
+        printf(", data phase %u bit/s", (config.dataBaudrate != 0U) ? config.dataBaudrate : config.baudrate);
+    }
+    printf("\n");
+    if (!quiet) {
+        can_rta_print(messages, results, count);
+    }
+    printf("Bus utilization: %u.%u %%\n", report.utilizationPermille / 10U, report.utilizationPermille % 10U);
+
+    if (!report.schedulable) {
+        printf("Result: %u of %u messages can miss their deadline\n", report.unschedulableCount, count);
+        return EXIT_FAILURE;
+    }
+
+    printf("Result: schedulable, worst slack %.3f ms\n", (double)report.worstSlackNs / 1000000.0);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,427 @@
+#!/usr/bin/env python3
+"""Generate C pack/unpack functions from a DBC message description.
+
+Usage: dbc_codegen.py <input.dbc> <output_dir> [--name can_db]
+
+Writes <output_dir>/<name>.h holding message constants, one struct per
+message and static inline pack/unpack functions, so callers get the codec
+inlined at the call site.
+
+Supports the subset of DBC used by this project: BO_ (messages), SG_
+(signals, Intel and Motorola byte order, signed/unsigned, factor/offset,
+min/max) and SIG_VALTYPE_ (IEEE float/double signals). Every pack/unpack
+function is emitted as straight-line byte operations with all shifts and
+masks resolved at generation time.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+MESSAGE_RE = re.compile(r'^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)')
+SIGNAL_RE = re.compile(
+    r'^SG_\s+(\w+)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*'
+    r'\(\s*([-+0-9.eE]+)\s*,\s*([-+0-9.eE]+)\s*\)\s*'
+    r'\[\s*([-+0-9.eE]+)\s*\|\s*([-+0-9.eE]+)\s*\]\s*"([^"]*)"')
+VALTYPE_RE = re.compile(r'^SIG_VALTYPE_\s+(\d+)\s+(\w+)\s*:\s*([12])\s*;')
+
+EXTENDED_FLAG = 0x80000000
+
+
+class Signal:
+    def __init__(self, name, start, length, intel, signed, factor, offset,
+                 minimum, maximum, unit):
+        self.name = name
+        self.start = start
+        self.length = length
+        self.intel = intel
+        self.signed = signed
+        self.factor = factor
+        self.offset = offset
+        self.minimum = minimum
+        self.maximum = maximum
+        self.unit = unit
+        self.valtype = 0
+
+    @property
+    def is_float(self):
+        return self.valtype != 0
+
+    @property
+    def is_scaled(self):
+        return self.is_float or self.factor != 1.0 or self.offset != 0.0 \
+            or not float(self.factor).is_integer()
+
+    @property
+    def has_range(self):
+        return self.minimum < self.maximum
+
+    @property
+    def raw_type(self):
+        width = 8
+        while width < self.length:
+            width *= 2
+        return 'uint%d_t' % width
+
+    @property
+    def raw_width(self):
+        return int(self.raw_type[4:-2])
+
+    @property
+    def phys_type(self):
+        if self.valtype == 2:
+            return 'double'
+        if self.is_scaled:
+            return 'float'
+        return ('int%d_t' if self.signed else 'uint%d_t') % self.raw_width
+
+    @property
+    def upper(self):
+        return re.sub(r'(?<=[a-z0-9])(?=[A-Z])', '_', self.name).upper()
+
+    @property
+    def field(self):
+        return self.name[0].lower() + self.name[1:]
+
+    def bit_positions(self):
+        """Frame bit position of every raw bit, LSB first."""
+        positions = []
+        if self.intel:
+            for i in range(self.length):
+                positions.append(self.start + i)
+        else:
+            pos = self.start
+            msb_first = []
+            for _ in range(self.length):
+                msb_first.append(pos)
+                pos = pos + 15 if pos % 8 == 0 else pos - 1
+            positions = list(reversed(msb_first))
+        return positions
+
+    def byte_chunks(self):
+        """(byte, lowest raw bit, bit count, bit offset in byte) per byte."""
+        chunks = {}
+        for raw_bit, pos in enumerate(self.bit_positions()):
+            byte = pos // 8
+            if byte not in chunks:
+                chunks[byte] = [raw_bit, 0, pos % 8]
+            chunks[byte][1] += 1
+        return sorted((byte, lo, count, off) for byte, (lo, count, off) in chunks.items())
+
+
+class Message:
+    def __init__(self, frame_id, name, length, sender):
+        self.extended = bool(frame_id & EXTENDED_FLAG)
+        self.frame_id = frame_id & ~EXTENDED_FLAG
+        self.name = name
+        self.length = length
+        self.sender = sender
+        self.signals = []
+
+    @property
+    def camel(self):
+        return ''.join(part.capitalize() for part in self.name.lower().split('_'))
+
+
+def parse_dbc(path):
+    messages = []
+    by_id = {}
+    current = None
+    with open(path, encoding='utf-8') as dbc:
+        for number, line in enumerate(dbc, 1):
+            text = line.strip()
+            match = MESSAGE_RE.match(text)
+            if match:
+                current = Message(int(match.group(1)), match.group(2),
+                                  int(match.group(3)), match.group(4))
+                messages.append(current)
+                by_id[int(match.group(1))] = current
+                continue
+            match = SIGNAL_RE.match(text)
+            if match:
+                if current is None:
+                    sys.exit('%s:%d: signal outside message' % (path, number))
+                current.signals.append(Signal(
+                    match.group(1), int(match.group(2)), int(match.group(3)),
+                    match.group(4) == '1', match.group(5) == '-',
+                    float(match.group(6)), float(match.group(7)),
+                    float(match.group(8)), float(match.group(9)), match.group(10)))
+                continue
+            match = VALTYPE_RE.match(text)
+            if match:
+                message = by_id.get(int(match.group(1)))
+                signal = None
+                if message is not None:
+                    signal = next((s for s in message.signals if s.name == match.group(2)), None)
+                if signal is None:
+                    sys.exit('%s:%d: SIG_VALTYPE_ for unknown signal' % (path, number))
+                signal.valtype = int(match.group(3))
+                if signal.length != (32 if signal.valtype == 1 else 64):
+                    sys.exit('%s:%d: float signal %s has wrong length' % (path, number, signal.name))
+                continue
+    for message in messages:
+        for signal in message.signals:
+            last = max(signal.bit_positions())
+            if min(signal.bit_positions()) < 0 or last >= message.length * 8:
+                sys.exit('%s: signal %s.%s does not fit in %d bytes'
+                         % (path, message.name, signal.name, message.length))
+    return messages
+
+
+def c_float(value):
+    text = repr(float(value))
+    if 'e' not in text and '.' not in text:
+        text += '.0'
+    return '(%sF)' % text
+
+
+def c_limit(signal, value):
+    if signal.is_scaled:
+        return c_float(value)
+    if signal.signed:
+        return '(%d)' % int(value)
+    return '(%dU)' % int(value)
+
+
+def emit_header(messages, name, source):
+    guard = name.upper() + '_H'
+    prefix = name.upper()
+    out = []
+    out.append('/* Generated by tools/dbc_codegen.py from %s. Do not edit. */' % source)
+    out.append('#ifndef %s' % guard)
+    out.append('#define %s' % guard)
+    out.append('')
+    out.append('#include <stdint.h>')
+    out.append('#include <stdbool.h>')
+    out.append('#include <string.h>')
+    out.append('')
+    for message in messages:
+        base = '%s_%s' % (prefix, message.name)
+        out.append('#define %-40s (0x%XU)' % (base + '_ID', message.frame_id))
+        out.append('#define %-40s (%dU)' % (base + '_LENGTH', message.length))
+        out.append('#define %-40s (%s)' % (base + '_EXTENDED', 'true' if message.extended else 'false'))
+        for signal in message.signals:
+            sig = '%s_%s' % (base, signal.upper)
+            if signal.is_scaled and not signal.is_float:
+                out.append('#define %-40s %s' % (sig + '_FACTOR', c_float(signal.factor)))
+                out.append('#define %-40s %s' % (sig + '_OFFSET', c_float(signal.offset)))
+            if signal.has_range:
+                out.append('#define %-40s %s' % (sig + '_MIN', c_limit(signal, signal.minimum)))
+                out.append('#define %-40s %s' % (sig + '_MAX', c_limit(signal, signal.maximum)))
+        out.append('')
+    for message in messages:
+        out.append('typedef struct {')
+        for signal in message.signals:
+            out.append('    %s %s;' % (signal.phys_type, signal.field))
+        out.append('} %s%s_t;' % (camel_prefix(name), message.camel))
+        out.append('')
+    camel = camel_prefix(name)
+    for message in messages:
+        type_name = '%s%s_t' % (camel, message.camel)
+        out.append('/*')
+        out.append(' * Pack %s (0x%X); out-of-range values are saturated and reported' % (message.name, message.frame_id))
+        out.append(' */')
+        out.append('static inline bool %s_pack%s(const %s* msg, uint8_t* data)' % (camel, message.camel, type_name))
+        out.append('{')
+        out.append('    bool inRange = true;')
+        out.append('')
+        out.append('    memset(data, 0, %s_%s_LENGTH);' % (prefix, message.name))
+        for signal in message.signals:
+            out.append('')
+            emit_pack_signal(message, signal, prefix, out)
+        out.append('')
+        out.append('    return inRange;')
+        out.append('}')
+        out.append('')
+        out.append('/*')
+        out.append(' * Unpack %s (0x%X); fails on short frames or out-of-range values' % (message.name, message.frame_id))
+        out.append(' */')
+        out.append('static inline bool %s_unpack%s(%s* msg, const uint8_t* data, uint8_t length)' % (camel, message.camel, type_name))
+        out.append('{')
+        out.append('    bool inRange = true;')
+        out.append('')
+        out.append('    if (length < %s_%s_LENGTH) {' % (prefix, message.name))
+        out.append('        return false;')
+        out.append('    }')
+        for signal in message.signals:
+            out.append('')
+            emit_unpack_signal(message, signal, prefix, out)
+        out.append('')
+        out.append('    return inRange;')
+        out.append('}')
+        out.append('')
+    out.append('#endif')
+    return '\n'.join(out) + '\n'
+
+
+def camel_prefix(name):
+    parts = name.split('_')
+    return parts[0] + ''.join(part.capitalize() for part in parts[1:])
+
+
+def range_limits(signal, sig):
+    """C expressions for the lower/upper bound, None where the check is
+    implied by the C type (avoids always-false comparisons)."""
+    low = sig + '_MIN'
+    high = sig + '_MAX'
+    if signal.is_scaled:
+        return low, high
+    if not signal.signed and signal.minimum <= 0:
+        low = None
+    if signal.signed:
+        type_max = (1 << (signal.raw_width - 1)) - 1
+    else:
+        type_max = (1 << signal.raw_width) - 1
+    if signal.maximum >= type_max:
+        high = None
+    return low, high
+
+
+def decoded_extremes(signal):
+    """Smallest and largest physical value the raw bits can decode to, or
+    (None, None) for IEEE signals whose range cannot be bounded this way."""
+    if signal.is_float:
+        return None, None
+    if signal.signed:
+        raw_low, raw_high = -(1 << (signal.length - 1)), (1 << (signal.length - 1)) - 1
+    else:
+        raw_low, raw_high = 0, (1 << signal.length) - 1
+    ends = sorted((raw_low * signal.factor + signal.offset, raw_high * signal.factor + signal.offset))
+    return ends[0], ends[1]
+
+
+def emit_pack_signal(message, signal, prefix, out):
+    sig = '%s_%s_%s' % (prefix, message.name, signal.upper)
+    raw = signal.field + 'Raw'
+    out.append('    /* %s */' % signal.name)
+    value = 'msg->%s' % signal.field
+    if signal.has_range:
+        low, high = range_limits(signal, sig)
+        if low is not None or high is not None:
+            out.append('    %s %sValue = %s;' % (signal.phys_type, signal.field, value))
+            value = signal.field + 'Value'
+            keyword = 'if'
+            if low is not None:
+                out.append('    if (%s < %s) {' % (value, low))
+                out.append('        %s = %s;' % (value, low))
+                out.append('        inRange = false;')
+                keyword = '} else if'
+            if high is not None:
+                out.append('    %s (%s > %s) {' % (keyword, value, high))
+                out.append('        %s = %s;' % (value, high))
+                out.append('        inRange = false;')
+            out.append('    }')
+    if signal.valtype == 1:
+        out.append('    float %sFloat = (float)%s;' % (signal.field, value))
+        out.append('    %s %s;' % (signal.raw_type, raw))
+        out.append('    memcpy(&%s, &%sFloat, sizeof(%s));' % (raw, signal.field, raw))
+    elif signal.valtype == 2:
+        out.append('    double %sDouble = (double)%s;' % (signal.field, value))
+        out.append('    %s %s;' % (signal.raw_type, raw))
+        out.append('    memcpy(&%s, &%sDouble, sizeof(%s));' % (raw, signal.field, raw))
+    elif signal.is_scaled:
+        scaled = '((%s - %s) * (1.0F / %s))' % (value, sig + '_OFFSET', sig + '_FACTOR')
+        out.append('    float %sScaled = %s;' % (signal.field, scaled))
+        if signal.has_range and signal.minimum >= signal.offset and signal.factor > 0:
+            out.append('    %s %s = (%s)(%sScaled + 0.5F);' % (signal.raw_type, raw, signal.raw_type, signal.field))
+        else:
+            out.append('    %s %s = (%s)(int64_t)((%sScaled >= 0.0F) ? (%sScaled + 0.5F) : (%sScaled - 0.5F));'
+                       % (signal.raw_type, raw, signal.raw_type, signal.field, signal.field, signal.field))
+    else:
+        out.append('    %s %s = (%s)%s;' % (signal.raw_type, raw, signal.raw_type, value))
+    for byte, lo, count, off in signal.byte_chunks():
+        mask = (1 << count) - 1
+        expr = raw
+        if lo:
+            expr = '(%s >> %d)' % (expr, lo)
+        if lo + count < signal.raw_width:
+            expr = '(%s & 0x%XU)' % (expr, mask)
+        if off:
+            expr = '(%s << %d)' % (expr, off)
+        if count == 8:
+            out.append('    data[%d] = (uint8_t)%s;' % (byte, expr))
+        else:
+            out.append('    data[%d] |= (uint8_t)%s;' % (byte, expr))
+
+
+def emit_unpack_signal(message, signal, prefix, out):
+    sig = '%s_%s_%s' % (prefix, message.name, signal.upper)
+    raw = signal.field + 'Raw'
+    terms = []
+    for byte, lo, count, off in signal.byte_chunks():
+        mask = (1 << count) - 1
+        expr = 'data[%d]' % byte
+        if off:
+            expr = '(%s >> %d)' % (expr, off)
+        if count != 8:
+            expr = '(%s & 0x%XU)' % (expr, mask)
+        expr = '(%s)%s' % (signal.raw_type, expr)
+        if lo:
+            expr = '(%s << %d)' % (expr, lo)
+        terms.append(expr)
+    out.append('    /* %s */' % signal.name)
+    out.append('    %s %s = %s;' % (signal.raw_type, raw, ' |\n        '.join(terms)))
+    if signal.valtype == 1:
+        out.append('    float %sFloat;' % signal.field)
+        out.append('    memcpy(&%sFloat, &%s, sizeof(%sFloat));' % (signal.field, raw, signal.field))
+        value = signal.field + 'Float'
+    elif signal.valtype == 2:
+        out.append('    double %sDouble;' % signal.field)
+        out.append('    memcpy(&%sDouble, &%s, sizeof(%sDouble));' % (signal.field, raw, signal.field))
+        value = signal.field + 'Double'
+    else:
+        if signal.signed:
+            signed_type = 'int%d_t' % signal.raw_width
+            if signal.length < signal.raw_width:
+                sign_bit = 1 << (signal.length - 1)
+                out.append('    %s = (%s)((%s ^ 0x%XU) - 0x%XU);' % (raw, signal.raw_type, raw, sign_bit, sign_bit))
+            integer = '(%s)%s' % (signed_type, raw)
+        else:
+            integer = raw
+        if signal.is_scaled:
+            value = '(((float)%s * %s) + %s)' % (integer, sig + '_FACTOR', sig + '_OFFSET')
+        else:
+            value = integer
+    out.append('    msg->%s = (%s)%s;' % (signal.field, signal.phys_type, value))
+    if signal.has_range:
+        low, high = range_limits(signal, sig)
+        decoded_low, decoded_high = decoded_extremes(signal)
+        tolerance = 1e-9 * max(1.0, abs(signal.minimum), abs(signal.maximum))
+        if decoded_low is not None and decoded_low >= signal.minimum - tolerance:
+            low = None
+        if decoded_high is not None and decoded_high <= signal.maximum + tolerance:
+            high = None
+        checks = []
+        if low is not None:
+            checks.append('(msg->%s < %s)' % (signal.field, low))
+        if high is not None:
+            checks.append('(msg->%s > %s)' % (signal.field, high))
+        if checks:
+            out.append('    if (%s) {' % ' || '.join(checks))
+            out.append('        inRange = false;')
+            out.append('    }')
+
+
+def write_file(path, text):
+    with open(path, 'w', encoding='utf-8') as output:
+        output.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('dbc')
+    parser.add_argument('output_dir')
+    parser.add_argument('--name', default='can_db')
+    args = parser.parse_args()
+
+    messages = parse_dbc(args.dbc)
+    source = os.path.basename(args.dbc)
+    os.makedirs(args.output_dir, exist_ok=True)
+    write_file(os.path.join(args.output_dir, args.name + '.h'),
+               emit_header(messages, args.name, source))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())